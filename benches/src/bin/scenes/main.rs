@@ -0,0 +1,227 @@
+//! A scene-level benchmark.
+//!
+//! Unlike `#[bench]` microbenchmarks, renders whole scenes made of fills, strokes,
+//! dashes, clips, gradients and patterns, using the same scene description
+//! for each backend, at several canvas sizes and thread counts.
+//!
+//! See `README.md` for usage.
+
+mod report;
+mod scene;
+#[cfg(feature = "skia-rs")] mod skia_backend;
+mod tiny_skia_backend;
+
+use std::process;
+use std::sync::{Arc, Barrier};
+use std::thread;
+use std::time::{Duration, Instant};
+
+use report::Record;
+
+const HELP: &str = "\
+Usage: scenes [OPTIONS]
+
+Options:
+  --scenes LIST      Comma-separated scene names [default: all]
+                     fills, strokes, dashes, gradients, patterns, clips, mixed
+  --sizes LIST       Comma-separated square canvas sizes [default: 512,1024,2048]
+  --threads LIST     Comma-separated thread counts [default: 1]
+                     Each thread renders its own canvas.
+  --frames N         Frames rendered by each thread [default: 20]
+  --warmup N         Unmeasured frames rendered before each run [default: 2]
+  --backends LIST    tiny-skia, skia [default: all available]
+  --output PATH      Writes results as CSV, instead of stdout
+  --baseline PATH    Compares median frame times with a previous CSV report
+  --threshold N      Allowed median slowdown in percent [default: 5]
+";
+
+struct Args {
+    scenes: Vec<String>,
+    sizes: Vec<u32>,
+    threads: Vec<u32>,
+    frames: u32,
+    warmup: u32,
+    backends: Vec<String>,
+    output: Option<String>,
+    baseline: Option<String>,
+    threshold: f64,
+}
+
+fn main() {
+    let args = match parse_args() {
+        Ok(v) => v,
+        Err(e) => {
+            eprintln!("Error: {}.\n\n{}", e, HELP);
+            process::exit(2);
+        }
+    };
+
+    let mut records = Vec::new();
+    for scene_name in &args.scenes {
+        let scene = Arc::new(scene::by_name(scene_name).unwrap());
+        for &size in &args.sizes {
+            for &threads in &args.threads {
+                for backend in &args.backends {
+                    let times = run(backend, &scene, size, threads, args.warmup, args.frames);
+                    let record = Record::new(backend, scene.name, size, size, threads, &times);
+                    eprintln!(
+                        "{:10} {:10} {:5}x{:<5} {:2} threads: median {:8.3} ms, {:8.1} fps",
+                        record.backend, record.scene, size, size, threads,
+                        record.median_ms, record.fps,
+                    );
+                    records.push(record);
+                }
+            }
+        }
+    }
+
+    let csv = report::to_csv(&records);
+    match args.output {
+        Some(ref path) => {
+            if let Err(e) = std::fs::write(path, csv) {
+                eprintln!("Error: failed to write '{}' cause {}.", path, e);
+                process::exit(2);
+            }
+        }
+        None => print!("{}", csv),
+    }
+
+    report::print_ratios(&records);
+
+    if let Some(ref path) = args.baseline {
+        let baseline = match std::fs::read_to_string(path).ok().and_then(|s| report::from_csv(&s)) {
+            Some(v) => v,
+            None => {
+                eprintln!("Error: failed to read a baseline from '{}'.", path);
+                process::exit(2);
+            }
+        };
+
+        if report::compare(&baseline, &records, args.threshold) {
+            process::exit(1);
+        }
+    }
+}
+
+/// Frame times of all threads and the wall time spent rendering them.
+pub struct Times {
+    pub frames: Vec<Duration>,
+    pub wall: Duration,
+}
+
+fn run(
+    backend: &str,
+    scene: &Arc<scene::Scene>,
+    size: u32,
+    threads: u32,
+    warmup: u32,
+    frames: u32,
+) -> Times {
+    let render: fn(&scene::Scene, u32, u32, u32) -> Vec<Duration> = match backend {
+        #[cfg(feature = "skia-rs")]
+        "skia" => skia_backend::render,
+        _ => tiny_skia_backend::render,
+    };
+
+    // Threads wait for each other after the warmup, so they are measured together.
+    let barrier = Arc::new(Barrier::new(threads as usize));
+    let handles: Vec<_> = (0..threads).map(|_| {
+        let scene = scene.clone();
+        let barrier = barrier.clone();
+        thread::spawn(move || {
+            render(&scene, size, size, warmup);
+            barrier.wait();
+            let start = Instant::now();
+            let times = render(&scene, size, size, frames);
+            (times, start, Instant::now())
+        })
+    }).collect();
+
+    let mut times = Times { frames: Vec::new(), wall: Duration::from_secs(0) };
+    let mut first_start: Option<Instant> = None;
+    let mut last_end: Option<Instant> = None;
+    for handle in handles {
+        let (frames, start, end) = handle.join().unwrap();
+        times.frames.extend(frames);
+        first_start = Some(first_start.map_or(start, |s| s.min(start)));
+        last_end = Some(last_end.map_or(end, |e| e.max(end)));
+    }
+
+    if let (Some(start), Some(end)) = (first_start, last_end) {
+        times.wall = end - start;
+    }
+
+    times
+}
+
+fn parse_args() -> Result<Args, String> {
+    let mut args = Args {
+        scenes: scene::NAMES.iter().map(|s| s.to_string()).collect(),
+        sizes: vec![512, 1024, 2048],
+        threads: vec![1],
+        frames: 20,
+        warmup: 2,
+        backends: available_backends(),
+        output: None,
+        baseline: None,
+        threshold: 5.0,
+    };
+
+    let mut iter = std::env::args().skip(1);
+    while let Some(arg) = iter.next() {
+        if arg == "-h" || arg == "--help" {
+            print!("{}", HELP);
+            process::exit(0);
+        }
+
+        let value = iter.next().ok_or_else(|| format!("'{}' requires a value", arg))?;
+        match arg.as_str() {
+            "--scenes" => args.scenes = split(&value),
+            "--sizes" => args.sizes = parse_list(&arg, &value)?,
+            "--threads" => args.threads = parse_list(&arg, &value)?,
+            "--frames" => args.frames = parse_value(&arg, &value)?,
+            "--warmup" => args.warmup = parse_value(&arg, &value)?,
+            "--backends" => args.backends = split(&value),
+            "--output" => args.output = Some(value),
+            "--baseline" => args.baseline = Some(value),
+            "--threshold" => args.threshold = parse_value(&arg, &value)?,
+            _ => return Err(format!("unknown option '{}'", arg)),
+        }
+    }
+
+    if let Some(name) = args.scenes.iter().find(|n| !scene::NAMES.contains(&n.as_str())) {
+        return Err(format!("unknown scene '{}'", name));
+    }
+
+    let available = available_backends();
+    if let Some(name) = args.backends.iter().find(|n| !available.contains(n)) {
+        return Err(format!("backend '{}' is not available", name));
+    }
+
+    if args.frames == 0 || args.sizes.contains(&0) || args.threads.contains(&0) {
+        return Err("frames, sizes and threads must be positive".to_string());
+    }
+
+    Ok(args)
+}
+
+fn available_backends() -> Vec<String> {
+    let mut list = vec!["tiny-skia".to_string()];
+    if cfg!(feature = "skia-rs") {
+        list.push("skia".to_string());
+    }
+
+    list
+}
+
+fn split(value: &str) -> Vec<String> {
+    value.split(',').map(|s| s.trim().to_string()).filter(|s| !s.is_empty()).collect()
+}
+
+fn parse_value<T: std::str::FromStr>(arg: &str, value: &str) -> Result<T, String> {
+    value.parse().map_err(|_| format!("invalid '{}' value '{}'", arg, value))
+}
+
+fn parse_list<T: std::str::FromStr>(arg: &str, value: &str) -> Result<Vec<T>, String> {
+    split(value).iter().map(|v| parse_value(arg, v)).collect()
+}
@@ -0,0 +1,154 @@
+//! Machine-readable reports and regression checks.
+
+use crate::Times;
+
+const HEADER: &str = "backend,scene,width,height,threads,frames,mean_ms,median_ms,p95_ms,fps,mpix_per_s";
+
+#[derive(Clone, Debug)]
+pub struct Record {
+    pub backend: String,
+    pub scene: String,
+    pub width: u32,
+    pub height: u32,
+    pub threads: u32,
+    /// The total number of frames rendered by all threads.
+    pub frames: u32,
+    /// Per-frame latency.
+    pub mean_ms: f64,
+    pub median_ms: f64,
+    pub p95_ms: f64,
+    /// Throughput, for all threads combined.
+    pub fps: f64,
+    pub mpix_per_s: f64,
+}
+
+impl Record {
+    pub fn new(backend: &str, scene: &str, width: u32, height: u32, threads: u32, times: &Times) -> Self {
+        let mut ms: Vec<f64> = times.frames.iter().map(|d| d.as_secs_f64() * 1000.0).collect();
+        ms.sort_by(|a, b| a.partial_cmp(b).unwrap());
+
+        let frames = ms.len();
+        let mean_ms = ms.iter().sum::<f64>() / frames as f64;
+        let wall = times.wall.as_secs_f64();
+        let fps = if wall > 0.0 { frames as f64 / wall } else { 0.0 };
+
+        Record {
+            backend: backend.to_string(),
+            scene: scene.to_string(),
+            width,
+            height,
+            threads,
+            frames: frames as u32,
+            mean_ms,
+            median_ms: percentile(&ms, 50.0),
+            p95_ms: percentile(&ms, 95.0),
+            fps,
+            mpix_per_s: fps * (width as f64 * height as f64) / 1_000_000.0,
+        }
+    }
+
+    /// Records are compared only when they were produced using the same configuration.
+    fn same_run(&self, other: &Record) -> bool {
+        self.scene == other.scene
+            && self.width == other.width
+            && self.height == other.height
+            && self.threads == other.threads
+    }
+}
+
+/// Uses the nearest-rank method on sorted values.
+fn percentile(sorted: &[f64], p: f64) -> f64 {
+    let rank = ((p / 100.0) * sorted.len() as f64).ceil() as usize;
+    sorted[rank.max(1).min(sorted.len()) - 1]
+}
+
+pub fn to_csv(records: &[Record]) -> String {
+    let mut s = String::from(HEADER);
+    s.push('\n');
+    for r in records {
+        s.push_str(&format!(
+            "{},{},{},{},{},{},{:.4},{:.4},{:.4},{:.2},{:.2}\n",
+            r.backend, r.scene, r.width, r.height, r.threads, r.frames,
+            r.mean_ms, r.median_ms, r.p95_ms, r.fps, r.mpix_per_s,
+        ));
+    }
+
+    s
+}
+
+pub fn from_csv(text: &str) -> Option<Vec<Record>> {
+    let mut lines = text.lines();
+    if lines.next()?.trim() != HEADER {
+        return None;
+    }
+
+    let mut records = Vec::new();
+    for line in lines.filter(|l| !l.trim().is_empty()) {
+        let f: Vec<&str> = line.split(',').map(|s| s.trim()).collect();
+        if f.len() != 11 {
+            return None;
+        }
+
+        records.push(Record {
+            backend: f[0].to_string(),
+            scene: f[1].to_string(),
+            width: f[2].parse().ok()?,
+            height: f[3].parse().ok()?,
+            threads: f[4].parse().ok()?,
+            frames: f[5].parse().ok()?,
+            mean_ms: f[6].parse().ok()?,
+            median_ms: f[7].parse().ok()?,
+            p95_ms: f[8].parse().ok()?,
+            fps: f[9].parse().ok()?,
+            mpix_per_s: f[10].parse().ok()?,
+        });
+    }
+
+    Some(records)
+}
+
+/// Prints how much slower tiny-skia is than Skia, when both were run.
+pub fn print_ratios(records: &[Record]) {
+    let mut printed_header = false;
+    for r in records.iter().filter(|r| r.backend == "tiny-skia") {
+        let skia = records.iter().find(|s| s.backend == "skia" && s.same_run(r));
+        if let Some(skia) = skia {
+            if !printed_header {
+                eprintln!("\ntiny-skia / Skia median frame time:");
+                printed_header = true;
+            }
+
+            eprintln!(
+                "  {:10} {:5}x{:<5} {:2} threads: {:.2}x",
+                r.scene, r.width, r.height, r.threads, r.median_ms / skia.median_ms,
+            );
+        }
+    }
+}
+
+/// Compares median frame times with a baseline and prints regressions.
+///
+/// Returns `true` when any run became slower than `threshold` percent.
+pub fn compare(baseline: &[Record], records: &[Record], threshold: f64) -> bool {
+    let mut regressed = false;
+    eprintln!("\nCompared to the baseline:");
+    for r in records {
+        let base = baseline.iter().find(|b| b.backend == r.backend && b.same_run(r));
+        let base = match base {
+            Some(v) => v,
+            None => continue,
+        };
+
+        let change = (r.median_ms / base.median_ms - 1.0) * 100.0;
+        let is_regression = change > threshold;
+        regressed |= is_regression;
+        eprintln!(
+            "  {:10} {:10} {:5}x{:<5} {:2} threads: {:8.3} -> {:8.3} ms ({:+.1}%){}",
+            r.backend, r.scene, r.width, r.height, r.threads,
+            base.median_ms, r.median_ms, change,
+            if is_regression { " REGRESSION" } else { "" },
+        );
+    }
+
+    regressed
+}
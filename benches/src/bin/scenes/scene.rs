@@ -0,0 +1,369 @@
+//! A backend-independent scene description.
+//!
+//! Scenes are generated deterministically inside a 1000x1000 design space
+//! and scaled to the canvas size by the backends, so the same scene
+//! produces comparable work at any size and for any library.
+
+pub const DESIGN_SIZE: f32 = 1000.0;
+
+#[derive(Copy, Clone, Debug)]
+pub enum Segment {
+    MoveTo(f32, f32),
+    LineTo(f32, f32),
+    CubicTo(f32, f32, f32, f32, f32, f32),
+    Close,
+}
+
+#[derive(Clone, Debug)]
+pub struct Path {
+    pub segments: Vec<Segment>,
+    pub even_odd: bool,
+}
+
+/// RGBA, not premultiplied.
+pub type Color = [u8; 4];
+
+#[derive(Clone, Debug)]
+pub enum Fill {
+    Solid(Color),
+    LinearGradient {
+        start: (f32, f32),
+        end: (f32, f32),
+        stops: Vec<(f32, Color)>,
+    },
+    /// A two-point conical gradient with a zero start radius.
+    RadialGradient {
+        start: (f32, f32),
+        end: (f32, f32),
+        radius: f32,
+        stops: Vec<(f32, Color)>,
+    },
+    /// A repeating checkerboard of two colors.
+    Pattern {
+        cell: u32,
+        colors: [Color; 2],
+        transform: tiny_skia::Transform,
+    },
+}
+
+#[derive(Copy, Clone, Debug)]
+pub enum Cap {
+    Butt,
+    Round,
+    Square,
+}
+
+#[derive(Copy, Clone, Debug)]
+pub enum Join {
+    Miter,
+    Round,
+    Bevel,
+}
+
+#[derive(Clone, Debug)]
+pub struct Stroke {
+    /// Zero means a hairline.
+    pub width: f32,
+    pub cap: Cap,
+    pub join: Join,
+    pub dash: Option<Vec<f32>>,
+}
+
+#[derive(Clone, Debug)]
+pub enum Command {
+    Fill {
+        path: Path,
+        fill: Fill,
+        anti_alias: bool,
+        transform: tiny_skia::Transform,
+    },
+    Stroke {
+        path: Path,
+        fill: Fill,
+        stroke: Stroke,
+        anti_alias: bool,
+        transform: tiny_skia::Transform,
+    },
+    /// Intersects the current clip with a path. Must be matched by `PopClip`.
+    PushClip {
+        path: Path,
+        anti_alias: bool,
+        transform: tiny_skia::Transform,
+    },
+    PopClip,
+}
+
+#[derive(Clone, Debug)]
+pub struct Scene {
+    pub name: &'static str,
+    pub background: Color,
+    pub commands: Vec<Command>,
+}
+
+pub const NAMES: &[&str] = &["fills", "strokes", "dashes", "gradients", "patterns", "clips", "mixed"];
+
+/// Returns a scene by name.
+pub fn by_name(name: &str) -> Option<Scene> {
+    let name = *NAMES.iter().find(|n| **n == name)?;
+    let mut gen = Generator::new(name);
+    let mut commands = Vec::new();
+    match name {
+        "fills" => {
+            for _ in 0..200 {
+                let fill = gen.solid();
+                commands.push(gen.fill(fill));
+            }
+        }
+        "strokes" => {
+            for i in 0..150 {
+                // Every fifth stroke is a hairline.
+                let width = if i % 5 == 0 { 0.0 } else { gen.range(1.0, 12.0) };
+                commands.push(gen.stroke(width, None));
+            }
+        }
+        "dashes" => {
+            for _ in 0..100 {
+                let dash = vec![gen.range(4.0, 20.0), gen.range(2.0, 10.0)];
+                let width = gen.range(1.0, 6.0);
+                commands.push(gen.stroke(width, Some(dash)));
+            }
+        }
+        "gradients" => {
+            for i in 0..100 {
+                let fill = if i % 2 == 0 { gen.linear_gradient() } else { gen.radial_gradient() };
+                commands.push(gen.fill(fill));
+            }
+        }
+        "patterns" => {
+            for _ in 0..60 {
+                let fill = gen.pattern();
+                commands.push(gen.fill(fill));
+            }
+        }
+        "clips" => {
+            for _ in 0..10 {
+                commands.push(gen.push_clip());
+                for _ in 0..15 {
+                    let fill = gen.solid();
+                commands.push(gen.fill(fill));
+                }
+                commands.push(Command::PopClip);
+            }
+        }
+        _ => {
+            // A rough approximation of an SVG icon sheet or a chart.
+            for i in 0..25 {
+                if i % 5 == 0 {
+                    commands.push(gen.push_clip());
+                }
+
+                let fill = gen.solid();
+                commands.push(gen.fill(fill));
+                let fill = if i % 2 == 0 { gen.linear_gradient() } else { gen.radial_gradient() };
+                commands.push(gen.fill(fill));
+                if i % 3 == 0 {
+                    let fill = gen.pattern();
+                    commands.push(gen.fill(fill));
+                }
+                let width = gen.range(1.0, 4.0);
+                commands.push(gen.stroke(width, None));
+                commands.push(gen.stroke(0.0, None));
+                if i % 2 == 0 {
+                    commands.push(gen.stroke(2.0, Some(vec![8.0, 4.0])));
+                }
+
+                if i % 5 == 4 {
+                    commands.push(Command::PopClip);
+                }
+            }
+        }
+    }
+
+    Some(Scene {
+        name,
+        background: [255, 255, 255, 255],
+        commands,
+    })
+}
+
+/// A xorshift-based generator, so scenes are identical between runs and backends.
+struct Generator(u32);
+
+impl Generator {
+    fn new(seed: &str) -> Self {
+        let seed = seed.bytes().fold(2166136261u32, |h, b| (h ^ b as u32).wrapping_mul(16777619));
+        Generator(seed | 1)
+    }
+
+    fn next(&mut self) -> u32 {
+        self.0 ^= self.0 << 13;
+        self.0 ^= self.0 >> 17;
+        self.0 ^= self.0 << 5;
+        self.0
+    }
+
+    fn range(&mut self, min: f32, max: f32) -> f32 {
+        let t = (self.next() >> 8) as f32 / (1u32 << 24) as f32;
+        min + (max - min) * t
+    }
+
+    fn point(&mut self) -> (f32, f32) {
+        (self.range(0.0, DESIGN_SIZE), self.range(0.0, DESIGN_SIZE))
+    }
+
+    fn color(&mut self) -> Color {
+        let n = self.next();
+        [n as u8, (n >> 8) as u8, (n >> 16) as u8, 128 + (n >> 25) as u8]
+    }
+
+    fn transform(&mut self) -> tiny_skia::Transform {
+        match self.next() % 4 {
+            0 => tiny_skia::Transform::identity(),
+            1 => tiny_skia::Transform::from_translate(self.range(-50.0, 50.0), self.range(-50.0, 50.0)),
+            2 => {
+                let s = self.range(0.5, 1.5);
+                tiny_skia::Transform::from_row(s, 0.0, 0.0, s, self.range(0.0, 100.0), self.range(0.0, 100.0))
+            }
+            _ => tiny_skia::Transform::from_rotate_at(
+                self.range(-30.0, 30.0), DESIGN_SIZE / 2.0, DESIGN_SIZE / 2.0,
+            ),
+        }
+    }
+
+    fn path(&mut self) -> Path {
+        let mut segments = Vec::new();
+        match self.next() % 4 {
+            0 => {
+                // A rectangle.
+                let (x, y) = self.point();
+                let w = self.range(20.0, 400.0);
+                let h = self.range(20.0, 400.0);
+                segments.push(Segment::MoveTo(x, y));
+                segments.push(Segment::LineTo(x + w, y));
+                segments.push(Segment::LineTo(x + w, y + h));
+                segments.push(Segment::LineTo(x, y + h));
+                segments.push(Segment::Close);
+            }
+            1 => {
+                // An ellipse made of four cubics.
+                let (cx, cy) = self.point();
+                let rx = self.range(10.0, 200.0);
+                let ry = self.range(10.0, 200.0);
+                let k = 0.552_284_8;
+                segments.push(Segment::MoveTo(cx + rx, cy));
+                segments.push(Segment::CubicTo(cx + rx, cy + ry * k, cx + rx * k, cy + ry, cx, cy + ry));
+                segments.push(Segment::CubicTo(cx - rx * k, cy + ry, cx - rx, cy + ry * k, cx - rx, cy));
+                segments.push(Segment::CubicTo(cx - rx, cy - ry * k, cx - rx * k, cy - ry, cx, cy - ry));
+                segments.push(Segment::CubicTo(cx + rx * k, cy - ry, cx + rx, cy - ry * k, cx + rx, cy));
+                segments.push(Segment::Close);
+            }
+            2 => {
+                // A polygon, possibly self-intersecting.
+                let (x, y) = self.point();
+                segments.push(Segment::MoveTo(x, y));
+                for _ in 0..(3 + self.next() % 8) {
+                    let (x, y) = self.point();
+                    segments.push(Segment::LineTo(x, y));
+                }
+                segments.push(Segment::Close);
+            }
+            _ => {
+                // A curvy blob.
+                let (x, y) = self.point();
+                segments.push(Segment::MoveTo(x, y));
+                for _ in 0..(2 + self.next() % 4) {
+                    let (x1, y1) = self.point();
+                    let (x2, y2) = self.point();
+                    let (x, y) = self.point();
+                    segments.push(Segment::CubicTo(x1, y1, x2, y2, x, y));
+                }
+                segments.push(Segment::Close);
+            }
+        }
+
+        Path {
+            segments,
+            even_odd: self.next() % 2 == 0,
+        }
+    }
+
+    fn stops(&mut self) -> Vec<(f32, Color)> {
+        let mut stops = vec![(0.0, self.color())];
+        if self.next() % 2 == 0 {
+            stops.push((self.range(0.2, 0.8), self.color()));
+        }
+        stops.push((1.0, self.color()));
+        stops
+    }
+
+    fn solid(&mut self) -> Fill {
+        Fill::Solid(self.color())
+    }
+
+    fn linear_gradient(&mut self) -> Fill {
+        Fill::LinearGradient {
+            start: self.point(),
+            end: self.point(),
+            stops: self.stops(),
+        }
+    }
+
+    fn radial_gradient(&mut self) -> Fill {
+        let start = self.point();
+        Fill::RadialGradient {
+            start,
+            end: (start.0 + self.range(-40.0, 40.0), start.1 + self.range(-40.0, 40.0)),
+            radius: self.range(80.0, 400.0),
+            stops: self.stops(),
+        }
+    }
+
+    fn pattern(&mut self) -> Fill {
+        let mut colors = [self.color(), self.color()];
+        colors[0][3] = 255;
+        Fill::Pattern {
+            cell: 4 + self.next() % 12,
+            colors,
+            transform: self.transform(),
+        }
+    }
+
+    fn fill(&mut self, fill: Fill) -> Command {
+        Command::Fill {
+            path: self.path(),
+            fill,
+            anti_alias: self.next() % 4 != 0,
+            transform: self.transform(),
+        }
+    }
+
+    fn stroke(&mut self, width: f32, dash: Option<Vec<f32>>) -> Command {
+        let cap = match self.next() % 3 {
+            0 => Cap::Butt,
+            1 => Cap::Round,
+            _ => Cap::Square,
+        };
+
+        let join = match self.next() % 3 {
+            0 => Join::Miter,
+            1 => Join::Round,
+            _ => Join::Bevel,
+        };
+
+        Command::Stroke {
+            path: self.path(),
+            fill: self.solid(),
+            stroke: Stroke { width, cap, join, dash },
+            anti_alias: true,
+            transform: self.transform(),
+        }
+    }
+
+    fn push_clip(&mut self) -> Command {
+        Command::PushClip {
+            path: self.path(),
+            anti_alias: self.next() % 2 == 0,
+            transform: self.transform(),
+        }
+    }
+}
@@ -0,0 +1,163 @@
+use std::time::{Duration, Instant};
+
+use skia_rs::*;
+
+use crate::scene::{self, Command, Fill, Segment, DESIGN_SIZE};
+
+/// Renders the scene `frames` times and returns the time spent on each frame.
+///
+/// The whole scene is replayed by a single `skiac_canvas_draw_scene_frames` call per frame,
+/// so the per-command FFI overhead is not measured.
+pub fn render(scene: &scene::Scene, width: u32, height: u32, frames: u32) -> Vec<Duration> {
+    let mut surface = Surface::new_rgba_premultiplied(width, height).unwrap();
+
+    let skia_scene = prepare(scene, width, height);
+    let bg = scene.background;
+    let background = Color::from_rgba(bg[0], bg[1], bg[2], bg[3]);
+
+    let mut times = Vec::with_capacity(frames as usize);
+    for _ in 0..frames {
+        let start = Instant::now();
+        surface.draw_scene_frames(&skia_scene, background, 1);
+        surface.flush();
+        times.push(start.elapsed());
+    }
+
+    times
+}
+
+fn prepare(scene: &scene::Scene, width: u32, height: u32) -> Scene {
+    let scale = tiny_skia::Transform::from_scale(width as f32 / DESIGN_SIZE, height as f32 / DESIGN_SIZE);
+
+    let mut skia_scene = Scene::new();
+    for command in &scene.commands {
+        match command {
+            Command::Fill { path, fill, anti_alias, transform } => {
+                let mut paint = to_paint(fill);
+                paint.set_anti_alias(*anti_alias);
+                skia_scene.draw_path(to_path(path), paint, to_transform(scale.pre_concat(*transform)));
+            }
+            Command::Stroke { path, fill, stroke, anti_alias, transform } => {
+                let mut paint = to_paint(fill);
+                paint.set_anti_alias(*anti_alias);
+                paint.set_style(PaintStyle::Stroke);
+                paint.set_stroke_width(stroke.width);
+                paint.set_stroke_cap(match stroke.cap {
+                    scene::Cap::Butt => StrokeCap::Butt,
+                    scene::Cap::Round => StrokeCap::Round,
+                    scene::Cap::Square => StrokeCap::Square,
+                });
+                paint.set_stroke_join(match stroke.join {
+                    scene::Join::Miter => StrokeJoin::Miter,
+                    scene::Join::Round => StrokeJoin::Round,
+                    scene::Join::Bevel => StrokeJoin::Bevel,
+                });
+                if let Some(ref dash) = stroke.dash {
+                    if let Some(effect) = PathEffect::new_dash_path(dash, 0.0) {
+                        paint.set_path_effect(&effect);
+                    }
+                }
+
+                // Strokes ignore the fill type.
+                let mut path = to_path(path);
+                path.set_fill_type(FillType::Winding);
+                skia_scene.draw_path(path, paint, to_transform(scale.pre_concat(*transform)));
+            }
+            Command::PushClip { path, anti_alias, transform } => {
+                skia_scene.push_clip_path(
+                    to_path(path), to_transform(scale.pre_concat(*transform)), *anti_alias,
+                );
+            }
+            Command::PopClip => skia_scene.pop_clip(),
+        }
+    }
+
+    skia_scene
+}
+
+fn to_paint(fill: &Fill) -> Paint {
+    let mut paint = Paint::new();
+    match fill {
+        Fill::Solid(c) => paint.set_color(c[0], c[1], c[2], c[3]),
+        Fill::LinearGradient { start, end, stops } => {
+            let shader = Shader::new_linear_gradient(&LinearGradient {
+                start_point: *start,
+                end_point: *end,
+                base: to_gradient(stops),
+            });
+
+            if let Some(shader) = shader {
+                paint.set_shader(&shader);
+            }
+        }
+        Fill::RadialGradient { start, end, radius, stops } => {
+            let shader = Shader::new_two_point_conical_gradient(&TwoPointConicalGradient {
+                start: *start,
+                start_radius: 0.0,
+                end: *end,
+                end_radius: *radius,
+                base: to_gradient(stops),
+            });
+
+            if let Some(shader) = shader {
+                paint.set_shader(&shader);
+            }
+        }
+        Fill::Pattern { cell, colors, transform } => {
+            // The shader uses a snapshot, so the surface can be dropped afterwards.
+            let surface = checkerboard(*cell, colors);
+            let shader = Shader::new_from_surface_image(
+                &surface, to_transform(*transform), FilterQuality::Low,
+            );
+
+            if let Some(shader) = shader {
+                paint.set_shader(&shader);
+            }
+        }
+    }
+
+    paint
+}
+
+/// Returns a 2x2 cells checkerboard, that is repeated by the pattern.
+fn checkerboard(cell: u32, colors: &[scene::Color; 2]) -> Surface {
+    let mut surface = Surface::new_rgba_premultiplied(cell * 2, cell * 2).unwrap();
+    let c = colors[0];
+    surface.fill(c[0], c[1], c[2], c[3]);
+
+    let mut paint = Paint::new();
+    let c = colors[1];
+    paint.set_color(c[0], c[1], c[2], c[3]);
+    let cell = cell as f32;
+    surface.draw_rect(cell, 0.0, cell, cell, &paint);
+    surface.draw_rect(0.0, cell, cell, cell, &paint);
+    surface
+}
+
+fn to_path(path: &scene::Path) -> Path {
+    let mut p = Path::new();
+    for segment in &path.segments {
+        match *segment {
+            Segment::MoveTo(x, y) => p.move_to(x, y),
+            Segment::LineTo(x, y) => p.line_to(x, y),
+            Segment::CubicTo(x1, y1, x2, y2, x, y) => p.cubic_to(x1, y1, x2, y2, x, y),
+            Segment::Close => p.close(),
+        }
+    }
+
+    p.set_fill_type(if path.even_odd { FillType::EvenOdd } else { FillType::Winding });
+    p
+}
+
+fn to_gradient(stops: &[(f32, scene::Color)]) -> Gradient {
+    Gradient {
+        colors: stops.iter().map(|(_, c)| Color::from_rgba(c[0], c[1], c[2], c[3])).collect(),
+        positions: stops.iter().map(|(pos, _)| *pos).collect(),
+        tile_mode: TileMode::Clamp,
+        transform: Transform::default(),
+    }
+}
+
+fn to_transform(ts: tiny_skia::Transform) -> Transform {
+    Transform::new(ts.sx, ts.ky, ts.kx, ts.sy, ts.tx, ts.ty)
+}
@@ -0,0 +1,266 @@
+use std::time::{Duration, Instant};
+
+use tiny_skia::*;
+
+use crate::scene::{self, Command, Fill, Scene, Segment, DESIGN_SIZE};
+
+enum Source {
+    Solid(scene::Color),
+    Shader(Shader<'static>),
+    /// A checkerboard pixmap index and a pattern transform.
+    Pattern(usize, Transform),
+}
+
+enum Prepared {
+    Fill {
+        path: Path,
+        fill_rule: FillRule,
+        source: usize,
+        anti_alias: bool,
+        transform: Transform,
+    },
+    Stroke {
+        path: Path,
+        stroke: Stroke,
+        source: usize,
+        anti_alias: bool,
+        transform: Transform,
+    },
+    /// A path already transformed to the canvas space, since `ClipMask` has no transform.
+    PushClip {
+        path: Path,
+        fill_rule: FillRule,
+        anti_alias: bool,
+    },
+    PopClip,
+}
+
+struct PreparedScene {
+    background: Color,
+    sources: Vec<Source>,
+    cells: Vec<Pixmap>,
+    commands: Vec<Prepared>,
+}
+
+/// Renders the scene `frames` times and returns the time spent on each frame.
+///
+/// Scene preparation, like building paths and gradients, is not measured.
+pub fn render(scene: &Scene, width: u32, height: u32, frames: u32) -> Vec<Duration> {
+    let prepared = prepare(scene, width, height);
+    let mut paints: Vec<Paint> = prepared.sources.iter().map(|s| to_paint(s, &prepared.cells)).collect();
+
+    let mut pixmap = Pixmap::new(width, height).unwrap();
+    let mut stroke_ctx = StrokeContext::default();
+    let mut clips: Vec<ClipMask> = Vec::new();
+
+    let mut times = Vec::with_capacity(frames as usize);
+    for _ in 0..frames {
+        let start = Instant::now();
+        pixmap.fill(prepared.background);
+        for command in &prepared.commands {
+            match command {
+                Prepared::Fill { path, fill_rule, source, anti_alias, transform } => {
+                    let paint = &mut paints[*source];
+                    paint.anti_alias = *anti_alias;
+                    pixmap.fill_path(path, paint, *fill_rule, *transform, clips.last());
+                }
+                Prepared::Stroke { path, stroke, source, anti_alias, transform } => {
+                    let paint = &mut paints[*source];
+                    paint.anti_alias = *anti_alias;
+                    pixmap.stroke_path_with_context(
+                        path, paint, stroke, *transform, clips.last(), &mut stroke_ctx,
+                    );
+                }
+                Prepared::PushClip { path, fill_rule, anti_alias } => {
+                    let mask = match clips.last() {
+                        Some(last) => {
+                            let mut mask = last.clone();
+                            mask.intersect_path(path, *fill_rule, *anti_alias);
+                            mask
+                        }
+                        None => {
+                            let mut mask = ClipMask::new();
+                            mask.set_path(width, height, path, *fill_rule, *anti_alias);
+                            mask
+                        }
+                    };
+
+                    clips.push(mask);
+                }
+                Prepared::PopClip => {
+                    clips.pop();
+                }
+            }
+        }
+
+        clips.clear();
+        times.push(start.elapsed());
+    }
+
+    times
+}
+
+fn prepare(scene: &Scene, width: u32, height: u32) -> PreparedScene {
+    let scale = Transform::from_scale(width as f32 / DESIGN_SIZE, height as f32 / DESIGN_SIZE);
+
+    let mut prepared = PreparedScene {
+        background: to_color(scene.background),
+        sources: Vec::new(),
+        cells: Vec::new(),
+        commands: Vec::new(),
+    };
+
+    for command in &scene.commands {
+        let command = match command {
+            Command::Fill { path, fill, anti_alias, transform } => {
+                let (path, fill_rule) = match to_path(path) {
+                    Some(v) => v,
+                    None => continue,
+                };
+
+                Prepared::Fill {
+                    path,
+                    fill_rule,
+                    source: push_source(fill, &mut prepared),
+                    anti_alias: *anti_alias,
+                    transform: scale.pre_concat(*transform),
+                }
+            }
+            Command::Stroke { path, fill, stroke, anti_alias, transform } => {
+                let (path, _) = match to_path(path) {
+                    Some(v) => v,
+                    None => continue,
+                };
+
+                let mut s = Stroke::default();
+                s.width = stroke.width;
+                s.line_cap = match stroke.cap {
+                    scene::Cap::Butt => LineCap::Butt,
+                    scene::Cap::Round => LineCap::Round,
+                    scene::Cap::Square => LineCap::Square,
+                };
+                s.line_join = match stroke.join {
+                    scene::Join::Miter => LineJoin::Miter,
+                    scene::Join::Round => LineJoin::Round,
+                    scene::Join::Bevel => LineJoin::Bevel,
+                };
+                s.dash = stroke.dash.as_ref().and_then(|d| StrokeDash::new(d.clone(), 0.0));
+
+                Prepared::Stroke {
+                    path,
+                    stroke: s,
+                    source: push_source(fill, &mut prepared),
+                    anti_alias: *anti_alias,
+                    transform: scale.pre_concat(*transform),
+                }
+            }
+            Command::PushClip { path, anti_alias, transform } => {
+                // An empty clip path still has to be pushed, to keep the stack balanced.
+                let (path, fill_rule) = to_path(path)
+                    .and_then(|(p, r)| Some((p.transform(scale.pre_concat(*transform))?, r)))
+                    .unwrap_or_else(|| {
+                        (PathBuilder::from_rect(Rect::from_xywh(0.0, 0.0, 1.0, 1.0).unwrap()),
+                         FillRule::Winding)
+                    });
+
+                Prepared::PushClip { path, fill_rule, anti_alias: *anti_alias }
+            }
+            Command::PopClip => Prepared::PopClip,
+        };
+
+        prepared.commands.push(command);
+    }
+
+    prepared
+}
+
+fn push_source(fill: &Fill, prepared: &mut PreparedScene) -> usize {
+    let source = match fill {
+        Fill::Solid(c) => Source::Solid(*c),
+        Fill::LinearGradient { start, end, stops } => {
+            LinearGradient::new(
+                Point::from_xy(start.0, start.1),
+                Point::from_xy(end.0, end.1),
+                to_stops(stops),
+                SpreadMode::Pad,
+                Transform::identity(),
+            ).map(Source::Shader).unwrap_or(Source::Solid(stops[0].1))
+        }
+        Fill::RadialGradient { start, end, radius, stops } => {
+            RadialGradient::new(
+                Point::from_xy(start.0, start.1),
+                Point::from_xy(end.0, end.1),
+                *radius,
+                to_stops(stops),
+                SpreadMode::Pad,
+                Transform::identity(),
+            ).map(Source::Shader).unwrap_or(Source::Solid(stops[0].1))
+        }
+        Fill::Pattern { cell, colors, transform } => {
+            prepared.cells.push(checkerboard(*cell, colors));
+            Source::Pattern(prepared.cells.len() - 1, *transform)
+        }
+    };
+
+    prepared.sources.push(source);
+    prepared.sources.len() - 1
+}
+
+fn to_paint<'a>(source: &Source, cells: &'a [Pixmap]) -> Paint<'a> {
+    let mut paint = Paint::default();
+    match source {
+        Source::Solid(c) => paint.set_color_rgba8(c[0], c[1], c[2], c[3]),
+        Source::Shader(shader) => paint.shader = shader.clone(),
+        Source::Pattern(idx, ts) => {
+            paint.shader = Pattern::new(
+                cells[*idx].as_ref(),
+                SpreadMode::Repeat,
+                FilterQuality::Bilinear,
+                1.0,
+                *ts,
+            );
+        }
+    }
+
+    paint
+}
+
+/// Returns a 2x2 cells checkerboard, that is repeated by the pattern.
+fn checkerboard(cell: u32, colors: &[scene::Color; 2]) -> Pixmap {
+    let mut pixmap = Pixmap::new(cell * 2, cell * 2).unwrap();
+    pixmap.fill(to_color(colors[0]));
+
+    let mut paint = Paint::default();
+    let c = colors[1];
+    paint.set_color_rgba8(c[0], c[1], c[2], c[3]);
+    let cell = cell as f32;
+    for &(x, y) in &[(cell, 0.0), (0.0, cell)] {
+        let rect = Rect::from_xywh(x, y, cell, cell).unwrap();
+        pixmap.fill_rect(rect, &paint, Transform::identity(), None);
+    }
+
+    pixmap
+}
+
+fn to_path(path: &scene::Path) -> Option<(Path, FillRule)> {
+    let mut pb = PathBuilder::new();
+    for segment in &path.segments {
+        match *segment {
+            Segment::MoveTo(x, y) => pb.move_to(x, y),
+            Segment::LineTo(x, y) => pb.line_to(x, y),
+            Segment::CubicTo(x1, y1, x2, y2, x, y) => pb.cubic_to(x1, y1, x2, y2, x, y),
+            Segment::Close => pb.close(),
+        }
+    }
+
+    let fill_rule = if path.even_odd { FillRule::EvenOdd } else { FillRule::Winding };
+    Some((pb.finish()?, fill_rule))
+}
+
+fn to_stops(stops: &[(f32, scene::Color)]) -> Vec<GradientStop> {
+    stops.iter().map(|(pos, c)| GradientStop::new(*pos, to_color(*c))).collect()
+}
+
+fn to_color(c: scene::Color) -> Color {
+    Color::from_rgba8(c[0], c[1], c[2], c[3])
+}
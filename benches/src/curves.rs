@@ -0,0 +1,70 @@
+use test::Bencher;
+
+// A path made of many small quads and cubics, so edge building dominates.
+//
+// Curves of a path fully inside the pixmap have their Y extrema computed in batches.
+// A path crossing the pixmap edge goes through the edge clipper instead,
+// which chops curves one by one. It's shifted by 2px, so only a sliver is clipped.
+
+fn curves_path() -> tiny_skia::Path {
+    use tiny_skia::*;
+
+    const CURVES: usize = 2000;
+
+    let point = |i: usize, r: f32| {
+        let a = i as f32 / (CURVES * 4) as f32 * 2.0 * core::f32::consts::PI;
+        (250.0 + r * a.cos(), 250.0 + r * a.sin())
+    };
+
+    let mut pb = PathBuilder::new();
+    let (x, y) = point(0, 240.0);
+    pb.move_to(x, y);
+    for i in 0..CURVES {
+        let (x1, y1) = point(i * 4 + 1, 249.0);
+        let (x2, y2) = point(i * 4 + 2, 200.0);
+        let (x, y) = point(i * 4 + 4, 240.0);
+        if i % 2 == 0 {
+            pb.quad_to(x1, y1, x, y);
+        } else {
+            pb.cubic_to(x1, y1, x2, y2, x, y);
+        }
+    }
+    pb.close();
+    pb.finish().unwrap()
+}
+
+fn fill_curves(anti_alias: bool, ts: tiny_skia::Transform, bencher: &mut Bencher) {
+    use tiny_skia::*;
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = anti_alias;
+
+    let path = curves_path();
+
+    let mut pixmap = Pixmap::new(500, 500).unwrap();
+
+    bencher.iter(|| {
+        pixmap.fill_path(&path, &paint, FillRule::Winding, ts, None);
+    });
+}
+
+#[bench]
+fn batched_tiny_skia(bencher: &mut Bencher) {
+    fill_curves(false, tiny_skia::Transform::identity(), bencher);
+}
+
+#[bench]
+fn scalar_tiny_skia(bencher: &mut Bencher) {
+    fill_curves(false, tiny_skia::Transform::from_translate(-2.0, 0.0), bencher);
+}
+
+#[bench]
+fn batched_aa_tiny_skia(bencher: &mut Bencher) {
+    fill_curves(true, tiny_skia::Transform::identity(), bencher);
+}
+
+#[bench]
+fn scalar_aa_tiny_skia(bencher: &mut Bencher) {
+    fill_curves(true, tiny_skia::Transform::from_translate(-2.0, 0.0), bencher);
+}
@@ -139,6 +139,51 @@ fn rect_aa_cairo(bencher: &mut Bencher) {
     });
 }
 
+fn small_rects() -> Vec<tiny_skia::Rect> {
+    let mut rects = Vec::new();
+    for y in 0..100 {
+        for x in 0..100 {
+            let rect = tiny_skia::Rect::from_xywh(x as f32 * 10.3, y as f32 * 9.7, 8.5, 7.25);
+            rects.push(rect.unwrap());
+        }
+    }
+    rects
+}
+
+#[bench]
+fn many_rects_aa_tiny_skia(bencher: &mut Bencher) {
+    use tiny_skia::*;
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let rects = small_rects();
+    let mut pixmap = Pixmap::new(1000, 1000).unwrap();
+
+    bencher.iter(|| {
+        for rect in &rects {
+            pixmap.fill_rect(*rect, &paint, Transform::identity(), None);
+        }
+    });
+}
+
+#[bench]
+fn many_rects_aa_batch_tiny_skia(bencher: &mut Bencher) {
+    use tiny_skia::*;
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let rects = small_rects();
+    let mut pixmap = Pixmap::new(1000, 1000).unwrap();
+
+    bencher.iter(|| {
+        pixmap.fill_rects(&rects, &paint, Transform::identity(), None);
+    });
+}
+
 #[bench]
 fn rect_aa_ts_tiny_skia(bencher: &mut Bencher) {
     use tiny_skia::*;
@@ -283,6 +283,29 @@ fn aa_tiny_skia(bencher: &mut Bencher) {
     draw_tiny_skia(true, bencher);
 }
 
+fn chart_points() -> Vec<tiny_skia::Point> {
+    (0..100_000).map(|i| {
+        let x = i as f32 * 0.01;
+        tiny_skia::Point::from_xy(x, 500.0 + (x * 0.7).sin() * 400.0 + (i % 7) as f32)
+    }).collect()
+}
+
+#[bench]
+fn chart_aa_tiny_skia(bencher: &mut Bencher) {
+    use tiny_skia::*;
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let points = chart_points();
+    let mut pixmap = Pixmap::new(1000, 1000).unwrap();
+
+    bencher.iter(|| {
+        pixmap.stroke_hairlines(&points, true, &paint, Transform::identity(), None);
+    });
+}
+
 #[cfg(feature = "skia-rs")]
 #[bench]
 fn skia(bencher: &mut Bencher) {
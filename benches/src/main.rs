@@ -4,10 +4,12 @@ extern crate test;
 
 #[cfg(test)] mod blend;
 #[cfg(test)] mod clip;
+#[cfg(test)] mod curves;
 #[cfg(test)] mod fill;
 #[cfg(test)] mod gradients;
 #[cfg(test)] mod hairline;
 #[cfg(test)] mod patterns;
+#[cfg(test)] mod pipeline_cache;
 #[cfg(test)] mod png_io;
 #[cfg(test)] mod spiral;
 
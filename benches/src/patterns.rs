@@ -80,6 +80,35 @@ fn hq_tiny_skia(bencher: &mut Bencher) {
     )
 }
 
+#[bench]
+fn rotated_image_tiny_skia(bencher: &mut Bencher) {
+    use tiny_skia::*;
+
+    // A source image larger than the CPU cache, sampled along rotated rows.
+    let mut image = Pixmap::new(1024, 1024).unwrap();
+    for (i, pixel) in image.pixels_mut().iter_mut().enumerate() {
+        let c = (i % 251) as u8;
+        *pixel = ColorU8::from_rgba(c, 255 - c, c / 2, 255).premultiply();
+    }
+
+    let mut pixmap = Pixmap::new(1000, 1000).unwrap();
+
+    let mut paint = Paint::default();
+    paint.shader = Pattern::new(
+        image.as_ref(),
+        SpreadMode::Repeat,
+        FilterQuality::Bilinear,
+        1.0,
+        Transform::from_row(0.0, 1.0, -1.0, 0.0, 1000.0, 0.0),
+    );
+
+    let rect = Rect::from_xywh(0.0, 0.0, 1000.0, 1000.0).unwrap();
+
+    bencher.iter(|| {
+        pixmap.fill_rect(rect, &paint, Transform::identity(), None);
+    });
+}
+
 #[cfg(feature = "skia-rs")]
 fn pattern_skia(
     quality: skia_rs::FilterQuality,
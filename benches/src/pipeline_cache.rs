@@ -0,0 +1,51 @@
+use test::Bencher;
+
+// Each fill compiles 3 pipelines, which are cached per thread.
+// Small fills are used, so compilation dominates.
+//
+// Both benchmarks use the same low precision blend modes and the same number of fills.
+// `hits_tiny_skia` cycles through 10 of them, which take 30 of 32 cache entries,
+// so every lookup is a hit. `misses_tiny_skia` adds one more mode, so that 33 programs
+// are cycled through and every lookup is a miss, which has to compile a program.
+
+const FILLS: usize = 110;
+
+fn fill_tiny_skia(blend_modes: &[tiny_skia::BlendMode], bencher: &mut Bencher) {
+    use tiny_skia::*;
+
+    let paints: Vec<Paint> = blend_modes.iter().cycle().take(FILLS).map(|mode| {
+        let mut paint = Paint::default();
+        paint.set_color_rgba8(50, 127, 150, 200);
+        paint.blend_mode = *mode;
+        paint
+    }).collect();
+
+    let rect = Rect::from_xywh(2.5, 2.5, 4.0, 4.0).unwrap();
+
+    let mut pixmap = Pixmap::new(10, 10).unwrap();
+
+    bencher.iter(|| {
+        for paint in &paints {
+            pixmap.fill_rect(rect, paint, Transform::identity(), None);
+        }
+    });
+}
+
+// Modes without shortcuts, like memset, that are supported by the low precision pipeline.
+const MODES: &[tiny_skia::BlendMode] = {
+    use tiny_skia::BlendMode::*;
+    &[
+        DestinationOver, SourceIn, DestinationIn, SourceOut, DestinationOut, SourceAtop,
+        DestinationAtop, Xor, Plus, Modulate, Screen,
+    ]
+};
+
+#[bench]
+fn hits_tiny_skia(bencher: &mut Bencher) {
+    fill_tiny_skia(&MODES[..10], bencher);
+}
+
+#[bench]
+fn misses_tiny_skia(bencher: &mut Bencher) {
+    fill_tiny_skia(MODES, bencher);
+}
@@ -5,7 +5,7 @@
 
 use alloc::vec::Vec;
 
-use crate::{Path, LengthU32, FillRule};
+use crate::{Path, LengthU32, FillRule, IntRect, Point, PathSegment};
 use crate::{ALPHA_U8_OPAQUE, ALPHA_U8_TRANSPARENT};
 
 use crate::alpha_runs::AlphaRun;
@@ -13,21 +13,82 @@ use crate::blitter::Blitter;
 use crate::color::AlphaU8;
 use crate::geom::ScreenIntRect;
 use crate::math::LENGTH_U32_ONE;
+use crate::wide::u16x16;
 use core::num::NonZeroU32;
 
+/// A clip mask layout.
+#[derive(Copy, Clone, PartialEq, Debug)]
+pub enum ClipKind {
+    /// The mask wasn't set or was cleared. Nothing can be drawn.
+    Empty,
+    /// Everything is clipped out.
+    ClipAll,
+    /// Everything inside the rectangle is fully visible and nothing outside of it.
+    Rect(ScreenIntRect),
+    /// The coverage inside the rectangle is stored in `data`. Nothing outside is visible.
+    Mask(ScreenIntRect),
+}
+
 #[derive(Clone, Debug)]
 pub struct ClipMaskData {
+    /// The coverage inside the `ClipKind::Mask` bounds, row by row.
     pub data: Vec<u8>,
     pub width: LengthU32,
     pub height: LengthU32,
+    pub kind: ClipKind,
 }
 
 impl ClipMaskData {
     pub(crate) fn clip_mask_ctx(&self) -> crate::pipeline::ClipMaskCtx {
-        crate::pipeline::ClipMaskCtx {
-            data: &self.data,
-            stride: self.width,
+        self.clip_mask_ctx_from_row(0)
+    }
+
+    /// Returns a clip mask context that starts at the row `y`.
+    pub(crate) fn clip_mask_ctx_from_row(&self, y: u32) -> crate::pipeline::ClipMaskCtx {
+        match self.kind {
+            ClipKind::Mask(ref bounds) => {
+                // The mask data offset in coordinates relative to the row `y`.
+                // Can be "negative", therefore wrapping arithmetic is used.
+                let stride = bounds.width() as usize;
+                let shift = stride.wrapping_mul((bounds.y() as usize).wrapping_sub(y as usize))
+                    .wrapping_add(bounds.x() as usize);
+
+                crate::pipeline::ClipMaskCtx {
+                    data: &self.data,
+                    stride: bounds.width_safe(),
+                    shift,
+                }
+            }
+            _ => crate::pipeline::ClipMaskCtx::default(),
+        }
+    }
+
+    /// Shrinks the mask data to the `bounds`, which must be inside the current ones.
+    fn crop(&mut self, bounds: ScreenIntRect) {
+        let current = match self.kind {
+            ClipKind::Mask(rect) => rect,
+            _ => return,
+        };
+
+        let stride = current.width() as usize;
+        let width = bounds.width() as usize;
+        let dx = (bounds.x() - current.x()) as usize;
+        let dy = (bounds.y() - current.y()) as usize;
+        if bounds != current {
+            // Rows only move towards the start.
+            for y in 0..bounds.height() as usize {
+                let start = (dy + y) * stride + dx;
+                self.data.copy_within(start..start + width, y * width);
+            }
         }
+
+        self.data.truncate(width * bounds.height() as usize);
+        self.kind = ClipKind::Mask(bounds);
+    }
+
+    fn clip_all(&mut self) {
+        self.data.clear();
+        self.kind = ClipKind::ClipAll;
     }
 }
 
@@ -36,6 +97,10 @@ impl ClipMaskData {
 ///
 /// Unlike Skia, we're using just a simple 8bit alpha mask.
 /// It's way slower, but times easier to implement.
+///
+/// Only the area covered by the clipping path is stored, and integer
+/// rectangles are stored as is, without any coverage data at all.
+/// Drawing with a rectangular mask is as fast as drawing without one.
 #[derive(Clone, Debug)]
 pub struct ClipMask {
     pub(crate) mask: ClipMaskData,
@@ -48,6 +113,7 @@ impl Default for ClipMask {
                 data: Vec::new(),
                 width: LENGTH_U32_ONE,
                 height: LENGTH_U32_ONE,
+                kind: ClipKind::Empty,
             }
         }
     }
@@ -61,7 +127,7 @@ impl ClipMask {
 
     /// Checks that mask is empty.
     pub fn is_empty(&self) -> bool {
-        self.mask.data.is_empty()
+        self.mask.kind == ClipKind::Empty
     }
 
     /// Sets the current clipping path.
@@ -82,20 +148,96 @@ impl ClipMask {
 
         self.mask.width = width;
         self.mask.height = height;
+        self.mask.kind = ClipKind::ClipAll;
 
         // Reuse the existing allocation.
         self.mask.data.clear();
-        self.mask.data.resize((width.get() * height.get()) as usize, 0);
 
         let clip = ScreenIntRect::from_xywh_safe(0, 0, width, height);
 
+        // An integer rectangle is either fully covered or not covered at all,
+        // with and without anti-aliasing.
+        if let Some(rect) = int_rect_path(path) {
+            let rect = rect.intersect(&clip.to_int_rect())?.to_screen_int_rect()?;
+            self.mask.kind = ClipKind::Rect(rect);
+            return Some(());
+        }
+
+        let bounds = self.alloc_path_mask(path, &clip)?;
+
+        // The whole mask is still used as a clip, so the coverage is not affected by the bounds.
         if anti_alias {
-            let mut builder = ClipBuilderAA(&mut self.mask);
-            crate::scan::path_aa::fill_path(path, fill_rule, &clip, &mut builder)
+            let mut builder = ClipBuilderAA(&mut self.mask.data, bounds);
+            crate::scan::path_aa::fill_path(path.into(), fill_rule, &clip, &mut builder)
         } else {
-            let mut builder = ClipBuilder(&mut self.mask);
-            crate::scan::path::fill_path(path, fill_rule, &clip, &mut builder)
+            let mut builder = ClipBuilder(&mut self.mask.data, bounds);
+            crate::scan::path::fill_path(path.into(), fill_rule, &clip, &mut builder)
+        }
+    }
+
+    /// Sets the current clipping path using multiple threads.
+    ///
+    /// The mask is split into horizontal bands, which are rasterized in parallel,
+    /// while path edges are built only once and advanced to each band start
+    /// on the current thread. Each band walks only its own rows.
+    /// The result is identical to [`set_path`](#method.set_path).
+    ///
+    /// Useful mainly for large and complex paths. Masks larger than 8191 pixels
+    /// in any direction are built on the current thread.
+    #[cfg(feature = "parallel")]
+    pub fn set_path_parallel(
+        &mut self,
+        width: u32,
+        height: u32,
+        path: &Path,
+        fill_rule: FillRule,
+        anti_alias: bool,
+    ) -> Option<()> {
+        // Bands share edges, which cannot be built for large masks.
+        let clip = ScreenIntRect::from_xywh(0, 0, width, height)?;
+        if crate::scan::tiler::DrawTiler::required(&clip) || int_rect_path(path).is_some() {
+            return self.set_path(width, height, path, fill_rule, anti_alias);
         }
+
+        self.mask.width = clip.width_safe();
+        self.mask.height = clip.height_safe();
+        self.mask.kind = ClipKind::ClipAll;
+        self.mask.data.clear();
+
+        let bounds = self.alloc_path_mask(path, &clip)?;
+
+        let mut paint = crate::Paint::default();
+        paint.anti_alias = anti_alias;
+        let path_bands = crate::scan::band::BandedPath::new(path.into(), fill_rule, &paint, &clip)?;
+
+        let band_height = crate::scan::band::band_height(bounds.height());
+        let band_len = band_height as usize * bounds.width() as usize;
+        let builder = &BandMaskBuilder { clip, bounds, anti_alias };
+        rayon::scope(|s| {
+            let parts = path_bands.bands(bounds.y(), bounds.bottom(), band_height);
+            let bands = self.mask.data.chunks_mut(band_len);
+            for (i, (part, data)) in parts.zip(bands).enumerate() {
+                let top = bounds.y() + i as u32 * band_height;
+                s.spawn(move |_| {
+                    builder.fill(part, top, data);
+                });
+            }
+        });
+
+        Some(())
+    }
+
+    /// Allocates zeroed mask data for the path coverage inside the `clip`.
+    ///
+    /// Returns the mask bounds.
+    fn alloc_path_mask(&mut self, path: &Path, clip: &ScreenIntRect) -> Option<ScreenIntRect> {
+        // Anti-aliasing doesn't affect pixels outside the outset bounds.
+        let bounds = crate::scan::tiler::outset_bounds(&path.bounds())?
+            .intersect(&clip.to_int_rect())?
+            .to_screen_int_rect()?;
+        self.mask.data.resize((bounds.width() * bounds.height()) as usize, 0);
+        self.mask.kind = ClipKind::Mask(bounds);
+        Some(bounds)
     }
 
     /// Intersects the provided path with the current clipping path.
@@ -107,14 +249,66 @@ impl ClipMask {
         fill_rule: FillRule,
         anti_alias: bool,
     ) -> Option<()> {
-        let mut submask = ClipMask::new();
-        submask.set_path(self.mask.width.get(), self.mask.height.get(), path, fill_rule, anti_alias)?;
+        let current = match self.mask.kind {
+            ClipKind::Empty | ClipKind::ClipAll => return Some(()),
+            ClipKind::Rect(rect) | ClipKind::Mask(rect) => rect,
+        };
+
+        let clip = ScreenIntRect::from_xywh_safe(0, 0, self.mask.width, self.mask.height);
+
+        // An integer rectangle doesn't change the coverage inside of it.
+        if let Some(rect) = int_rect_path(path) {
+            let rect = rect.intersect(&clip.to_int_rect())?;
+            match rect.intersect(&current.to_int_rect()).and_then(|r| r.to_screen_int_rect()) {
+                Some(bounds) => {
+                    if let ClipKind::Rect(_) = self.mask.kind {
+                        self.mask.kind = ClipKind::Rect(bounds);
+                    } else {
+                        self.mask.crop(bounds);
+                    }
+                }
+                None => self.mask.clip_all(),
+            }
 
-        for (a, b) in self.mask.data.iter_mut().zip(submask.mask.data.iter()) {
-            *a = (((u16::from(*a)) * u16::from(*b)) >> 8) as u8;
+            return Some(());
         }
 
-        Some(())
+        let path_bounds = crate::scan::tiler::outset_bounds(&path.bounds())?
+            .intersect(&clip.to_int_rect())?;
+        let bounds = match path_bounds.intersect(&current.to_int_rect())
+            .and_then(|r| r.to_screen_int_rect())
+        {
+            Some(v) => v,
+            None => {
+                self.mask.clip_all();
+                return Some(());
+            }
+        };
+
+        if let ClipKind::Rect(_) = self.mask.kind {
+            // A rectangle is fully covered inside.
+            self.mask.data.clear();
+            self.mask.data.resize((bounds.width() * bounds.height()) as usize, ALPHA_U8_OPAQUE);
+            self.mask.kind = ClipKind::Mask(bounds);
+        } else {
+            self.mask.crop(bounds);
+        }
+
+        // The whole canvas is still used as a clip, so the coverage is not affected by the bounds.
+        let mut builder = IntersectBuilder {
+            data: &mut self.mask.data,
+            bounds,
+            next: 0,
+        };
+
+        let result = if anti_alias {
+            crate::scan::path_aa::fill_path(path.into(), fill_rule, &clip, &mut builder)
+        } else {
+            crate::scan::path::fill_path(path.into(), fill_rule, &clip, &mut builder)
+        };
+
+        builder.finish();
+        result
     }
 
     /// Clears the mask.
@@ -123,29 +317,120 @@ impl ClipMask {
     pub fn clear(&mut self) {
         // Clear the mask, but keep the allocation.
         self.mask.data.clear();
+        self.mask.kind = ClipKind::Empty;
     }
 }
 
+/// Returns the path bounds when the path is an axis-aligned rectangle with integer edges.
+fn int_rect_path(path: &Path) -> Option<IntRect> {
+    let bounds = path.bounds();
+    let is_int = |n: f32| n == n.trunc() && n.abs() <= i32::MAX as f32 / 2.0;
+    if !(is_int(bounds.left()) && is_int(bounds.top())
+        && is_int(bounds.right()) && is_int(bounds.bottom()))
+    {
+        return None;
+    }
+
+    // Expects a single contour of 4 distinct corners, connected by axis-aligned edges.
+    let mut points = [Point::zero(); 5];
+    let mut count = 0;
+    let mut closed = false;
+    for segment in path.segments() {
+        match segment {
+            PathSegment::MoveTo(p) if count == 0 => {
+                points[0] = p;
+                count = 1;
+            }
+            PathSegment::LineTo(p) if count > 0 && count < points.len() && !closed => {
+                points[count] = p;
+                count += 1;
+            }
+            PathSegment::Close if count > 0 && !closed => closed = true,
+            _ => return None,
+        }
+    }
+
+    // An explicit closing edge.
+    if count == 5 {
+        if points[4] != points[0] {
+            return None;
+        }
+
+        count = 4;
+    }
+
+    if count != 4 {
+        return None;
+    }
 
-struct ClipBuilder<'a>(&'a mut ClipMaskData);
+    let is_corner = |p: Point| (p.x == bounds.left() || p.x == bounds.right())
+        && (p.y == bounds.top() || p.y == bounds.bottom());
+
+    for i in 0..4 {
+        let p = points[i];
+        let next = points[(i + 1) % 4];
+        let opposite = points[(i + 2) % 4];
+        if !is_corner(p) || p == next || p == opposite || (p.x != next.x && p.y != next.y) {
+            return None;
+        }
+    }
+
+    IntRect::from_ltrb(
+        bounds.left() as i32,
+        bounds.top() as i32,
+        bounds.right() as i32,
+        bounds.bottom() as i32,
+    )
+}
+
+
+/// Rasterizes bands of a mask, which are stored in separate slices.
+#[cfg(feature = "parallel")]
+struct BandMaskBuilder {
+    clip: ScreenIntRect,
+    /// Mask bounds.
+    bounds: ScreenIntRect,
+    anti_alias: bool,
+}
+
+#[cfg(feature = "parallel")]
+impl BandMaskBuilder {
+    /// Fills a `part` of the path onto the band that starts at the `top` row.
+    fn fill(&self, part: crate::scan::band::PathBand, top: u32, data: &mut [u8]) -> Option<()> {
+        let height = (data.len() / self.bounds.width() as usize) as u32;
+        // Bands use absolute coordinates, but write only their own rows.
+        let band = ScreenIntRect::from_xywh(0, top, self.clip.width(), height)?;
+        let bounds = ScreenIntRect::from_xywh(self.bounds.x(), top, self.bounds.width(), height)?;
+        if self.anti_alias {
+            part.fill(&band, 0, &mut ClipBuilderAA(data, bounds))
+        } else {
+            part.fill(&band, 0, &mut ClipBuilder(data, bounds))
+        }
+    }
+}
+
+
+/// Writes the coverage into mask data that covers the `.1` bounds.
+struct ClipBuilder<'a>(&'a mut [u8], ScreenIntRect);
 
 impl Blitter for ClipBuilder<'_> {
     fn blit_h(&mut self, x: u32, y: u32, width: LengthU32) {
-        let offset = (y * self.0.width.get() + x) as usize;
+        let offset = mask_offset(&self.1, x, y);
         for i in 0..width.get() as usize {
-            self.0.data[offset + i] = 255;
+            self.0[offset + i] = 255;
         }
     }
 }
 
 
-struct ClipBuilderAA<'a>(&'a mut ClipMaskData);
+/// Writes the coverage into mask data that covers the `.1` bounds.
+struct ClipBuilderAA<'a>(&'a mut [u8], ScreenIntRect);
 
 impl Blitter for ClipBuilderAA<'_> {
     fn blit_h(&mut self, x: u32, y: u32, width: LengthU32) {
-        let offset = (y * self.0.width.get() + x) as usize;
+        let offset = mask_offset(&self.1, x, y);
         for i in 0..width.get() as usize {
-            self.0.data[offset + i] = 255;
+            self.0[offset + i] = 255;
         }
     }
 
@@ -162,9 +447,9 @@ impl Blitter for ClipBuilderAA<'_> {
                     self.blit_h(x, y, width);
                 }
                 alpha => {
-                    let offset = (y * self.0.width.get() + x) as usize;
+                    let offset = mask_offset(&self.1, x, y);
                     for i in 0..width.get() as usize {
-                        self.0.data[offset + i] = alpha;
+                        self.0[offset + i] = alpha;
                     }
                 }
             }
@@ -176,3 +461,145 @@ impl Blitter for ClipBuilderAA<'_> {
         }
     }
 }
+
+/// Multiplies mask data that covers the `bounds` by the coverage.
+///
+/// Scan converters produce spans row by row and from left to right,
+/// therefore everything between the spans is not covered and is cleared.
+/// Spans outside the `bounds` are ignored.
+struct IntersectBuilder<'a> {
+    data: &'a mut [u8],
+    bounds: ScreenIntRect,
+    /// The first data index that wasn't processed yet.
+    next: usize,
+}
+
+impl IntersectBuilder<'_> {
+    fn blit_span(&mut self, x: u32, y: u32, width: u32, alpha: AlphaU8) {
+        if y < self.bounds.top() || y >= self.bounds.bottom() {
+            return;
+        }
+
+        let left = x.max(self.bounds.left());
+        let right = x.saturating_add(width).min(self.bounds.right());
+        if left >= right {
+            return;
+        }
+
+        let start = mask_offset(&self.bounds, left, y);
+        let end = start + (right - left) as usize;
+        debug_assert!(start >= self.next);
+        if start > self.next {
+            clear(&mut self.data[self.next..start]);
+        }
+
+        // Full coverage doesn't affect the mask.
+        if alpha != ALPHA_U8_OPAQUE {
+            intersect_span(&mut self.data[start..end], alpha);
+        }
+
+        self.next = self.next.max(end);
+    }
+
+    /// Clears everything after the last span.
+    fn finish(&mut self) {
+        let next = self.next.min(self.data.len());
+        clear(&mut self.data[next..]);
+        self.next = self.data.len();
+    }
+}
+
+impl Blitter for IntersectBuilder<'_> {
+    fn blit_h(&mut self, x: u32, y: u32, width: LengthU32) {
+        self.blit_span(x, y, width.get(), ALPHA_U8_OPAQUE);
+    }
+
+    fn blit_anti_h(&mut self, mut x: u32, y: u32, aa: &mut [AlphaU8], runs: &mut [AlphaRun]) {
+        let mut aa_offset = 0;
+        let mut run_offset = 0;
+        let mut run_opt = runs[0];
+        while let Some(run) = run_opt {
+            let width = u32::from(run.get());
+
+            // Not covered pixels are cleared by the next span anyway.
+            if aa[aa_offset] != ALPHA_U8_TRANSPARENT {
+                self.blit_span(x, y, width, aa[aa_offset]);
+            }
+
+            x += width;
+            run_offset += usize::from(run.get());
+            aa_offset += usize::from(run.get());
+            run_opt = runs[run_offset];
+        }
+    }
+}
+
+/// Combines two coverage values.
+///
+/// Full coverage doesn't affect the other value.
+#[inline]
+fn intersect_coverage(a: AlphaU8, b: AlphaU8) -> AlphaU8 {
+    match (a, b) {
+        (ALPHA_U8_OPAQUE, _) => b,
+        (_, ALPHA_U8_OPAQUE) => a,
+        _ => ((u16::from(a) * u16::from(b)) >> 8) as u8,
+    }
+}
+
+/// Combines coverage values with a single one, 16 values at a time.
+///
+/// Produces the same results as `intersect_coverage`. `alpha` must not be opaque,
+/// since an opaque one doesn't change the data anyway.
+fn intersect_span(data: &mut [u8], alpha: AlphaU8) {
+    let alpha16 = u16x16::splat(u16::from(alpha));
+    let opaque = u16x16::splat(u16::from(ALPHA_U8_OPAQUE));
+    let div = u16x16::splat(256);
+
+    let mut chunks = data.chunks_exact_mut(16);
+    for chunk in &mut chunks {
+        let mut coverage = u16x16::splat(0);
+        for (v, c) in coverage.0.iter_mut().zip(chunk.iter()) {
+            *v = u16::from(*c);
+        }
+
+        let coverage = opaque.cmp_le(&coverage).blend(alpha16, coverage * alpha16 / div);
+        for (c, v) in chunk.iter_mut().zip(coverage.as_slice().iter()) {
+            *c = *v as u8;
+        }
+    }
+
+    for c in chunks.into_remainder() {
+        *c = intersect_coverage(*c, alpha);
+    }
+}
+
+#[inline]
+fn clear(data: &mut [u8]) {
+    // Compiles into memset.
+    for c in data {
+        *c = 0;
+    }
+}
+
+#[inline]
+fn mask_offset(bounds: &ScreenIntRect, x: u32, y: u32) -> usize {
+    ((y - bounds.y()) * bounds.width() + x - bounds.x()) as usize
+}
+
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn intersect_span_matches_scalar() {
+        let coverage: Vec<u8> = (0..=255).collect();
+        for alpha in 0..255 {
+            let mut data = coverage.clone();
+            intersect_span(&mut data, alpha);
+            for (c, result) in coverage.iter().zip(data.iter()) {
+                assert_eq!(*result, intersect_coverage(*c, alpha));
+            }
+        }
+    }
+}
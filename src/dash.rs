@@ -156,6 +156,37 @@ fn find_first_interval(dash_array: &[f32], mut dash_offset: f32) -> (f32, usize)
 }
 
 pub fn dash(src: &Path, dash: &StrokeDash, res_scale: f32) -> Option<Path> {
+    dash_into(src, dash, res_scale, &mut ContourMeasure::default(), PathBuilder::new())
+}
+
+/// Dashes a path into the provided builder.
+///
+/// `contour` is a scratch buffer, which allows reusing its allocations between calls.
+pub(crate) fn dash_into(
+    src: &Path,
+    dash: &StrokeDash,
+    res_scale: f32,
+    contour: &mut ContourMeasure,
+    mut pb: PathBuilder,
+) -> Option<Path> {
+    dash_impl(src, dash, res_scale, contour, &mut pb, &mut |_| Some(()))?;
+    pb.finish()
+}
+
+/// Dashes a path.
+///
+/// `flush` is called with the builder right before a new dash is started and after
+/// the last one. It can consume the already added dashes and clear the builder.
+/// A dash may continue the previous one, therefore the builder is never flushed
+/// in the middle of a dash.
+pub(crate) fn dash_impl(
+    src: &Path,
+    dash: &StrokeDash,
+    res_scale: f32,
+    contour: &mut ContourMeasure,
+    pb: &mut PathBuilder,
+    flush: &mut dyn FnMut(&mut PathBuilder) -> Option<()>,
+) -> Option<()> {
     // We do not support the `cull_path` branch here.
     // Skia has a lot of code for cases when a path contains only a single zero-length line
     // or when a path is a rect. Not sure why.
@@ -168,9 +199,10 @@ pub fn dash(src: &Path, dash: &StrokeDash, res_scale: f32) -> Option<Path> {
         x % 2 == 0
     }
 
-    let mut pb = PathBuilder::new();
+    pb.clear();
     let mut dash_count = 0.0;
-    for contour in ContourMeasureIter::new(src, res_scale) {
+    let mut iter = ContourMeasureIter::new(src, res_scale);
+    while iter.next(contour).is_some() {
         let mut skip_first_segment = contour.is_closed;
         let mut added_segment = false;
         let length = contour.length;
@@ -200,7 +232,8 @@ pub fn dash(src: &Path, dash: &StrokeDash, res_scale: f32) -> Option<Path> {
             added_segment = false;
             if is_even(index) && !skip_first_segment {
                 added_segment = true;
-                contour.push_segment(distance as f32, (distance + d_len) as f32, true, &mut pb);
+                flush(pb)?;
+                contour.push_segment(distance as f32, (distance + d_len) as f32, true, pb);
             }
 
             distance += d_len;
@@ -221,11 +254,15 @@ pub fn dash(src: &Path, dash: &StrokeDash, res_scale: f32) -> Option<Path> {
 
         // extend if we ended on a segment and we need to join up with the (skipped) initial segment
         if contour.is_closed && is_even(dash.first_index) && dash.first_len >= 0.0 {
-            contour.push_segment(0.0, dash.first_len, !added_segment, &mut pb);
+            if !added_segment {
+                flush(pb)?;
+            }
+
+            contour.push_segment(0.0, dash.first_len, !added_segment, pb);
         }
     }
 
-    pb.finish()
+    flush(pb)
 }
 
 
@@ -250,11 +287,12 @@ impl<'a> ContourMeasureIter<'a> {
     }
 }
 
-impl Iterator for ContourMeasureIter<'_> {
-    type Item = ContourMeasure;
-
+impl ContourMeasureIter<'_> {
+    /// Measures the next contour, reusing the `contour` allocations.
+    ///
+    /// Returns `None` when there are no contours left.
     // If it encounters a zero-length contour, it is skipped.
-    fn next(&mut self) -> Option<Self::Item> {
+    fn next(&mut self, contour: &mut ContourMeasure) -> Option<()> {
         // Note:
         // as we accumulate distance, we have to check that the result of +=
         // actually made it larger, since a very small delta might be > 0, but
@@ -262,7 +300,10 @@ impl Iterator for ContourMeasureIter<'_> {
         //
         // We do this check below, and in compute_quad_segs and compute_cubic_segs
 
-        let mut contour = ContourMeasure::default();
+        contour.segments.clear();
+        contour.points.clear();
+        contour.length = 0.0;
+        contour.is_closed = false;
 
         let mut point_index = 0;
         let mut distance = 0.0;
@@ -345,7 +386,7 @@ impl Iterator for ContourMeasureIter<'_> {
         if contour.points.is_empty() {
             None
         } else {
-            Some(contour)
+            Some(())
         }
     }
 }
@@ -376,8 +417,11 @@ impl Segment {
 }
 
 
-#[derive(Default, Debug)]
-struct ContourMeasure {
+/// A measured contour.
+///
+/// Can be reused between contours and paths to avoid allocations.
+#[derive(Clone, Default, Debug)]
+pub(crate) struct ContourMeasure {
     segments: Vec<Segment>,
     points: Vec<Point>,
     length: f32,
@@ -0,0 +1,187 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+use alloc::vec;
+use alloc::vec::Vec;
+
+use crate::{ClipMask, FillRule, IntRect, PathBuilder};
+
+use crate::geom::{IntSize, ScreenIntRect};
+
+/// Areas of a pixmap changed by drawing.
+///
+/// The region is tracked using a grid of 64x64 tiles, so the cost of tracking
+/// doesn't depend on the amount of drawing calls, only on their size.
+/// A tile is marked as dirty when any pixel inside of it was touched by a blitter.
+///
+/// Use [`PixmapMut::with_dirty_region`](struct.PixmapMut.html#method.with_dirty_region)
+/// to start tracking. Afterwards, [`rects`](#method.rects) can be used
+/// to copy or encode only changed areas, using `Pixmap::clone_rect`,
+/// and [`to_clip_mask`](#method.to_clip_mask) can be used to limit
+/// a redraw to those areas.
+///
+/// Direct pixels modifications, via `PixmapMut::data_mut` and such, are not tracked.
+#[derive(Clone, PartialEq, Debug)]
+pub struct DirtyRegion {
+    tiles: Vec<bool>,
+    columns: u32,
+    rows: u32,
+    size: IntSize,
+}
+
+impl DirtyRegion {
+    /// The tile size used for tracking.
+    pub const TILE_SIZE: u32 = 64;
+
+    /// Creates a new, empty region for a pixmap with the specified size.
+    ///
+    /// Zero size is an error.
+    pub fn new(width: u32, height: u32) -> Option<Self> {
+        let size = IntSize::from_wh(width, height)?;
+        let columns = (width + Self::TILE_SIZE - 1) / Self::TILE_SIZE;
+        let rows = (height + Self::TILE_SIZE - 1) / Self::TILE_SIZE;
+        Some(DirtyRegion {
+            tiles: vec![false; columns as usize * rows as usize],
+            columns,
+            rows,
+            size,
+        })
+    }
+
+    /// Returns region's width.
+    pub fn width(&self) -> u32 {
+        self.size.width()
+    }
+
+    /// Returns region's height.
+    pub fn height(&self) -> u32 {
+        self.size.height()
+    }
+
+    /// Checks that nothing has been changed.
+    pub fn is_empty(&self) -> bool {
+        !self.tiles.iter().any(|t| *t)
+    }
+
+    /// Marks everything as not changed.
+    pub fn clear(&mut self) {
+        self.tiles.iter_mut().for_each(|t| *t = false);
+    }
+
+    /// Marks the whole pixmap as changed.
+    pub fn add_all(&mut self) {
+        self.tiles.iter_mut().for_each(|t| *t = true);
+    }
+
+    /// Marks a rectangle as changed.
+    ///
+    /// Parts outside the pixmap are ignored.
+    pub fn add_rect(&mut self, rect: IntRect) {
+        let rect = rect.intersect(&self.size.to_int_rect(0, 0))
+            .and_then(|r| r.to_screen_int_rect());
+        if let Some(rect) = rect {
+            self.add_screen_rect(&rect);
+        }
+    }
+
+    /// Marks a rectangle inside the pixmap as changed.
+    pub(crate) fn add_screen_rect(&mut self, rect: &ScreenIntRect) {
+        // Clamp, in case the region is smaller than the pixmap.
+        let left = rect.left() / Self::TILE_SIZE;
+        let top = rect.top() / Self::TILE_SIZE;
+        let right = ((rect.right() - 1) / Self::TILE_SIZE).min(self.columns - 1);
+        let bottom = ((rect.bottom() - 1) / Self::TILE_SIZE).min(self.rows - 1);
+        for row in top..=bottom {
+            let start = (row * self.columns) as usize;
+            for column in left..=right {
+                self.tiles[start + column as usize] = true;
+            }
+        }
+    }
+
+    /// Returns changed areas as non-overlapping rectangles.
+    ///
+    /// Adjacent dirty tiles are merged, so the amount of rectangles is usually small.
+    pub fn rects(&self) -> Vec<IntRect> {
+        let mut rects: Vec<IntRect> = Vec::new();
+        // Indices of rectangles that end at the previous tile row and can be extended down.
+        let mut open = Vec::new();
+        let mut next_open = Vec::new();
+        for row in 0..self.rows {
+            let mut column = 0;
+            while column < self.columns {
+                if !self.tile(column, row) {
+                    column += 1;
+                    continue;
+                }
+
+                let start = column;
+                while column < self.columns && self.tile(column, row) {
+                    column += 1;
+                }
+
+                let rect = match self.tiles_rect(start, column, row) {
+                    Some(v) => v,
+                    None => continue,
+                };
+
+                let above = open.iter().copied().find(|idx: &usize| {
+                    let r = &rects[*idx];
+                    r.left() == rect.left() && r.right() == rect.right()
+                });
+
+                match above {
+                    Some(idx) => {
+                        let r = rects[idx];
+                        rects[idx] = IntRect::from_ltrb(
+                            r.left(), r.top(), r.right(), rect.bottom(),
+                        ).unwrap_or(r);
+                        next_open.push(idx);
+                    }
+                    None => {
+                        rects.push(rect);
+                        next_open.push(rects.len() - 1);
+                    }
+                }
+            }
+
+            core::mem::swap(&mut open, &mut next_open);
+            next_open.clear();
+        }
+
+        rects
+    }
+
+    /// Returns a clip mask that contains only changed areas.
+    ///
+    /// Returns `None` when nothing has been changed.
+    pub fn to_clip_mask(&self) -> Option<ClipMask> {
+        let mut pb = PathBuilder::new();
+        for rect in self.rects() {
+            pb.push_rect(
+                rect.x() as f32, rect.y() as f32, rect.width() as f32, rect.height() as f32,
+            );
+        }
+        let path = pb.finish()?;
+
+        let mut mask = ClipMask::new();
+        mask.set_path(self.width(), self.height(), &path, FillRule::Winding, false)?;
+        Some(mask)
+    }
+
+    #[inline]
+    fn tile(&self, column: u32, row: u32) -> bool {
+        self.tiles[(row * self.columns + column) as usize]
+    }
+
+    fn tiles_rect(&self, start: u32, end: u32, row: u32) -> Option<IntRect> {
+        IntRect::from_ltrb(
+            (start * Self::TILE_SIZE) as i32,
+            (row * Self::TILE_SIZE) as i32,
+            (end * Self::TILE_SIZE).min(self.width()) as i32,
+            ((row + 1) * Self::TILE_SIZE).min(self.height()) as i32,
+        )
+    }
+}
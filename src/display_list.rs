@@ -0,0 +1,395 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+use alloc::vec::Vec;
+
+use crate::{Path, Paint, FillRule, Rect, IntRect, Transform, Shader, Stroke, LineCap};
+use crate::{ClipMask, PixmapMut, PixmapRef, PixmapPaint, Pattern, SpreadMode, PathBuilder};
+
+use crate::painter;
+use crate::pipeline::RasterPipelineBlitter;
+use crate::stroker::PathStroker;
+
+/// How many groups back a command can be moved to join a group with the same state.
+const MAX_REORDER_DISTANCE: usize = 16;
+
+
+/// A recorded list of drawing commands.
+///
+/// Unlike `Pixmap` drawing methods, which rasterize right away,
+/// a display list stores commands and draws them all at once later.
+/// Which allows:
+///
+/// - Skipping commands outside the target pixmap.
+/// - Reusing rendering pipelines between commands with the same paint,
+///   transform and clip mask.
+/// - Moving commands that don't overlap, to group commands with the same state.
+///
+/// The result is identical to drawing commands one by one. Because of that, commands
+/// are moved only when this doesn't affect the blending order.
+///
+/// Paths are transformed and stroked during recording.
+#[derive(Clone, Default, Debug)]
+pub struct DisplayList<'a> {
+    paints: Vec<Paint<'a>>,
+    commands: Vec<Command<'a>>,
+}
+
+#[derive(Clone, Debug)]
+struct Command<'a> {
+    kind: CommandKind,
+    paint: usize,
+    /// Shader transform.
+    transform: Transform,
+    clip_mask: Option<&'a ClipMask>,
+    /// Conservative device-space bounds.
+    bounds: IntRect,
+}
+
+#[derive(Clone, Debug)]
+enum CommandKind {
+    /// An already transformed path.
+    FillPath(Path, FillRule),
+    /// A non-transformed rectangle.
+    FillRect(Rect),
+    /// An already transformed path.
+    Hairline(Path, LineCap),
+}
+
+impl<'a> DisplayList<'a> {
+    /// Creates a new, empty list.
+    pub fn new() -> Self {
+        DisplayList::default()
+    }
+
+    /// Returns the amount of recorded commands.
+    pub fn len(&self) -> usize {
+        self.commands.len()
+    }
+
+    /// Checks that there are no recorded commands.
+    pub fn is_empty(&self) -> bool {
+        self.commands.is_empty()
+    }
+
+    /// Removes all recorded commands, while preserving the allocated memory.
+    pub fn clear(&mut self) {
+        self.paints.clear();
+        self.commands.clear();
+    }
+
+    /// Records a filled rectangle.
+    ///
+    /// See [`PixmapMut::fill_rect`](struct.PixmapMut.html#method.fill_rect) for details.
+    pub fn fill_rect(
+        &mut self,
+        rect: Rect,
+        paint: &Paint<'a>,
+        transform: Transform,
+        clip_mask: Option<&'a ClipMask>,
+    ) {
+        if transform.is_identity() {
+            let bounds = match outset_bounds(rect, 1) {
+                Some(v) => v,
+                None => return,
+            };
+
+            self.push(CommandKind::FillRect(rect), paint, transform, clip_mask, bounds);
+        } else {
+            let path = PathBuilder::from_rect(rect);
+            self.fill_path(path, paint, FillRule::Winding, transform, clip_mask);
+        }
+    }
+
+    /// Records a filled path.
+    ///
+    /// See [`PixmapMut::fill_path`](struct.PixmapMut.html#method.fill_path) for details.
+    pub fn fill_path(
+        &mut self,
+        mut path: Path,
+        paint: &Paint<'a>,
+        fill_rule: FillRule,
+        transform: Transform,
+        clip_mask: Option<&'a ClipMask>,
+    ) {
+        if !transform.is_identity() {
+            path = match path.transform(transform) {
+                Some(v) => v,
+                None => return,
+            };
+        }
+
+        if !painter::is_fillable_path((&path).into()) {
+            return;
+        }
+
+        let bounds = match outset_bounds(path.bounds(), 1) {
+            Some(v) => v,
+            None => return,
+        };
+
+        self.push(CommandKind::FillPath(path, fill_rule), paint, transform, clip_mask, bounds);
+    }
+
+    /// Records a stroked path.
+    ///
+    /// See [`PixmapMut::stroke_path`](struct.PixmapMut.html#method.stroke_path) for details.
+    pub fn stroke_path(
+        &mut self,
+        path: &Path,
+        paint: &Paint<'a>,
+        stroke: &Stroke,
+        transform: Transform,
+        clip_mask: Option<&'a ClipMask>,
+    ) {
+        if stroke.width < 0.0 {
+            return;
+        }
+
+        let res_scale = PathStroker::compute_resolution_scale(&transform);
+
+        let dash_path;
+        let path = if let Some(ref dash) = stroke.dash {
+            dash_path = match crate::dash::dash(path, dash, res_scale) {
+                Some(v) => v,
+                None => return,
+            };
+            &dash_path
+        } else {
+            path
+        };
+
+        if let Some(paint) = painter::hairline_paint(paint, stroke, transform) {
+            let path = match path.clone().transform(transform) {
+                Some(v) => v,
+                None => return,
+            };
+
+            // Caps and anti-aliasing can spill slightly outside the path bounds.
+            let bounds = match outset_bounds(path.bounds(), 2) {
+                Some(v) => v,
+                None => return,
+            };
+
+            self.push(CommandKind::Hairline(path, stroke.line_cap), &paint, transform,
+                      clip_mask, bounds);
+        } else {
+            if let Some(path) = PathStroker::new().stroke(path, stroke, res_scale) {
+                self.fill_path(path, paint, FillRule::Winding, transform, clip_mask);
+            }
+        }
+    }
+
+    /// Records a `Pixmap` drawing.
+    ///
+    /// See [`PixmapMut::draw_pixmap`](struct.PixmapMut.html#method.draw_pixmap) for details.
+    pub fn draw_pixmap(
+        &mut self,
+        x: i32,
+        y: i32,
+        pixmap: PixmapRef<'a>,
+        paint: &PixmapPaint,
+        transform: Transform,
+        clip_mask: Option<&'a ClipMask>,
+    ) {
+        let rect = pixmap.size().to_int_rect(x, y).to_rect();
+
+        // Translate pattern as well as bounds.
+        let patt_transform = Transform::from_translate(x as f32, y as f32);
+
+        let paint = Paint {
+            shader: Pattern::new(
+                pixmap,
+                SpreadMode::Pad, // Pad, otherwise we will get weird borders overlap.
+                paint.quality,
+                paint.opacity,
+                patt_transform,
+            ),
+            blend_mode: paint.blend_mode,
+            anti_alias: false, // Skia doesn't use it too.
+            analytic_aa: false,
+            force_hq_pipeline: false, // Bicubic filtering will use hq anyway.
+        };
+
+        self.fill_rect(rect, &paint, transform, clip_mask)
+    }
+
+    fn push(
+        &mut self,
+        kind: CommandKind,
+        paint: &Paint<'a>,
+        transform: Transform,
+        clip_mask: Option<&'a ClipMask>,
+        bounds: IntRect,
+    ) {
+        let paint = self.push_paint(paint);
+        self.commands.push(Command {
+            kind,
+            paint,
+            transform,
+            clip_mask,
+            bounds,
+        });
+    }
+
+    fn push_paint(&mut self, paint: &Paint<'a>) -> usize {
+        if let Some(idx) = self.paints.iter().position(|p| is_same_paint(p, paint)) {
+            return idx;
+        }
+
+        self.paints.push(paint.clone());
+        self.paints.len() - 1
+    }
+
+    /// Draws all recorded commands onto the pixmap.
+    ///
+    /// Commands that cannot be drawn, like in the case of a numeric overflow,
+    /// are silently skipped.
+    pub fn draw(&self, pixmap: &mut PixmapMut) {
+        let pixmap_rect = pixmap.size().to_screen_int_rect(0, 0);
+        let pixmap_int_rect = pixmap_rect.to_int_rect();
+
+        let groups = self.group_commands(&pixmap_int_rect);
+        for group in &groups {
+            let first = &self.commands[group.commands[0]];
+
+            let mut paint = self.paints[first.paint].clone();
+            if !first.transform.is_identity() {
+                paint.shader.transform(first.transform);
+            }
+
+            let (clip_rect, clip_mask) = match painter::clip_area(pixmap.size(), first.clip_mask) {
+                Some(v) => v,
+                None => continue,
+            };
+
+            let clip_int_rect = clip_rect.to_int_rect();
+            if group.bounds.intersect(&clip_int_rect).is_none() {
+                continue;
+            }
+
+            let mut blitter = match RasterPipelineBlitter::new(&paint, clip_mask, pixmap) {
+                Some(v) => v,
+                None => continue,
+            };
+
+            for idx in &group.commands {
+                let command = &self.commands[*idx];
+                if command.bounds.intersect(&clip_int_rect).is_none() {
+                    continue;
+                }
+
+                match command.kind {
+                    CommandKind::FillPath(ref path, fill_rule) => {
+                        painter::fill_path_impl(
+                            path.into(), fill_rule, &paint, &clip_rect, &mut blitter,
+                        );
+                    }
+                    CommandKind::FillRect(ref rect) => {
+                        painter::fill_rect_impl(rect, paint.anti_alias, &clip_rect, &mut blitter);
+                    }
+                    CommandKind::Hairline(ref path, line_cap) => {
+                        painter::stroke_hairline_impl(
+                            path.into(), line_cap, paint.anti_alias, &clip_rect, &mut blitter,
+                        );
+                    }
+                }
+            }
+        }
+    }
+
+    /// Splits visible commands into groups that can share a blitter.
+    ///
+    /// A command can join an earlier group with the same state only when it doesn't
+    /// overlap any command recorded in between. Drawing order of overlapping
+    /// commands is always preserved.
+    fn group_commands(&self, pixmap_rect: &IntRect) -> Vec<Group> {
+        let mut groups: Vec<Group> = Vec::new();
+        for (idx, command) in self.commands.iter().enumerate() {
+            if command.bounds.intersect(pixmap_rect).is_none() {
+                continue;
+            }
+
+            let mut target = None;
+            for (group_idx, group) in groups.iter().enumerate().rev().take(MAX_REORDER_DISTANCE) {
+                let other = &self.commands[group.commands[0]];
+                if other.paint == command.paint
+                    && other.transform == command.transform
+                    && is_same_clip_mask(other.clip_mask, command.clip_mask)
+                {
+                    target = Some(group_idx);
+                    break;
+                }
+
+                if group.bounds.intersect(&command.bounds).is_some() {
+                    break;
+                }
+            }
+
+            match target {
+                Some(group_idx) => {
+                    let group = &mut groups[group_idx];
+                    group.commands.push(idx);
+                    group.bounds = union(&group.bounds, &command.bounds);
+                }
+                None => {
+                    let mut commands = Vec::new();
+                    commands.push(idx);
+                    groups.push(Group { commands, bounds: command.bounds });
+                }
+            }
+        }
+
+        groups
+    }
+}
+
+struct Group {
+    commands: Vec<usize>,
+    bounds: IntRect,
+}
+
+fn is_same_clip_mask(a: Option<&ClipMask>, b: Option<&ClipMask>) -> bool {
+    match (a, b) {
+        (Some(a), Some(b)) => core::ptr::eq(a, b),
+        (None, None) => true,
+        _ => false,
+    }
+}
+
+/// Patterns are compared by the referenced pixels and not by their values,
+/// since pixels comparison is way too expensive.
+fn is_same_paint(a: &Paint, b: &Paint) -> bool {
+    match (&a.shader, &b.shader) {
+        (Shader::Pattern(pa), Shader::Pattern(pb)) => {
+            let Paint { shader: _, blend_mode, anti_alias, analytic_aa, force_hq_pipeline } = *a;
+            pa.is_same(pb)
+                && blend_mode == b.blend_mode
+                && anti_alias == b.anti_alias
+                && analytic_aa == b.analytic_aa
+                && force_hq_pipeline == b.force_hq_pipeline
+        }
+        _ => a == b,
+    }
+}
+
+fn outset_bounds(rect: Rect, outset: i32) -> Option<IntRect> {
+    let r = rect.round_out();
+    IntRect::from_ltrb(
+        r.left().checked_sub(outset)?,
+        r.top().checked_sub(outset)?,
+        r.right().checked_add(outset)?,
+        r.bottom().checked_add(outset)?,
+    )
+}
+
+fn union(a: &IntRect, b: &IntRect) -> IntRect {
+    IntRect::from_ltrb(
+        a.left().min(b.left()),
+        a.top().min(b.top()),
+        a.right().max(b.right()),
+        a.bottom().max(b.bottom()),
+    ).unwrap()
+}
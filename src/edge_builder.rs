@@ -6,12 +6,13 @@
 
 use alloc::vec::Vec;
 
-use crate::{Point, Path};
+use crate::Point;
 
 use crate::edge::{Edge, LineEdge, QuadraticEdge, CubicEdge};
 use crate::edge_clipper::EdgeClipperIter;
+use crate::flatten;
 use crate::geom::ScreenIntRect;
-use crate::path::PathEdge;
+use crate::path::{PathEdge, TransformedPath};
 use crate::path_geometry;
 
 #[derive(Copy, Clone, PartialEq, Debug)]
@@ -72,7 +73,7 @@ impl BasicEdgeBuilder {
     // Skia returns a linked list here, but it's a nightmare to use in Rust,
     // so we're mimicking it with Vec.
     pub fn build_edges(
-        path: &Path,
+        path: TransformedPath,
         clip: Option<&ShiftedIntRect>,
         clip_shift: i32,
     ) -> Option<Vec<Edge>> {
@@ -87,13 +88,15 @@ impl BasicEdgeBuilder {
             return None;
         }
 
+        count!(EDGES, builder.edges.len());
+
         Some(builder.edges)
     }
 
     // TODO: build_poly
     pub fn build(
         &mut self,
-        path: &Path,
+        path: TransformedPath,
         clip: Option<&ShiftedIntRect>,
         can_cull_to_the_right: bool,
     ) -> Option<()> {
@@ -129,29 +132,26 @@ impl BasicEdgeBuilder {
                 }
             }
         } else {
-            for edge in path.edge_iter() {
-                match edge {
-                    PathEdge::LineTo(p0, p1) => {
-                        self.push_line(&[p0, p1]);
-                    }
-                    PathEdge::QuadTo(p0, p1, p2) => {
-                        let points = [p0, p1, p2];
-                        let mut mono_x = [Point::zero(); 5];
-                        let n = path_geometry::chop_quad_at_y_extrema(&points, &mut mono_x);
-                        for i in 0..=n {
-                            self.push_quad(&mono_x[i * 2..]);
-                        }
+            // Curves are chopped using extrema computed for a batch of curves at a time.
+            flatten::for_each_edge(path, |edge| match edge {
+                flatten::ExtremaEdge::Line(points) => {
+                    self.push_line(&points);
+                }
+                flatten::ExtremaEdge::Quad(points, extremum) => {
+                    let mut mono_x = [Point::zero(); 5];
+                    let n = path_geometry::chop_quad_at_y_extremum(&points, extremum, &mut mono_x);
+                    for i in 0..=n {
+                        self.push_quad(&mono_x[i * 2..]);
                     }
-                    PathEdge::CubicTo(p0, p1, p2, p3) => {
-                        let points = [p0, p1, p2, p3];
-                        let mut mono_y = [Point::zero(); 10];
-                        let n = path_geometry::chop_cubic_at_y_extrema(&points, &mut mono_y);
-                        for i in 0..=n {
-                            self.push_cubic(&mono_y[i * 3..]);
-                        }
+                }
+                flatten::ExtremaEdge::Cubic(points, coeff) => {
+                    let mut mono_y = [Point::zero(); 10];
+                    let n = path_geometry::chop_cubic_at_y_extrema_coeff(&points, coeff, &mut mono_y);
+                    for i in 0..=n {
+                        self.push_cubic(&mono_y[i * 3..]);
                     }
                 }
-            }
+            });
         }
 
         Some(())
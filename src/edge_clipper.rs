@@ -6,11 +6,11 @@
 
 use arrayvec::ArrayVec;
 
-use crate::{Path, Point, Rect};
+use crate::{Point, Rect};
 
 use crate::floating_point::NormalizedF32Exclusive;
 use crate::line_clipper;
-use crate::path::{PathEdge, PathEdgeIter};
+use crate::path::{PathEdge, PathEdgeIter, TransformedPath};
 use crate::path_geometry;
 use crate::scalar::SCALAR_MAX;
 
@@ -88,7 +88,7 @@ impl EdgeClipper {
         let pts = [p0, p1, p2];
         let bounds = Rect::from_points(&pts)?;
 
-        if !quick_reject(&bounds, &self.clip) {
+        if !quick_reject(&bounds, &self.clip) && !self.clip_outside_x(&bounds, p0, p2) {
             let mut mono_y = [Point::zero(); 5];
             let count_y = path_geometry::chop_quad_at_y_extrema(&pts, &mut mono_y);
             for y in 0..=count_y {
@@ -190,6 +190,35 @@ impl EdgeClipper {
         }
     }
 
+    /// Replaces a curve that lies entirely to the left or to the right of the clip
+    /// with a single vertical line from its start to its end.
+    ///
+    /// Monotonic pieces of such a curve would be turned into vertical lines anyway,
+    /// but they will simply cancel each other out, so there is no need to chop it.
+    ///
+    /// Returns `false` when the curve crosses the clip horizontally.
+    fn clip_outside_x(&mut self, bounds: &Rect, start: Point, end: Point) -> bool {
+        let x = if bounds.right() <= self.clip.left() {
+            self.clip.left()
+        } else if bounds.left() >= self.clip.right() {
+            if self.can_cull_to_the_right {
+                return true;
+            }
+
+            self.clip.right()
+        } else {
+            return false;
+        };
+
+        let y0 = start.y.max(self.clip.top()).min(self.clip.bottom());
+        let y1 = end.y.max(self.clip.top()).min(self.clip.bottom());
+        if y0 != y1 {
+            self.push_vline(x, y0, y1, false);
+        }
+
+        true
+    }
+
     fn push_quad(&mut self, pts: &[Point; 3], reverse: bool) {
         if reverse {
             self.edges.push(PathEdge::QuadTo(pts[2], pts[1], pts[0]));
@@ -204,7 +233,9 @@ impl EdgeClipper {
 
         // check if we're clipped out vertically
         if bounds.bottom() > self.clip.top() && bounds.top() < self.clip.bottom() {
-            if too_big_for_reliable_float_math(&bounds) {
+            if self.clip_outside_x(&bounds, p0, p3) {
+                // Already clipped.
+            } else if too_big_for_reliable_float_math(&bounds) {
                 // can't safely clip the cubic, so we give up and draw a line (which we can safely clip)
                 //
                 // If we rewrote chopcubicat*extrema and chopmonocubic using doubles, we could very
@@ -318,7 +349,7 @@ pub struct EdgeClipperIter<'a> {
 }
 
 impl<'a> EdgeClipperIter<'a> {
-    pub fn new(path: &'a Path, clip: Rect, can_cull_to_the_right: bool) -> Self {
+    pub fn new(path: TransformedPath<'a>, clip: Rect, can_cull_to_the_right: bool) -> Self {
         EdgeClipperIter {
             edge_iter: path.edge_iter(),
             clip,
@@ -0,0 +1,520 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+//! Curve flattening, shared by the edge builder, hairline scanners and analytic anti-aliasing.
+//!
+//! Per-curve math is done for many curves, or many points of a curve, at once using `f32x8`.
+//! Lane operations match the scalar code in `path_geometry` exactly,
+//! so the results are identical and only the amount of instructions is different.
+
+use crate::{PathSegment, Point};
+
+use crate::floating_point::{NormalizedF32Exclusive, SaturateCast};
+use crate::path::{PathEdge, TransformedPath};
+use crate::path_geometry::{self, QuadExtremum};
+use crate::scalar::Scalar;
+use crate::wide::{f32x2, f32x8};
+
+#[cfg(all(not(feature = "std"), feature = "libm"))]
+use crate::scalar::FloatExt;
+
+pub const MAX_CUBIC_SUBDIVIDE_LEVEL: u8 = 9;
+pub const MAX_QUAD_SUBDIVIDE_LEVEL: u8 = 5;
+
+/// Maximum distance between a curve and its `flatten_path` lines, in pixels.
+const FLATTENING_TOLERANCE: f32 = 0.025;
+const MAX_FLATTENED_LINES: usize = 64;
+
+/// A path edge with the Y extrema of its curve.
+#[derive(Copy, Clone)]
+pub enum ExtremaEdge {
+    Line([Point; 2]),
+    Quad([Point; 3], QuadExtremum),
+    /// Points and `path_geometry::cubic_extrema_coeff` of Y coordinates.
+    Cubic([Point; 4], [f32; 3]),
+}
+
+/// The number of edges buffered while collecting curves for a batch.
+const EDGES_PER_BATCH: usize = 32;
+
+/// Iterates over path edges, computing Y extrema of 8 curves at a time.
+///
+/// Edges are buffered until enough curves are collected,
+/// so they are still visited in the `TransformedPath::edge_iter` order.
+pub fn for_each_edge<F: FnMut(ExtremaEdge)>(path: TransformedPath, mut f: F) {
+    let mut edges = [PathEdge::LineTo(Point::zero(), Point::zero()); EDGES_PER_BATCH];
+    let mut len = 0;
+    let mut quads = 0;
+    let mut cubics = 0;
+    for edge in path.edge_iter() {
+        match edge {
+            PathEdge::LineTo(..) => {}
+            PathEdge::QuadTo(..) => quads += 1,
+            PathEdge::CubicTo(..) => cubics += 1,
+        }
+
+        edges[len] = edge;
+        len += 1;
+
+        if len == EDGES_PER_BATCH || quads == 8 || cubics == 8 {
+            flush_edges(&edges[0..len], &mut f);
+            len = 0;
+            quads = 0;
+            cubics = 0;
+        }
+    }
+
+    flush_edges(&edges[0..len], &mut f);
+}
+
+/// Visits edges with at most 8 quads and 8 cubics.
+fn flush_edges<F: FnMut(ExtremaEdge)>(edges: &[PathEdge], f: &mut F) {
+    let mut quads_y = [[0.0; 3]; 8];
+    let mut cubics_y = [[0.0; 4]; 8];
+    let mut quads = 0;
+    let mut cubics = 0;
+    for edge in edges {
+        match *edge {
+            PathEdge::LineTo(..) => {}
+            PathEdge::QuadTo(p0, p1, p2) => {
+                quads_y[quads] = [p0.y, p1.y, p2.y];
+                quads += 1;
+            }
+            PathEdge::CubicTo(p0, p1, p2, p3) => {
+                cubics_y[cubics] = [p0.y, p1.y, p2.y, p3.y];
+                cubics += 1;
+            }
+        }
+    }
+
+    let mut quads_extrema = [QuadExtremum::None; 8];
+    if quads != 0 {
+        quads_extrema_into(&quads_y[0..quads], &mut quads_extrema);
+    }
+
+    let mut cubics_coeff = [[0.0; 3]; 8];
+    if cubics != 0 {
+        cubics_extrema_coeff_into(&cubics_y[0..cubics], &mut cubics_coeff);
+    }
+
+    let mut quads_extrema = quads_extrema.iter();
+    let mut cubics_coeff = cubics_coeff.iter();
+    for edge in edges {
+        // Cannot run out of extrema, since each curve has its own.
+        f(match *edge {
+            PathEdge::LineTo(p0, p1) => ExtremaEdge::Line([p0, p1]),
+            PathEdge::QuadTo(p0, p1, p2) => {
+                ExtremaEdge::Quad([p0, p1, p2], *quads_extrema.next().unwrap())
+            }
+            PathEdge::CubicTo(p0, p1, p2, p3) => {
+                ExtremaEdge::Cubic([p0, p1, p2, p3], *cubics_coeff.next().unwrap())
+            }
+        });
+    }
+}
+
+/// Batched `path_geometry::find_quad_extremum`.
+fn quads_extrema_into(quads: &[[f32; 3]], dst: &mut [QuadExtremum; 8]) {
+    debug_assert!(quads.len() <= 8);
+
+    let (a, b, c) = transpose3(quads);
+    let ab = a - b;
+    let bc = b - c;
+    // `valid_unit_divide(a - b, a - b - b + c)`.
+    // The sign normalization doesn't affect the quotient, so can be done later.
+    let denom = ab - b + c;
+    let t = ab / denom;
+
+    let ab: [f32; 8] = bytemuck::cast(ab);
+    let bc: [f32; 8] = bytemuck::cast(bc);
+    let denom: [f32; 8] = bytemuck::cast(denom);
+    let t: [f32; 8] = bytemuck::cast(t);
+    for i in 0..quads.len() {
+        // `is_not_monotonic`
+        let bc = if ab[i] < 0.0 { -bc[i] } else { bc[i] };
+        if !(ab[i] == 0.0 || bc < 0.0) {
+            dst[i] = QuadExtremum::None;
+            continue;
+        }
+
+        let (numer, denom) = if ab[i] < 0.0 { (-ab[i], -denom[i]) } else { (ab[i], denom[i]) };
+        let t = if denom == 0.0 || numer == 0.0 || numer >= denom {
+            None
+        } else {
+            NormalizedF32Exclusive::new(t[i])
+        };
+
+        dst[i] = match t {
+            Some(t) => QuadExtremum::At(t),
+            None => QuadExtremum::Unresolved,
+        };
+    }
+}
+
+/// Batched `path_geometry::cubic_extrema_coeff`.
+///
+/// Roots are still found one by one, since they require double precision.
+fn cubics_extrema_coeff_into(cubics: &[[f32; 4]], dst: &mut [[f32; 3]; 8]) {
+    debug_assert!(cubics.len() <= 8);
+
+    let mut a = [0.0; 8];
+    let mut b = [0.0; 8];
+    let mut c = [0.0; 8];
+    let mut d = [0.0; 8];
+    for (i, cubic) in cubics.iter().enumerate() {
+        a[i] = cubic[0];
+        b[i] = cubic[1];
+        c[i] = cubic[2];
+        d[i] = cubic[3];
+    }
+
+    let (a, b, c, d) = (f32x8::from(a), f32x8::from(b), f32x8::from(c), f32x8::from(d));
+    let na: [f32; 8] = bytemuck::cast(d - a + f32x8::splat(3.0) * (b - c));
+    let nb: [f32; 8] = bytemuck::cast(f32x8::splat(2.0) * (a - b - b + c));
+    let nc: [f32; 8] = bytemuck::cast(b - a);
+    for i in 0..cubics.len() {
+        dst[i] = [na[i], nb[i], nc[i]];
+    }
+}
+
+fn transpose3(values: &[[f32; 3]]) -> (f32x8, f32x8, f32x8) {
+    let mut a = [0.0; 8];
+    let mut b = [0.0; 8];
+    let mut c = [0.0; 8];
+    for (i, v) in values.iter().enumerate() {
+        a[i] = v[0];
+        b[i] = v[1];
+        c[i] = v[2];
+    }
+
+    (f32x8::from(a), f32x8::from(b), f32x8::from(c))
+}
+
+
+/// Flattens a quad into `lines` lines.
+///
+/// Writes `lines + 1` points into `dst`. The end points are copied as is.
+pub fn quad_points(points: &[Point; 3], lines: usize, dst: &mut [Point]) {
+    let coeff = path_geometry::QuadCoeff::from_points(points);
+    let a = splat_xy(coeff.a);
+    let b = splat_xy(coeff.b);
+    let c = splat_xy(coeff.c);
+
+    dst[0] = points[0];
+    eval_points(lines, dst, |t| (a * t + b) * t + c);
+    dst[lines] = points[2];
+}
+
+/// Flattens a cubic into `lines` lines.
+///
+/// Writes `lines + 1` points into `dst`. The end points are copied as is.
+pub fn cubic_points(points: &[Point; 4], lines: usize, dst: &mut [Point]) {
+    let coeff = path_geometry::CubicCoeff::from_points(points);
+    let a = splat_xy(coeff.a);
+    let b = splat_xy(coeff.b);
+    let c = splat_xy(coeff.c);
+    let d = splat_xy(coeff.d);
+
+    dst[0] = points[0];
+    eval_points(lines, dst, |t| ((a * t + b) * t + c) * t + d);
+    dst[lines] = points[3];
+}
+
+/// Evaluates inner points, four at a time.
+///
+/// Each point occupies two lanes, and `t` is accumulated the same way
+/// a single point evaluation does it, to get identical results.
+#[inline]
+fn eval_points<F: Fn(f32x8) -> f32x8>(lines: usize, dst: &mut [Point], eval: F) {
+    debug_assert!(lines > 0);
+    debug_assert!(dst.len() > lines);
+
+    let dt = 1.0 / lines as f32;
+    let mut t = 0.0;
+    let mut i = 1;
+    while i < lines {
+        let count = (lines - i).min(4);
+        let mut ts = [0.0; 8];
+        for n in 0..count {
+            t += dt;
+            ts[n * 2] = t;
+            ts[n * 2 + 1] = t;
+        }
+
+        let values: [f32; 8] = bytemuck::cast(eval(f32x8::from(ts)));
+        for n in 0..count {
+            dst[i + n] = Point::from_xy(values[n * 2], values[n * 2 + 1]);
+        }
+
+        i += count;
+    }
+}
+
+fn splat_xy(v: f32x2) -> f32x8 {
+    f32x8::from([v.x(), v.y(), v.x(), v.y(), v.x(), v.y(), v.x(), v.y()])
+}
+
+
+/// Converts a path into closed polylines.
+///
+/// Unlike hairlines, which are flattened with a pixel precision,
+/// curves are split into lines closer than `FLATTENING_TOLERANCE` to them.
+pub fn flatten_path(path: TransformedPath, line_fn: &mut dyn FnMut(Point, Point)) {
+    let mut tmp = [Point::zero(); MAX_FLATTENED_LINES + 1];
+    let mut start = Point::zero();
+    let mut last = Point::zero();
+    for segment in path.segments() {
+        match segment {
+            PathSegment::MoveTo(p) => {
+                if last != start {
+                    line_fn(last, start);
+                }
+
+                start = p;
+                last = p;
+            }
+            PathSegment::LineTo(p) => {
+                line_fn(last, p);
+                last = p;
+            }
+            PathSegment::QuadTo(p1, p2) => {
+                let points = [last, p1, p2];
+                let dd = (last - p1.scaled(2.0) + p2).length();
+                let lines = lines_count(dd * 0.25);
+                quad_points(&points, lines, &mut tmp);
+                for pair in tmp[0..lines + 1].windows(2) {
+                    line_fn(pair[0], pair[1]);
+                }
+
+                last = p2;
+            }
+            PathSegment::CubicTo(p1, p2, p3) => {
+                let points = [last, p1, p2, p3];
+                let dd = (last - p1.scaled(2.0) + p2).length()
+                    .max((p1 - p2.scaled(2.0) + p3).length());
+                let lines = lines_count(dd * 0.75);
+                cubic_points(&points, lines, &mut tmp);
+                for pair in tmp[0..lines + 1].windows(2) {
+                    line_fn(pair[0], pair[1]);
+                }
+
+                last = p3;
+            }
+            PathSegment::Close => {
+                if last != start {
+                    line_fn(last, start);
+                }
+
+                last = start;
+            }
+        }
+    }
+
+    if last != start {
+        line_fn(last, start);
+    }
+}
+
+/// Returns the amount of lines needed to flatten a curve,
+/// which flattening error is `error / n^2`.
+fn lines_count(error: f32) -> usize {
+    let n = (error / FLATTENING_TOLERANCE).sqrt().ceil();
+    if n.is_finite() {
+        (n as usize).max(1).min(MAX_FLATTENED_LINES)
+    } else {
+        1
+    }
+}
+
+
+/// Returns the number of times a quad has to be halved,
+/// so lines connecting its points are closer than a pixel to the curve.
+pub fn quad_level(points: &[Point; 3]) -> u8 {
+    let d = int_quad_dist(points);
+    // Quadratics approach the line connecting their start and end points
+    // 4x closer with each subdivision, so we compute the number of
+    // subdivisions to be the minimum need to get that distance to be less
+    // than a pixel.
+    let mut level = (33 - d.leading_zeros()) >> 1;
+    // sanity check on level (from the previous version)
+    if level > MAX_QUAD_SUBDIVIDE_LEVEL as u32 {
+        level = MAX_QUAD_SUBDIVIDE_LEVEL as u32;
+    }
+
+    level as u8
+}
+
+fn int_quad_dist(points: &[Point; 3]) -> u32 {
+    // compute the vector between the control point ([1]) and the middle of the
+    // line connecting the start and end ([0] and [2])
+    let dx = ((points[0].x + points[2].x).half() - points[1].x).abs();
+    let dy = ((points[0].y + points[2].y).half() - points[1].y).abs();
+
+    // convert to whole pixel values (use ceiling to be conservative).
+    // assign to unsigned so we can safely add 1/2 of the smaller and still fit in
+    // u32, since T::saturate_from() returns 31 bits at most.
+    let idx = i32::saturate_from(dx.ceil()) as u32;
+    let idy = i32::saturate_from(dy.ceil()) as u32;
+
+    // use the cheap approx for distance
+    if idx > idy {
+        idx + (idy >> 1)
+    } else {
+        idy + (idx >> 1)
+    }
+}
+
+/// Returns the number of lines a cubic has to be flattened into.
+pub fn cubic_segments(points: &[Point; 4]) -> usize {
+    let p0 = points[0].to_f32x2();
+    let p1 = points[1].to_f32x2();
+    let p2 = points[2].to_f32x2();
+    let p3 = points[3].to_f32x2();
+
+    let one_third = f32x2::splat(1.0 / 3.0);
+    let two_third = f32x2::splat(2.0 / 3.0);
+
+    let p13 = one_third * p3 + two_third * p0;
+    let p23 = one_third * p0 + two_third * p3;
+
+    let diff = (p1 - p13).abs().max((p2 - p23).abs()).max_component();
+    let mut tol = 1.0 / 8.0;
+
+    for i in 0..MAX_CUBIC_SUBDIVIDE_LEVEL {
+        if diff < tol {
+            return 1 << i;
+        }
+
+        tol *= 4.0;
+    }
+
+    1 << MAX_CUBIC_SUBDIVIDE_LEVEL
+}
+
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use alloc::vec::Vec;
+
+    struct Rng(u32);
+
+    impl Rng {
+        fn next(&mut self) -> f32 {
+            self.0 ^= self.0 << 13;
+            self.0 ^= self.0 >> 17;
+            self.0 ^= self.0 << 5;
+            (self.0 >> 8) as f32 / 65536.0 - 128.0
+        }
+
+        fn point(&mut self) -> Point {
+            Point::from_xy(self.next(), self.next())
+        }
+    }
+
+    #[test]
+    fn quads_extrema_match_scalar() {
+        let mut rng = Rng(0x1234_5678);
+        let mut quads: Vec<[f32; 3]> = (0..100).map(|_| [rng.next(), rng.next(), rng.next()]).collect();
+        // Degenerate cases.
+        quads.push([1.0, 1.0, 1.0]);
+        quads.push([0.0, 1.0, 0.0]);
+        quads.push([1.0, 2.0, 3.0]);
+        quads.push([1e-30, 2e-30, 1e-30]);
+
+        for chunk in quads.chunks(8) {
+            let mut batched = [QuadExtremum::None; 8];
+            quads_extrema_into(chunk, &mut batched);
+            for (q, e) in chunk.iter().zip(batched.iter()) {
+                assert!(path_geometry::find_quad_extremum(q[0], q[1], q[2]) == *e);
+            }
+        }
+    }
+
+    #[test]
+    fn cubics_extrema_coeff_match_scalar() {
+        let mut rng = Rng(0x8765_4321);
+        let cubics: Vec<[f32; 4]> = (0..100)
+            .map(|_| [rng.next(), rng.next(), rng.next(), rng.next()])
+            .collect();
+
+        for chunk in cubics.chunks(8) {
+            let mut batched = [[0.0; 3]; 8];
+            cubics_extrema_coeff_into(chunk, &mut batched);
+            for (c, coeff) in chunk.iter().zip(batched.iter()) {
+                assert_eq!(path_geometry::cubic_extrema_coeff(c[0], c[1], c[2], c[3]), *coeff);
+            }
+        }
+    }
+
+    #[test]
+    fn edges_keep_order() {
+        let mut rng = Rng(0x0BAD_F00D);
+        let mut pb = crate::PathBuilder::new();
+        pb.move_to(0.0, 0.0);
+        for i in 0..100 {
+            match i % 5 {
+                0 | 3 => pb.quad_to(rng.next(), rng.next(), rng.next(), rng.next()),
+                1 => pb.line_to(rng.next(), rng.next()),
+                _ => pb.cubic_to(rng.next(), rng.next(), rng.next(), rng.next(),
+                                 rng.next(), rng.next()),
+            }
+        }
+        let path = pb.finish().unwrap();
+        let path = TransformedPath::from(&path);
+
+        let mut edges = path.edge_iter();
+        let mut count = 0;
+        for_each_edge(path, |edge| {
+            count += 1;
+            match (edges.next().unwrap(), edge) {
+                (PathEdge::LineTo(p0, p1), ExtremaEdge::Line(points)) => {
+                    assert_eq!([p0, p1], points);
+                }
+                (PathEdge::QuadTo(p0, p1, p2), ExtremaEdge::Quad(points, e)) => {
+                    assert_eq!([p0, p1, p2], points);
+                    assert!(path_geometry::find_quad_extremum(p0.y, p1.y, p2.y) == e);
+                }
+                (PathEdge::CubicTo(p0, p1, p2, p3), ExtremaEdge::Cubic(points, coeff)) => {
+                    assert_eq!([p0, p1, p2, p3], points);
+                    assert_eq!(path_geometry::cubic_extrema_coeff(p0.y, p1.y, p2.y, p3.y), coeff);
+                }
+                _ => panic!("edges order mismatch"),
+            }
+        });
+
+        assert!(edges.next().is_none());
+        assert_eq!(count, 101);
+    }
+
+    #[test]
+    fn points_match_scalar() {
+        let mut rng = Rng(0xDEAD_BEEF);
+        for lines in 1..40 {
+            let quad = [rng.point(), rng.point(), rng.point()];
+            let cubic = [rng.point(), rng.point(), rng.point(), rng.point()];
+
+            let mut points = [Point::zero(); 41];
+            quad_points(&quad, lines, &mut points);
+            let coeff = path_geometry::QuadCoeff::from_points(&quad);
+            let dt = f32x2::splat(1.0 / lines as f32);
+            let mut t = f32x2::default();
+            for i in 1..lines {
+                t = t + dt;
+                assert_eq!(points[i], Point::from_f32x2(coeff.eval(t)));
+            }
+            assert_eq!(points[lines], quad[2]);
+
+            cubic_points(&cubic, lines, &mut points);
+            let coeff = path_geometry::CubicCoeff::from_points(&cubic);
+            let mut t = f32x2::default();
+            for i in 1..lines {
+                t = t + dt;
+                assert_eq!(points[i], Point::from_f32x2(coeff.eval(t)));
+            }
+            assert_eq!(points[lines], cubic[3]);
+        }
+    }
+}
@@ -598,6 +598,11 @@ impl ScreenIntRect {
         self.width
     }
 
+    /// Returns rect's height.
+    pub fn height_safe(&self) -> LengthU32 {
+        self.height
+    }
+
     /// Returns rect's left edge.
     pub fn left(&self) -> u32 {
         self.x
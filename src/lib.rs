@@ -36,19 +36,26 @@ extern crate std;
 
 extern crate alloc;
 
+#[macro_use]
+mod stats; // Must be the first one, since it defines macros.
+
 mod alpha_runs;
 mod blend_mode;
 mod blitter;
 mod clip;
 mod color;
 mod dash;
+mod dirty_region;
+mod display_list;
 mod edge;
 mod edge_builder;
 mod edge_clipper;
 mod fixed_point;
+mod flatten;
 mod floating_point;
 mod geom;
 mod line_clipper;
+mod mask;
 mod math;
 mod path64;
 mod path;
@@ -57,6 +64,7 @@ mod path_geometry;
 mod pipeline;
 mod pixmap;
 mod painter; // Keep it under `pixmap` for a better order in the docs.
+mod prepared_path;
 mod scalar;
 mod scan;
 mod shaders;
@@ -69,14 +77,22 @@ pub use clip::ClipMask;
 pub use color::{ALPHA_U8_TRANSPARENT, ALPHA_U8_OPAQUE, ALPHA_TRANSPARENT, ALPHA_OPAQUE};
 pub use color::{Color, ColorU8, PremultipliedColor, PremultipliedColorU8};
 pub use dash::StrokeDash;
+pub use dirty_region::DirtyRegion;
+pub use display_list::DisplayList;
 pub use geom::{IntRect, Rect, Point};
+pub use mask::Mask;
 pub use painter::{Paint, FillRule};
 pub use path::{Path, PathSegment, PathSegmentsIter};
 pub use path_builder::PathBuilder;
-pub use pixmap::{Pixmap, PixmapRef, PixmapMut, BYTES_PER_PIXEL};
+pub use pixmap::{Pixmap, PixmapRef, PixmapMut, PixelFormat, BYTES_PER_PIXEL};
+#[cfg(feature = "png-format")]
+pub use pixmap::PngEncodeOptions;
+pub use prepared_path::PreparedPath;
 pub use shaders::{GradientStop, SpreadMode, FilterQuality, PixmapPaint};
+#[cfg(feature = "stats")]
+pub use stats::RenderStats;
 pub use shaders::{Shader, LinearGradient, RadialGradient, Pattern};
-pub use stroker::{LineCap, LineJoin, Stroke};
+pub use stroker::{LineCap, LineJoin, Stroke, StrokeContext};
 pub use transform::Transform;
 
 /// An integer length that is guarantee to be > 0
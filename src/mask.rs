@@ -0,0 +1,269 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+use alloc::vec;
+use alloc::vec::Vec;
+
+use crate::{Path, FillRule, LengthU32, Paint, PixmapRef, Stroke, Transform};
+use crate::{ALPHA_U8_OPAQUE, ALPHA_U8_TRANSPARENT};
+
+use crate::alpha_runs::AlphaRun;
+use crate::blitter::Blitter;
+use crate::color::{premultiply_u8, AlphaU8};
+use crate::geom::{IntSize, ScreenIntRect};
+use crate::path::TransformedPath;
+use crate::stroker::PathStroker;
+
+/// An 8-bit coverage mask.
+///
+/// Unlike `Pixmap`, stores only a single coverage value per pixel,
+/// which makes it 4x smaller. Useful for rendering shadows, glyphs
+/// and other masks that are composited later using
+/// [`PixmapMut::fill_mask`](struct.PixmapMut.html#method.fill_mask).
+///
+/// Paths are blended onto the mask the same way as a `SourceOver` paint does,
+/// so overlapping paths accumulate their coverage.
+#[derive(Clone, PartialEq, Debug)]
+pub struct Mask {
+    data: Vec<u8>,
+    size: IntSize,
+}
+
+impl Mask {
+    /// Creates a new, empty mask.
+    ///
+    /// Zero size is an error.
+    pub fn new(width: u32, height: u32) -> Option<Self> {
+        let size = IntSize::from_wh(width, height)?;
+        let data_len = (width as usize).checked_mul(height as usize)?;
+        Some(Mask {
+            data: vec![ALPHA_U8_TRANSPARENT; data_len],
+            size,
+        })
+    }
+
+    /// Creates a mask from the pixmap alpha channel.
+    pub fn from_pixmap(pixmap: PixmapRef) -> Self {
+        Mask {
+            data: (0..pixmap.height()).flat_map(|y| pixmap.row(y)).map(|p| p.alpha()).collect(),
+            size: pixmap.size(),
+        }
+    }
+
+    /// Returns mask's width.
+    #[inline]
+    pub fn width(&self) -> u32 {
+        self.size.width()
+    }
+
+    /// Returns mask's height.
+    #[inline]
+    pub fn height(&self) -> u32 {
+        self.size.height()
+    }
+
+    /// Returns the internal data, row by row.
+    pub fn data(&self) -> &[u8] {
+        self.data.as_slice()
+    }
+
+    /// Returns the mutable internal data, row by row.
+    pub fn data_mut(&mut self) -> &mut [u8] {
+        self.data.as_mut_slice()
+    }
+
+    /// Fills the whole mask with the specified coverage.
+    pub fn fill(&mut self, coverage: u8) {
+        self.data.iter_mut().for_each(|c| *c = coverage);
+    }
+
+    /// Adds a filled path coverage to the mask.
+    ///
+    /// Returns `None` when there is nothing to fill or in case of a numeric overflow.
+    pub fn fill_path(
+        &mut self,
+        path: &Path,
+        fill_rule: FillRule,
+        anti_alias: bool,
+        transform: Transform,
+    ) -> Option<()> {
+        let path = TransformedPath::new(path, transform)?;
+        self.fill_transformed_path(path, fill_rule, anti_alias)
+    }
+
+    /// Adds a stroked path coverage to the mask.
+    ///
+    /// Thin anti-aliased strokes are rendered as hairlines with reduced coverage,
+    /// the same way as `PixmapMut::stroke_path` does.
+    ///
+    /// Returns `None` when there is nothing to stroke or in case of a numeric overflow.
+    pub fn stroke_path(
+        &mut self,
+        path: &Path,
+        stroke: &Stroke,
+        anti_alias: bool,
+        transform: Transform,
+    ) -> Option<()> {
+        if stroke.width < 0.0 {
+            return None;
+        }
+
+        let res_scale = PathStroker::compute_resolution_scale(&transform);
+
+        let dash_path;
+        let path = if let Some(ref dash) = stroke.dash {
+            dash_path = crate::dash::dash(path, dash, res_scale)?;
+            &dash_path
+        } else {
+            path
+        };
+
+        let mut paint = Paint::default();
+        paint.anti_alias = anti_alias;
+        if let Some(paint) = crate::painter::hairline_paint(&paint, stroke, transform) {
+            let alpha = match paint.shader {
+                crate::Shader::SolidColor(ref c) => c.premultiply().to_color_u8().alpha(),
+                _ => ALPHA_U8_OPAQUE,
+            };
+
+            let path = TransformedPath::new(path, transform)?;
+            let clip = self.size.to_screen_int_rect(0, 0);
+            if !crate::painter::intersects_clip(&path.bounds(), 2.0, &clip) {
+                return None;
+            }
+
+            let mut blitter = MaskBlitter::new(self, alpha);
+            crate::painter::stroke_hairline_impl(
+                path, stroke.line_cap, anti_alias, &clip, &mut blitter,
+            )
+        } else {
+            let path = PathStroker::new().stroke(path, stroke, res_scale)?;
+            let path = TransformedPath::new(&path, transform)?;
+            self.fill_transformed_path(path, FillRule::Winding, anti_alias)
+        }
+    }
+
+    fn fill_transformed_path(
+        &mut self,
+        path: TransformedPath,
+        fill_rule: FillRule,
+        anti_alias: bool,
+    ) -> Option<()> {
+        if !crate::painter::is_fillable_path(path) {
+            return None;
+        }
+
+        let clip = self.size.to_screen_int_rect(0, 0);
+        if !crate::painter::intersects_clip(&path.bounds(), 1.0, &clip) {
+            return None;
+        }
+
+        let mut paint = Paint::default();
+        paint.anti_alias = anti_alias;
+
+        let mut blitter = MaskBlitter::new(self, ALPHA_U8_OPAQUE);
+        crate::painter::fill_path_impl(path, fill_rule, &paint, &clip, &mut blitter)
+    }
+
+    /// Returns a pipeline clip mask context for the mask placed at `x` and `y`.
+    pub(crate) fn clip_mask_ctx(&self, x: i32, y: i32) -> crate::pipeline::ClipMaskCtx {
+        // Can be "negative", therefore wrapping arithmetic is used.
+        let stride = self.width() as usize;
+        let shift = stride.wrapping_mul(y as isize as usize).wrapping_add(x as isize as usize);
+
+        crate::pipeline::ClipMaskCtx {
+            data: &self.data,
+            stride: self.size.to_screen_int_rect(0, 0).width_safe(),
+            shift,
+        }
+    }
+}
+
+
+/// Blends the coverage onto mask data, like `ClipBuilderAA`, but accumulates it.
+struct MaskBlitter<'a> {
+    data: &'a mut [u8],
+    width: usize,
+    /// Coverage scale, used by thin hairlines.
+    alpha: AlphaU8,
+}
+
+impl<'a> MaskBlitter<'a> {
+    fn new(mask: &'a mut Mask, alpha: AlphaU8) -> Self {
+        MaskBlitter {
+            width: mask.width() as usize,
+            data: &mut mask.data,
+            alpha,
+        }
+    }
+
+    #[inline]
+    fn blend(&mut self, x: u32, y: u32, coverage: AlphaU8) {
+        let offset = y as usize * self.width + x as usize;
+        let c = premultiply_u8(coverage, self.alpha);
+        let d = self.data[offset];
+        self.data[offset] = c + premultiply_u8(d, 255 - c);
+    }
+}
+
+impl Blitter for MaskBlitter<'_> {
+    fn blit_h(&mut self, x: u32, y: u32, width: LengthU32) {
+        if self.alpha == ALPHA_U8_OPAQUE {
+            let offset = y as usize * self.width + x as usize;
+            let width = width.get() as usize;
+            self.data[offset..offset + width].iter_mut().for_each(|c| *c = ALPHA_U8_OPAQUE);
+        } else {
+            for i in 0..width.get() {
+                self.blend(x + i, y, ALPHA_U8_OPAQUE);
+            }
+        }
+    }
+
+    fn blit_anti_h(&mut self, mut x: u32, y: u32, aa: &mut [AlphaU8], runs: &mut [AlphaRun]) {
+        let mut offset = 0;
+        let mut run_opt = runs[0];
+        while let Some(run) = run_opt {
+            let width = LengthU32::from(run);
+
+            match aa[offset] {
+                ALPHA_U8_TRANSPARENT => {}
+                ALPHA_U8_OPAQUE => {
+                    self.blit_h(x, y, width);
+                }
+                alpha => {
+                    for i in 0..width.get() {
+                        self.blend(x + i, y, alpha);
+                    }
+                }
+            }
+
+            x += width.get();
+            offset += usize::from(run.get());
+            run_opt = runs[offset];
+        }
+    }
+
+    fn blit_v(&mut self, x: u32, y: u32, height: LengthU32, alpha: AlphaU8) {
+        for i in 0..height.get() {
+            self.blend(x, y + i, alpha);
+        }
+    }
+
+    fn blit_anti_h2(&mut self, x: u32, y: u32, alpha0: AlphaU8, alpha1: AlphaU8) {
+        self.blend(x, y, alpha0);
+        self.blend(x + 1, y, alpha1);
+    }
+
+    fn blit_anti_v2(&mut self, x: u32, y: u32, alpha0: AlphaU8, alpha1: AlphaU8) {
+        self.blend(x, y, alpha0);
+        self.blend(x, y + 1, alpha1);
+    }
+
+    fn blit_rect(&mut self, rect: &ScreenIntRect) {
+        for y in rect.top()..rect.bottom() {
+            self.blit_h(rect.x(), y, rect.width_safe());
+        }
+    }
+}
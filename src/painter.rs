@@ -6,17 +6,19 @@
 
 use crate::*;
 
+use crate::blitter::Blitter;
+use crate::clip::ClipKind;
+use crate::geom::{IntSize, ScreenIntRect};
+use crate::path::TransformedPath;
 use crate::pipeline::RasterPipelineBlitter;
 use crate::scalar::Scalar;
 use crate::scan;
+use crate::scan::tiler::{DrawTiler, TileBlitter};
 use crate::stroker::PathStroker;
 
 #[cfg(all(not(feature = "std"), feature = "libm"))]
 use crate::scalar::FloatExt;
 
-// 8K is 1 too big, since 8K << supersample == 32768 which is too big for Fixed.
-const MAX_DIM: u32 = 8192 - 1;
-
 
 /// A path filling rule.
 #[derive(Copy, Clone, PartialEq, Debug)]
@@ -35,7 +37,7 @@ impl Default for FillRule {
 
 
 /// Controls how a shape should be painted.
-#[derive(Clone, Debug)]
+#[derive(Clone, PartialEq, Debug)]
 pub struct Paint<'a> {
     /// A paint shader.
     ///
@@ -52,6 +54,21 @@ pub struct Paint<'a> {
     /// Default: false
     pub anti_alias: bool,
 
+    /// Uses analytic anti-aliasing for path filling.
+    ///
+    /// By default, anti-aliased paths are rendered using 4x vertical supersampling.
+    /// Analytic anti-aliasing computes an exact per-pixel area coverage instead,
+    /// which is usually faster, especially for small and complex paths, like glyphs.
+    ///
+    /// The result is slightly different from the supersampled one.
+    /// Also, coverage is only approximated in pixels shared by edges
+    /// of overlapping contours.
+    ///
+    /// Has no effect when `anti_alias` is not set.
+    ///
+    /// Default: false
+    pub analytic_aa: bool,
+
     /// Forces the high quality/precision rendering pipeline.
     ///
     /// `tiny-skia`, just like Skia, has two rendering pipelines:
@@ -77,6 +94,7 @@ impl Default for Paint<'_> {
             shader: Shader::SolidColor(Color::BLACK),
             blend_mode: BlendMode::default(),
             anti_alias: false,
+            analytic_aa: false,
             force_hq_pipeline: false,
         }
     }
@@ -116,6 +134,19 @@ impl Pixmap {
         self.as_mut().fill_rect(rect, paint, transform, clip_mask)
     }
 
+    /// Draws multiple filled rectangles onto the pixmap.
+    ///
+    /// See [`PixmapMut::fill_rects`](struct.PixmapMut.html#method.fill_rects) for details.
+    pub fn fill_rects(
+        &mut self,
+        rects: &[Rect],
+        paint: &Paint,
+        transform: Transform,
+        clip_mask: Option<&ClipMask>,
+    ) -> Option<()> {
+        self.as_mut().fill_rects(rects, paint, transform, clip_mask)
+    }
+
     /// Draws a filled path onto the pixmap.
     ///
     /// See [`PixmapMut::fill_path`](struct.PixmapMut.html#method.fill_path) for details.
@@ -130,6 +161,37 @@ impl Pixmap {
         self.as_mut().fill_path(path, paint, fill_rule, transform, clip_mask)
     }
 
+    /// Draws a filled path onto the pixmap using multiple threads.
+    ///
+    /// See [`PixmapMut::fill_path_parallel`](struct.PixmapMut.html#method.fill_path_parallel)
+    /// for details.
+    #[cfg(feature = "parallel")]
+    pub fn fill_path_parallel(
+        &mut self,
+        path: &Path,
+        paint: &Paint,
+        fill_rule: FillRule,
+        transform: Transform,
+        clip_mask: Option<&ClipMask>,
+    ) -> Option<()> {
+        self.as_mut().fill_path_parallel(path, paint, fill_rule, transform, clip_mask)
+    }
+
+    /// Draws a prepared path onto the pixmap.
+    ///
+    /// See [`PixmapMut::fill_prepared_path`](struct.PixmapMut.html#method.fill_prepared_path)
+    /// for details.
+    pub fn fill_prepared_path(
+        &mut self,
+        path: &PreparedPath,
+        x: i32,
+        y: i32,
+        paint: &Paint,
+        clip_mask: Option<&ClipMask>,
+    ) -> Option<()> {
+        self.as_mut().fill_prepared_path(path, x, y, paint, clip_mask)
+    }
+
     /// Strokes a path.
     ///
     /// See [`PixmapMut::stroke_path`](struct.PixmapMut.html#method.stroke_path) for details.
@@ -144,6 +206,44 @@ impl Pixmap {
         self.as_mut().stroke_path(path, paint, stroke, transform, clip_mask)
     }
 
+    /// Strokes a path, reusing temporary buffers from the `context`.
+    ///
+    /// See [`PixmapMut::stroke_path_with_context`](struct.PixmapMut.html#method.stroke_path_with_context)
+    /// for details.
+    pub fn stroke_path_with_context(
+        &mut self,
+        path: &Path,
+        paint: &Paint,
+        stroke: &Stroke,
+        transform: Transform,
+        clip_mask: Option<&ClipMask>,
+        context: &mut StrokeContext,
+    ) -> Option<()> {
+        self.as_mut().stroke_path_with_context(path, paint, stroke, transform, clip_mask, context)
+    }
+
+    /// Strokes multiple lines with a hairline.
+    ///
+    /// See [`PixmapMut::stroke_hairlines`](struct.PixmapMut.html#method.stroke_hairlines)
+    /// for details.
+    pub fn stroke_hairlines(
+        &mut self,
+        points: &[Point],
+        connected: bool,
+        paint: &Paint,
+        transform: Transform,
+        clip_mask: Option<&ClipMask>,
+    ) -> Option<()> {
+        self.as_mut().stroke_hairlines(points, connected, paint, transform, clip_mask)
+    }
+
+    /// Fills the pixmap through a coverage mask.
+    ///
+    /// See [`PixmapMut::fill_mask`](struct.PixmapMut.html#method.fill_mask) for details.
+    pub fn fill_mask(&mut self, mask: &Mask, x: i32, y: i32, paint: &Paint) -> Option<()> {
+        self.as_mut().fill_mask(mask, x, y, paint)
+    }
+
     /// Draws a `Pixmap` on top of the current `Pixmap`.
     ///
     /// See [`PixmapMut::draw_pixmap`](struct.PixmapMut.html#method.draw_pixmap) for details.
@@ -178,30 +278,85 @@ impl PixmapMut<'_> {
         clip_mask: Option<&ClipMask>,
     ) -> Option<()> {
         if transform.is_identity() {
-            // TODO: ignore rects outside the pixmap
-
-            // TODO: draw tiler
-            let bbox = rect.round_out();
-            if bbox.width() > MAX_DIM || bbox.height() > MAX_DIM {
+            let (clip, clip_mask) = clip_area(self.size(), clip_mask)?;
+            if !intersects_clip(&rect, 1.0, &clip) {
                 return None;
             }
 
-            let clip = self.size().to_screen_int_rect(0, 0);
-
-            let clip_mask = clip_mask.map(|mask| &mask.mask);
             let mut blitter = RasterPipelineBlitter::new(paint, clip_mask, self)?;
-
-            if paint.anti_alias {
-                scan::fill_rect_aa(&rect, &clip, &mut blitter)
-            } else {
-                scan::fill_rect(&rect, &clip, &mut blitter)
-            }
+            fill_rect_impl(&rect, paint.anti_alias, &clip, &mut blitter)
         } else {
             let path = PathBuilder::from_rect(rect);
             self.fill_path(&path, paint, FillRule::Winding, transform, clip_mask)
         }
     }
 
+    /// Draws multiple filled rectangles onto the pixmap.
+    ///
+    /// The raster pipeline is created only once for all rectangles,
+    /// which makes this method way faster than multiple `fill_rect` calls
+    /// in the case of many small rectangles. Rectangles outside the pixmap are skipped.
+    ///
+    /// Without a transform, the result is the same as calling [`fill_rect`](#method.fill_rect)
+    /// for each rectangle. A scale and translate transform is applied to rectangles directly,
+    /// so they are still rasterized as rectangles and not as paths.
+    /// Only transforms with a skew fall back to filling rectangle paths.
+    ///
+    /// Returns `None` when there is nothing to fill or in case of a numeric overflow.
+    pub fn fill_rects(
+        &mut self,
+        rects: &[Rect],
+        paint: &Paint,
+        transform: Transform,
+        clip_mask: Option<&ClipMask>,
+    ) -> Option<()> {
+        if rects.is_empty() {
+            return None;
+        }
+
+        let mut paint_storage = None;
+        let paint = transformed_paint(paint, transform, &mut paint_storage);
+
+        let (clip, clip_mask) = clip_area(self.size(), clip_mask)?;
+        let mut blitter = RasterPipelineBlitter::new(paint, clip_mask, self)?;
+
+        if transform.has_skew() {
+            for rect in rects {
+                let path = PathBuilder::from_rect(*rect);
+                let path = match TransformedPath::new(&path, transform) {
+                    Some(v) => v,
+                    None => continue,
+                };
+
+                if is_fillable_path(path) && intersects_clip(&path.bounds(), 1.0, &clip) {
+                    fill_path_impl(path, FillRule::Winding, paint, &clip, &mut blitter);
+                }
+            }
+        } else {
+            for rect in rects {
+                let rect = if transform.is_identity() {
+                    *rect
+                } else {
+                    let mut points = [
+                        Point::from_xy(rect.left(), rect.top()),
+                        Point::from_xy(rect.right(), rect.bottom()),
+                    ];
+                    transform.map_points(&mut points);
+                    match Rect::from_points(&points) {
+                        Some(v) => v,
+                        None => continue,
+                    }
+                };
+
+                if intersects_clip(&rect, 1.0, &clip) {
+                    fill_rect_impl(&rect, paint.anti_alias, &clip, &mut blitter);
+                }
+            }
+        }
+
+        Some(())
+    }
+
     /// Draws a filled path onto the pixmap.
     ///
     /// Returns `None` when there is nothing to fill or in case of a numeric overflow.
@@ -213,62 +368,173 @@ impl PixmapMut<'_> {
         transform: Transform,
         clip_mask: Option<&ClipMask>,
     ) -> Option<()> {
-        if transform.is_identity() {
-            // This is sort of similar to SkDraw::drawPath
+        // This is sort of similar to SkDraw::drawPath
 
-            // to_rect will fail when bounds' width/height is zero.
-            // This is an intended behaviour since the only
-            // reason for width/height to be zero is a horizontal/vertical line.
-            // And in both cases there is nothing to fill.
-            let path_bounds = path.bounds();
-            let path_int_bounds = path_bounds.round_out();
+        // Points are transformed during edge building, so the path is never copied.
+        let path = TransformedPath::new(path, transform)?;
+        if !is_fillable_path(path) {
+            return None;
+        }
 
-            // TODO: ignore paths outside the pixmap
+        let mut paint_storage = None;
+        let paint = transformed_paint(paint, transform, &mut paint_storage);
 
-            // TODO: draw tiler
-            if path_int_bounds.width() > MAX_DIM || path_int_bounds.height() > MAX_DIM {
-                return None;
-            }
+        let (clip_rect, clip_mask) = clip_area(self.size(), clip_mask)?;
+        if !intersects_clip(&path.bounds(), 1.0, &clip_rect) {
+            return None;
+        }
 
-            if path.is_too_big_for_math() {
-                return None;
-            }
+        let mut blitter = RasterPipelineBlitter::new(paint, clip_mask, self)?;
+        fill_path_impl(path, fill_rule, paint, &clip_rect, &mut blitter)
+    }
 
-            let clip_rect = self.size().to_screen_int_rect(0, 0);
+    /// Draws a filled path onto the pixmap using multiple threads.
+    ///
+    /// The pixmap is split into horizontal bands, which are filled in parallel,
+    /// while path edges are built only once. Edges are advanced to each band start
+    /// on the current thread, which runs concurrently with filling of the previous bands.
+    /// The result is identical to [`fill_path`](#method.fill_path).
+    ///
+    /// Useful mainly for large and complex paths. For small ones,
+    /// the threading overhead will outweigh the speed up.
+    ///
+    /// Pixmaps larger than 8191 pixels in any direction are filled on the current thread,
+    /// unless `Paint::analytic_aa` is used.
+    ///
+    /// Returns `None` when there is nothing to fill or in case of a numeric overflow.
+    #[cfg(feature = "parallel")]
+    pub fn fill_path_parallel(
+        &mut self,
+        path: &Path,
+        paint: &Paint,
+        fill_rule: FillRule,
+        transform: Transform,
+        clip_mask: Option<&ClipMask>,
+    ) -> Option<()> {
+        // Bands share edges, which cannot be built for large pixmaps.
+        let pixmap_rect = self.size().to_screen_int_rect(0, 0);
+        if DrawTiler::required(&pixmap_rect) && !(paint.anti_alias && paint.analytic_aa) {
+            return self.fill_path(path, paint, fill_rule, transform, clip_mask);
+        }
 
-            let clip_mask = clip_mask.map(|mask| &mask.mask);
-            let mut blitter = RasterPipelineBlitter::new(paint, clip_mask, self)?;
+        let path = TransformedPath::new(path, transform)?;
+        if !is_fillable_path(path) {
+            return None;
+        }
 
-            if paint.anti_alias {
-                scan::path_aa::fill_path(path, fill_rule, &clip_rect, &mut blitter)
-            } else {
-                scan::path::fill_path(path, fill_rule, &clip_rect, &mut blitter)
+        let mut paint_storage = None;
+        let paint = transformed_paint(paint, transform, &mut paint_storage);
+
+        let (clip_rect, clip_mask) = clip_area(self.size(), clip_mask)?;
+        if !intersects_clip(&path.bounds(), 1.0, &clip_rect) {
+            return None;
+        }
+
+        let path_bands = scan::band::BandedPath::new(path, fill_rule, paint, &clip_rect)?;
+
+        // Bands are blitted onto separate pixmaps, so the changed area is marked in advance.
+        let dirty = scan::tiler::outset_bounds(&path.bounds())
+            .and_then(|r| r.intersect(&clip_rect.to_int_rect()))
+            .and_then(|r| r.to_screen_int_rect());
+        if let Some(rect) = dirty {
+            self.mark_dirty(&rect);
+        }
+
+        let width = self.width();
+        let height = self.height();
+        let band_height = scan::band::band_height(height);
+        let row_bytes = self.row_bytes();
+        let format = self.format();
+        let band_len = band_height as usize * row_bytes;
+        // The last row may be not padded.
+        let data_len = (height as usize - 1) * row_bytes + width as usize * BYTES_PER_PIXEL;
+
+        let filler = BandFiller {
+            paint,
+            clip_rect: &clip_rect,
+            clip_mask,
+            width,
+            row_bytes,
+            format,
+        };
+
+        use core::sync::atomic::{AtomicBool, Ordering};
+
+        let filler = &filler;
+        let filled = &AtomicBool::new(false);
+        rayon::scope(|s| {
+            // Parts are taken in order, since edges are advanced between them,
+            // and each band is filled as soon as its part is ready.
+            let parts = path_bands.bands(0, height, band_height);
+            let bands = self.data_mut()[..data_len].chunks_mut(band_len);
+            for (i, (part, data)) in parts.zip(bands).enumerate() {
+                let top = i as u32 * band_height;
+                s.spawn(move |_| {
+                    if filler.fill(part, top, data).is_some() {
+                        filled.store(true, Ordering::Relaxed);
+                    }
+                });
             }
+        });
+
+        // Bands outside of the clip area are skipped, so only a failure of all of them
+        // is reported.
+        if filled.load(Ordering::Relaxed) {
+            Some(())
         } else {
-            let path = path.clone().transform(transform)?;
+            None
+        }
+    }
 
-            let mut paint = paint.clone();
-            paint.shader.transform(transform);
+    /// Draws a prepared path onto the pixmap, translated by `x` and `y`.
+    ///
+    /// The result is the same as filling the original path with the prepared transform
+    /// post-translated by `x` and `y`, but the path coverage is not computed again.
+    /// The shader is transformed the same way. When the path is only partially visible,
+    /// pixels near clipped edges can differ slightly, since the coverage was computed
+    /// for the whole path.
+    ///
+    /// `Paint::anti_alias` and `Paint::analytic_aa` are ignored, since the coverage
+    /// was already computed by [`PreparedPath::new`](struct.PreparedPath.html#method.new).
+    ///
+    /// Returns `None` when there is nothing to fill or in case of a numeric overflow.
+    pub fn fill_prepared_path(
+        &mut self,
+        path: &PreparedPath,
+        x: i32,
+        y: i32,
+        paint: &Paint,
+        clip_mask: Option<&ClipMask>,
+    ) -> Option<()> {
+        let (clip_rect, clip_mask) = clip_area(self.size(), clip_mask)?;
+        path.bounds_at(x, y)?.intersect(&clip_rect.to_int_rect())?;
 
-            self.fill_path(&path, &paint, fill_rule, Transform::identity(), clip_mask)
-        }
+        let transform = path.transform().post_translate(x as f32, y as f32);
+        let mut paint_storage = None;
+        let paint = transformed_paint(paint, transform, &mut paint_storage);
+
+        let mut blitter = RasterPipelineBlitter::new(paint, clip_mask, self)?;
+        path.fill(x, y, &clip_rect, &mut blitter);
+        Some(())
     }
 
-    // TODO: add dash
     /// Strokes a path.
     ///
     /// Stroking is implemented using two separate algorithms:
     ///
     /// 1. If a stroke width is wider than 1px (after applying the transformation),
-    ///    a path will be converted into a stroked path and then filled using `Canvas::fill_path`.
+    ///    a path will be converted into a stroked path and then filled using `fill_path`.
     ///    Which means that we have to allocate a separate `Path`, that can be 2-3x larger
     ///    then the original path.
-    ///    `Canvas` will reuse this allocation during subsequent strokes.
     /// 2. If a stroke width is thinner than 1px (after applying the transformation),
     ///    we will use hairline stroking, which doesn't involve a separate path allocation.
     ///
-    /// Also, if a `stroke` has a dash array, then path will be converted into
-    /// a dashed path first and then stroked. Which means a yet another allocation.
+    /// Also, if a `stroke` has a dash array, then each dash is stroked as soon as it's produced,
+    /// without building a whole dashed path. Only hairlines are dashed into a separate path,
+    /// which means a yet another allocation.
+    ///
+    /// Use [`stroke_path_with_context`](#method.stroke_path_with_context)
+    /// to reuse those allocations between strokes.
     pub fn stroke_path(
         &mut self,
         path: &Path,
@@ -276,6 +542,24 @@ impl PixmapMut<'_> {
         stroke: &Stroke,
         transform: Transform,
         clip_mask: Option<&ClipMask>,
+    ) -> Option<()> {
+        let mut context = StrokeContext::new();
+        self.stroke_path_with_context(path, paint, stroke, transform, clip_mask, &mut context)
+    }
+
+    /// Strokes a path, reusing temporary buffers from the `context`.
+    ///
+    /// The result is identical to [`stroke_path`](#method.stroke_path).
+    /// Dashed and stroked paths are built in the `context` buffers,
+    /// so they are allocated only when a path is larger than any previous one.
+    pub fn stroke_path_with_context(
+        &mut self,
+        path: &Path,
+        paint: &Paint,
+        stroke: &Stroke,
+        transform: Transform,
+        clip_mask: Option<&ClipMask>,
+        context: &mut StrokeContext,
     ) -> Option<()> {
         if stroke.width < 0.0 {
             return None;
@@ -283,39 +567,169 @@ impl PixmapMut<'_> {
 
         let res_scale = PathStroker::compute_resolution_scale(&transform);
 
-        let dash_path;
-        let path = if let Some(ref dash) = stroke.dash {
-            dash_path = crate::dash::dash(path, dash, res_scale)?;
-            &dash_path
-        } else {
-            path
+        if let Some(ref dash) = stroke.dash {
+            if hairline_paint(paint, stroke, transform).is_none() {
+                // Dashes are stroked as soon as they are produced,
+                // so the dashed path is never built.
+                let buf = core::mem::replace(&mut context.path, PathBuilder::new());
+                let path = context.stroker.stroke_dashed_into(
+                    path, stroke, dash, res_scale, &mut context.contour, &mut context.dashed, buf,
+                )?;
+                return self.fill_stroked_path(path, paint, transform, clip_mask, context);
+            }
+        }
+
+        let dash_path = match stroke.dash {
+            Some(ref dash) => {
+                let buf = core::mem::replace(&mut context.dashed, PathBuilder::new());
+                let path = crate::dash::dash_into(path, dash, res_scale, &mut context.contour, buf)?;
+                Some(path)
+            }
+            None => None,
         };
 
-        if let Some(coverage) = treat_as_hairline(&paint, stroke, transform) {
+        let result = self.stroke_path_impl(
+            dash_path.as_ref().unwrap_or(path), paint, stroke, transform, res_scale, clip_mask,
+            context,
+        );
+
+        if let Some(path) = dash_path {
+            context.dashed = path.clear();
+        }
+
+        result
+    }
+
+    fn stroke_path_impl(
+        &mut self,
+        path: &Path,
+        paint: &Paint,
+        stroke: &Stroke,
+        transform: Transform,
+        res_scale: f32,
+        clip_mask: Option<&ClipMask>,
+        context: &mut StrokeContext,
+    ) -> Option<()> {
+        if let Some(mut paint) = hairline_paint(paint, stroke, transform) {
+            if !transform.is_identity() {
+                paint.shader.transform(transform);
+            }
+
+            let path = TransformedPath::new(path, transform)?;
+            self.stroke_hairline(path, &paint, stroke.line_cap, clip_mask)
+        } else {
+            let buf = core::mem::replace(&mut context.path, PathBuilder::new());
+            let path = context.stroker.stroke_into(path, stroke, res_scale, buf)?;
+            self.fill_stroked_path(path, paint, transform, clip_mask, context)
+        }
+    }
+
+    /// Fills a stroked path and returns its buffer to the `context`.
+    fn fill_stroked_path(
+        &mut self,
+        path: Path,
+        paint: &Paint,
+        transform: Transform,
+        clip_mask: Option<&ClipMask>,
+        context: &mut StrokeContext,
+    ) -> Option<()> {
+        let (path, result) = if transform.is_identity() {
+            let result = self.fill_path(&path, paint, FillRule::Winding, transform, clip_mask);
+            (path, result)
+        } else {
+            // The stroked path is ours, so it can be transformed in-place.
+            let path = path.transform(transform)?;
+
             let mut paint = paint.clone();
-            if coverage == 1.0 {
-                // No changes to the `paint`.
-            } else if paint.blend_mode.should_pre_scale_coverage() {
-                // This is the old technique, which we preserve for now so
-                // we don't change previous results (testing)
-                // the new way seems fine, its just (a tiny bit) different.
-                let scale = (coverage * 256.0) as i32;
-                let new_alpha = (255 * scale) >> 8;
-                paint.shader.apply_opacity(new_alpha as f32 / 255.0);
+            paint.shader.transform(transform);
+
+            let result = self.fill_path(
+                &path, &paint, FillRule::Winding, Transform::identity(), clip_mask,
+            );
+            (path, result)
+        };
+
+        context.path = path.clear();
+        result
+    }
+
+    /// Strokes multiple lines with a hairline.
+    ///
+    /// Unlike [`stroke_path`](#method.stroke_path), doesn't require a `Path`
+    /// and creates the raster pipeline only once for all lines,
+    /// which is way faster for a large amount of short lines, like in charts.
+    ///
+    /// When `connected` is set, `points` are a polyline and each point is connected
+    /// to the next one. Otherwise, each pair of points is a separate line
+    /// and the last point of an odd amount is ignored.
+    ///
+    /// Lines are drawn in order, the same way as stroking a path made of them
+    /// with a zero width and butt caps. They are not sorted by scanline and their
+    /// spans are not merged, since overlapping translucent lines must blend
+    /// the same way as with a path. Instead, a single blitter is shared by all lines
+    /// and points are transformed in place.
+    ///
+    /// Returns `None` when there is nothing to stroke or in case of a numeric overflow.
+    pub fn stroke_hairlines(
+        &mut self,
+        points: &[Point],
+        connected: bool,
+        paint: &Paint,
+        transform: Transform,
+        clip_mask: Option<&ClipMask>,
+    ) -> Option<()> {
+        // Points are transformed in small chunks, so they are never copied to the heap.
+        const CHUNK_LEN: usize = 64;
+
+        if points.len() < 2 {
+            return None;
+        }
+
+        let mut paint_storage = None;
+        let paint = transformed_paint(paint, transform, &mut paint_storage);
+
+        let (clip, clip_mask) = clip_area(self.size(), clip_mask)?;
+
+        // Non-finite points are left to the line clipper.
+        if let Some(bounds) = hairlines_bounds(points, transform) {
+            // Anti-aliasing can spill slightly outside the lines bounds.
+            if !intersects_clip(&bounds, 2.0, &clip) {
+                return None;
             }
+        }
+
+        let mut blitter = RasterPipelineBlitter::new(paint, clip_mask, self)?;
 
+        let stroke_polyline = if paint.anti_alias {
+            scan::hairline_aa::stroke_polyline
+        } else {
+            scan::hairline::stroke_polyline
+        };
+
+        // Polyline chunks share their boundary points.
+        let step = if connected { CHUNK_LEN - 1 } else { CHUNK_LEN };
+        let mut buf = [Point::zero(); CHUNK_LEN];
+        let mut start = 0;
+        while start + 1 < points.len() {
+            let end = points.len().min(start + CHUNK_LEN);
+            let chunk = &mut buf[..end - start];
+            chunk.copy_from_slice(&points[start..end]);
             if !transform.is_identity() {
-                paint.shader.transform(transform);
+                transform.map_points(chunk);
+            }
 
-                let path = path.clone().transform(transform)?;
-                self.stroke_hairline(&path, &paint, stroke.line_cap, clip_mask)
+            if connected {
+                stroke_polyline(chunk, &clip, &mut blitter);
             } else {
-                self.stroke_hairline(&path, &paint, stroke.line_cap, clip_mask)
+                for line in chunk.chunks_exact(2) {
+                    stroke_polyline(line, &clip, &mut blitter);
+                }
             }
-        } else {
-            let path = PathStroker::new().stroke(path, stroke, res_scale)?;
-            self.fill_path(&path, paint, FillRule::Winding, transform, clip_mask)
+
+            start += step;
         }
+
+        Some(())
     }
 
     /// A path stroking with subpixel width.
@@ -328,21 +742,39 @@ impl PixmapMut<'_> {
     /// [`Canvas::stroke_path`]: struct.Canvas.html#method.stroke_path
     pub(crate) fn stroke_hairline(
         &mut self,
-        path: &Path,
+        path: TransformedPath,
         paint: &Paint,
         line_cap: LineCap,
         clip_mask: Option<&ClipMask>,
     ) -> Option<()> {
-        let clip = self.size().to_screen_int_rect(0, 0);
+        let (clip, clip_mask) = clip_area(self.size(), clip_mask)?;
+        // Caps and anti-aliasing can spill slightly outside the path bounds.
+        if !intersects_clip(&path.bounds(), 2.0, &clip) {
+            return None;
+        }
 
-        let clip_mask = clip_mask.map(|mask| &mask.mask);
         let mut blitter = RasterPipelineBlitter::new(paint, clip_mask, self)?;
+        stroke_hairline_impl(path, line_cap, paint.anti_alias, &clip, &mut blitter)
+    }
 
-        if paint.anti_alias {
-            scan::hairline_aa::stroke_path(path, line_cap, &clip, &mut blitter)
-        } else {
-            scan::hairline::stroke_path(path, line_cap, &clip, &mut blitter)
-        }
+    /// Fills the pixmap through a coverage mask placed at `x` and `y`.
+    ///
+    /// Only the area covered by the mask is affected, and the paint coverage is multiplied
+    /// by the mask one, the same way as with a `ClipMask`. Which means that a `Pixmap`
+    /// can be drawn through a mask using a `Pattern` shader.
+    ///
+    /// The shader is not transformed.
+    ///
+    /// Returns `None` when there is nothing to fill.
+    pub fn fill_mask(&mut self, mask: &Mask, x: i32, y: i32, paint: &Paint) -> Option<()> {
+        let rect = IntRect::from_xywh(x, y, mask.width(), mask.height())?
+            .intersect(&self.size().to_int_rect(0, 0))?
+            .to_screen_int_rect()?;
+
+        let clip_mask = mask.clip_mask_ctx(x, y);
+        let mut blitter = RasterPipelineBlitter::new_band(paint, Some(clip_mask), 0, self)?;
+        blitter.blit_rect(&rect);
+        Some(())
     }
 
     /// Draws a `Pixmap` on top of the current `Pixmap`.
@@ -359,9 +791,8 @@ impl PixmapMut<'_> {
     ) -> Option<()> {
         let rect = pixmap.size().to_int_rect(x, y).to_rect();
 
-        // TODO: SkSpriteBlitter
-        // TODO: partially clipped
-        // TODO: clipped out
+        // An untransformed pixmap with an identity transform is copied directly
+        // by the blitter, while `fill_rect` takes care of clipping.
 
         // Translate pattern as well as bounds.
         let patt_transform = Transform::from_translate(x as f32, y as f32);
@@ -376,13 +807,265 @@ impl PixmapMut<'_> {
             ),
             blend_mode: paint.blend_mode,
             anti_alias: false, // Skia doesn't use it too.
-            force_hq_pipeline: false, // Pattern will use hq anyway.
+            analytic_aa: false,
+            force_hq_pipeline: false, // Bicubic filtering will use hq anyway.
         };
 
         self.fill_rect(rect, &paint, transform, clip_mask)
     }
 }
 
+/// Returns the destination area that is visible through a clip mask,
+/// and the coverage mask that still has to be applied inside of it.
+///
+/// Rectangular masks are fully represented by the area.
+///
+/// Returns `None` when everything is clipped out.
+pub(crate) fn clip_area(
+    size: IntSize,
+    clip_mask: Option<&ClipMask>,
+) -> Option<(ScreenIntRect, Option<&crate::clip::ClipMaskData>)> {
+    let pixmap_rect = size.to_screen_int_rect(0, 0);
+    let mask = match clip_mask {
+        Some(mask) => &mask.mask,
+        None => return Some((pixmap_rect, None)),
+    };
+
+    // Make sure that `clip_mask` has the same size as `pixmap`.
+    if mask.width.get() != size.width() || mask.height.get() != size.height() {
+        return None;
+    }
+
+    match mask.kind {
+        ClipKind::Empty | ClipKind::ClipAll => None,
+        ClipKind::Rect(rect) => Some((rect, None)),
+        ClipKind::Mask(rect) => Some((rect, Some(mask))),
+    }
+}
+
+/// Checks that an already transformed path can be filled.
+pub(crate) fn is_fillable_path(path: TransformedPath) -> bool {
+    !path.is_too_big_for_math()
+}
+
+/// Returns bounds of transformed points by transforming only the corners of their bounds.
+fn hairlines_bounds(points: &[Point], ts: Transform) -> Option<Rect> {
+    let bounds = Rect::from_points(points)?;
+    if ts.is_identity() {
+        return Some(bounds);
+    }
+
+    let mut corners = [
+        Point::from_xy(bounds.left(), bounds.top()),
+        Point::from_xy(bounds.right(), bounds.top()),
+        Point::from_xy(bounds.right(), bounds.bottom()),
+        Point::from_xy(bounds.left(), bounds.bottom()),
+    ];
+    ts.map_points(&mut corners);
+    Rect::from_points(&corners)
+}
+
+/// Checks that geometry with the specified bounds can affect pixels inside the clip.
+///
+/// `outset` accounts for anti-aliasing and caps spilling outside the bounds.
+///
+/// This check is way cheaper than a blitter creation, so it should be done first.
+pub(crate) fn intersects_clip(bounds: &Rect, outset: f32, clip: &ScreenIntRect) -> bool {
+    let clip = clip.to_rect();
+    bounds.left() - outset < clip.right()
+        && bounds.top() - outset < clip.bottom()
+        && bounds.right() + outset > clip.left()
+        && bounds.bottom() + outset > clip.top()
+}
+
+/// Fills bands of a pixmap, which are stored in separate slices.
+#[cfg(feature = "parallel")]
+struct BandFiller<'a> {
+    paint: &'a Paint<'a>,
+    clip_rect: &'a ScreenIntRect,
+    clip_mask: Option<&'a crate::clip::ClipMaskData>,
+    width: u32,
+    row_bytes: usize,
+    format: PixelFormat,
+}
+
+#[cfg(feature = "parallel")]
+impl BandFiller<'_> {
+    /// Fills a `part` of the path onto the band that starts at the `top` row.
+    fn fill(&self, part: scan::band::PathBand, top: u32, data: &mut [u8]) -> Option<()> {
+        let height = ((data.len() + self.row_bytes - 1) / self.row_bytes) as u32;
+        // Pixels outside of the clip area are never touched.
+        let band = ScreenIntRect::from_xywh(0, top, self.width, height)?
+            .to_int_rect()
+            .intersect(&self.clip_rect.to_int_rect())?
+            .to_screen_int_rect()?;
+        let mut pixmap = PixmapMut::from_bytes_with_stride(data, self.width, height, self.row_bytes)?
+            .with_format(self.format);
+        let clip_mask = self.clip_mask.map(|mask| mask.clip_mask_ctx_from_row(top));
+        let mut blitter = RasterPipelineBlitter::new_band(self.paint, clip_mask, top, &mut pixmap)?;
+        part.fill(&band, top, &mut blitter)
+    }
+}
+
+/// Fills an already transformed path.
+///
+/// Large destinations are filled tile by tile.
+///
+/// `is_fillable_path` must be checked beforehand.
+pub(crate) fn fill_path_impl(
+    path: TransformedPath,
+    fill_rule: FillRule,
+    paint: &Paint,
+    clip: &ScreenIntRect,
+    blitter: &mut dyn Blitter,
+) -> Option<()> {
+    // Analytic anti-aliasing doesn't use fixed-point coordinates and doesn't need tiling.
+    if paint.anti_alias && paint.analytic_aa {
+        return scan::path_aaa::fill_path(path, fill_rule, clip, blitter);
+    }
+
+    if !DrawTiler::required(clip) {
+        return fill_path_tile(path, fill_rule, paint.anti_alias, clip, blitter);
+    }
+
+    let bounds = scan::tiler::outset_bounds(&path.bounds())?;
+    // Tiles are placed row by row, so the path is culled once per row.
+    let mut row_path = None;
+    let mut row_y = None;
+    for tile in DrawTiler::new(&bounds, clip)? {
+        if row_y != Some(tile.y()) {
+            row_y = Some(tile.y());
+            // Anti-aliasing can spill slightly outside the rows.
+            let top = tile.y() as f32 - 1.0;
+            let bottom = tile.bottom() as f32 + 1.0;
+            row_path = scan::tiler::cull_rows(path, top, bottom);
+        }
+
+        let row_path = match row_path {
+            Some(ref v) => TransformedPath::from(v),
+            None => continue,
+        };
+
+        let path = match row_path.translate(-(tile.x() as f32), -(tile.y() as f32)) {
+            Some(v) => v,
+            None => continue,
+        };
+
+        let mut blitter = TileBlitter::new(&tile, blitter);
+        let clip = scan::tiler::local_clip(&tile);
+        fill_path_tile(path, fill_rule, paint.anti_alias, &clip, &mut blitter);
+    }
+
+    Some(())
+}
+
+fn fill_path_tile(
+    path: TransformedPath,
+    fill_rule: FillRule,
+    anti_alias: bool,
+    clip: &ScreenIntRect,
+    blitter: &mut dyn Blitter,
+) -> Option<()> {
+    if anti_alias {
+        scan::path_aa::fill_path(path, fill_rule, clip, blitter)
+    } else {
+        scan::path::fill_path(path, fill_rule, clip, blitter)
+    }
+}
+
+/// Fills a rectangle without a transform.
+///
+/// Large destinations are filled tile by tile.
+pub(crate) fn fill_rect_impl(
+    rect: &Rect,
+    anti_alias: bool,
+    clip: &ScreenIntRect,
+    blitter: &mut dyn Blitter,
+) -> Option<()> {
+    if !anti_alias {
+        // Integer rectangles do not have any size limits.
+        return scan::fill_rect(rect, clip, blitter);
+    }
+
+    if !DrawTiler::required(clip) {
+        return scan::fill_rect_aa(rect, clip, blitter);
+    }
+
+    let bounds = scan::tiler::outset_bounds(rect)?;
+    for tile in DrawTiler::new(&bounds, clip)? {
+        let rect = match Rect::from_xywh(
+            rect.x() - tile.x() as f32,
+            rect.y() - tile.y() as f32,
+            rect.width(),
+            rect.height(),
+        ) {
+            Some(v) => v,
+            None => continue,
+        };
+
+        let mut blitter = TileBlitter::new(&tile, blitter);
+        scan::fill_rect_aa(&rect, &scan::tiler::local_clip(&tile), &mut blitter);
+    }
+
+    Some(())
+}
+
+/// Strokes an already transformed path with a hairline.
+pub(crate) fn stroke_hairline_impl(
+    path: TransformedPath,
+    line_cap: LineCap,
+    anti_alias: bool,
+    clip: &ScreenIntRect,
+    blitter: &mut dyn Blitter,
+) -> Option<()> {
+    if anti_alias {
+        scan::hairline_aa::stroke_path(path, line_cap, clip, blitter)
+    } else {
+        scan::hairline::stroke_path(path, line_cap, clip, blitter)
+    }
+}
+
+/// Returns a paint with a shader transformed by `ts`.
+///
+/// The paint is cloned into an empty `storage` only when `ts` is not an identity.
+fn transformed_paint<'b, 'a>(
+    paint: &'b Paint<'a>,
+    ts: Transform,
+    storage: &'b mut Option<Paint<'a>>,
+) -> &'b Paint<'a> {
+    if ts.is_identity() {
+        return paint;
+    }
+
+    let mut paint = paint.clone();
+    paint.shader.transform(ts);
+    storage.get_or_insert(paint)
+}
+
+/// Returns a paint that should be used for hairline stroking.
+///
+/// Returns `None` when a stroke is too wide to be treated as a hairline.
+pub(crate) fn hairline_paint<'a>(
+    paint: &Paint<'a>,
+    stroke: &Stroke,
+    transform: Transform,
+) -> Option<Paint<'a>> {
+    let coverage = treat_as_hairline(paint, stroke, transform)?;
+    let mut paint = paint.clone();
+    if coverage == 1.0 {
+        // No changes to the `paint`.
+    } else if paint.blend_mode.should_pre_scale_coverage() {
+        // This is the old technique, which we preserve for now so
+        // we don't change previous results (testing)
+        // the new way seems fine, its just (a tiny bit) different.
+        let scale = (coverage * 256.0) as i32;
+        let new_alpha = (255 * scale) >> 8;
+        paint.shader.apply_opacity(new_alpha as f32 / 255.0);
+    }
+
+    Some(paint)
+}
+
 fn treat_as_hairline(paint: &Paint, stroke: &Stroke, mut ts: Transform) -> Option<f32> {
     fn fast_len(p: Point) -> f32 {
         let mut x = p.x.abs();
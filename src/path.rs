@@ -79,28 +79,11 @@ impl Path {
         Some(self)
     }
 
-    /// Sometimes in the drawing pipeline, we have to perform math on path coordinates, even after
-    /// the path is in device-coordinates. Tessellation and clipping are two examples. Usually this
-    /// is pretty modest, but it can involve subtracting/adding coordinates, or multiplying by
-    /// small constants (e.g. 2,3,4). To try to preflight issues where these optionations could turn
-    /// finite path values into infinities (or NaNs), we allow the upper drawing code to reject
-    /// the path if its bounds (in device coordinates) is too close to max float.
-    pub(crate) fn is_too_big_for_math(&self) -> bool {
-        // This value is just a guess. smaller is safer, but we don't want to reject largish paths
-        // that we don't have to.
-        const SCALE_DOWN_TO_ALLOW_FOR_SMALL_MULTIPLIES: f32 = 0.25;
-        const MAX: f32 = SCALAR_MAX * SCALE_DOWN_TO_ALLOW_FOR_SMALL_MULTIPLIES;
-
-        let b = self.bounds;
-
-        // use ! expression so we return true if bounds contains NaN
-        !(b.left() >= -MAX && b.top() >= -MAX && b.right() <= MAX && b.bottom() <= MAX)
-    }
-
     /// Returns an iterator over path's segments.
     pub fn segments(&self) -> PathSegmentsIter {
         PathSegmentsIter {
             path: self,
+            map: None,
             verb_index: 0,
             points_index: 0,
             is_auto_close: false,
@@ -112,6 +95,7 @@ impl Path {
     pub(crate) fn edge_iter(&self) -> PathEdgeIter {
         PathEdgeIter {
             path: self,
+            map: None,
             verb_index: 0,
             points_index: 0,
             move_to: Point::zero(),
@@ -163,6 +147,157 @@ impl core::fmt::Debug for Path {
 }
 
 
+/// A path with a transform, which is applied to points on the fly.
+///
+/// Allows rasterizing a transformed path without copying it.
+/// Points are mapped exactly like `Path::transform` does it.
+#[derive(Copy, Clone, Debug)]
+pub(crate) struct TransformedPath<'a> {
+    path: &'a Path,
+    map: Option<PointMap>,
+    bounds: Rect,
+}
+
+impl<'a> TransformedPath<'a> {
+    /// Creates a new transformed path.
+    ///
+    /// Returns `None` when some of the transformed points are not finite.
+    pub fn new(path: &'a Path, ts: Transform) -> Option<Self> {
+        if ts.is_identity() {
+            return Some(path.into());
+        }
+
+        let map = PointMap { ts, offset: None };
+        Some(TransformedPath {
+            path,
+            map: Some(map),
+            bounds: map.bounds(&path.points)?,
+        })
+    }
+
+    /// Returns the same path, moved by an additional offset.
+    ///
+    /// Unlike a concatenated transform, the offset is applied to already transformed points.
+    pub fn translate(&self, dx: f32, dy: f32) -> Option<Self> {
+        if Transform::from_translate(dx, dy).is_identity() {
+            return Some(*self);
+        }
+
+        let ts = self.map.map(|m| m.ts).unwrap_or_default();
+        debug_assert!(self.map.and_then(|m| m.offset).is_none());
+        let map = PointMap { ts, offset: Some(Point::from_xy(dx, dy)) };
+        // The offset is added after the transform and rounding is monotonic,
+        // so the bounds of the moved points are the moved bounds.
+        let bounds = Rect::from_ltrb(
+            self.bounds.left() + dx,
+            self.bounds.top() + dy,
+            self.bounds.right() + dx,
+            self.bounds.bottom() + dy,
+        )?;
+        Some(TransformedPath {
+            path: self.path,
+            map: Some(map),
+            bounds,
+        })
+    }
+
+    /// Returns the bounds of the transformed points.
+    pub fn bounds(&self) -> Rect {
+        self.bounds
+    }
+
+    /// Sometimes in the drawing pipeline, we have to perform math on path coordinates, even after
+    /// the path is in device-coordinates. Tessellation and clipping are two examples. Usually this
+    /// is pretty modest, but it can involve subtracting/adding coordinates, or multiplying by
+    /// small constants (e.g. 2,3,4). To try to preflight issues where these optionations could turn
+    /// finite path values into infinities (or NaNs), we allow the upper drawing code to reject
+    /// the path if its bounds (in device coordinates) is too close to max float.
+    pub fn is_too_big_for_math(&self) -> bool {
+        // This value is just a guess. smaller is safer, but we don't want to reject largish paths
+        // that we don't have to.
+        const SCALE_DOWN_TO_ALLOW_FOR_SMALL_MULTIPLIES: f32 = 0.25;
+        const MAX: f32 = SCALAR_MAX * SCALE_DOWN_TO_ALLOW_FOR_SMALL_MULTIPLIES;
+
+        let b = self.bounds;
+
+        // use ! expression so we return true if bounds contains NaN
+        !(b.left() >= -MAX && b.top() >= -MAX && b.right() <= MAX && b.bottom() <= MAX)
+    }
+
+    /// Returns an iterator over transformed segments.
+    pub fn segments(&self) -> PathSegmentsIter<'a> {
+        let mut iter = self.path.segments();
+        iter.map = self.map;
+        iter
+    }
+
+    /// Returns an iterator over transformed edges.
+    pub fn edge_iter(&self) -> PathEdgeIter<'a> {
+        let mut iter = self.path.edge_iter();
+        iter.map = self.map;
+        iter
+    }
+}
+
+impl<'a> From<&'a Path> for TransformedPath<'a> {
+    fn from(path: &'a Path) -> Self {
+        TransformedPath {
+            path,
+            map: None,
+            bounds: path.bounds,
+        }
+    }
+}
+
+
+/// A transform that is applied to every point separately.
+#[derive(Copy, Clone, Debug)]
+struct PointMap {
+    ts: Transform,
+    /// A translation that is applied after `ts`.
+    offset: Option<Point>,
+}
+
+impl PointMap {
+    #[inline]
+    fn map(&self, p: Point) -> Point {
+        let mut points = [p];
+        self.ts.map_points(&mut points);
+        if let Some(offset) = self.offset {
+            points[0].x += offset.x;
+            points[0].y += offset.y;
+        }
+
+        points[0]
+    }
+
+    /// Computes the bounds of the mapped points without storing them.
+    fn bounds(&self, points: &[Point]) -> Option<Rect> {
+        let mut buf = [Point::zero(); 64];
+        let mut bounds: Option<Rect> = None;
+        for chunk in points.chunks(buf.len()) {
+            let buf = &mut buf[..chunk.len()];
+            for (dst, src) in buf.iter_mut().zip(chunk) {
+                *dst = self.map(*src);
+            }
+
+            let rect = Rect::from_points(buf)?;
+            bounds = Some(match bounds {
+                Some(b) => Rect::from_ltrb(
+                    b.left().min(rect.left()),
+                    b.top().min(rect.top()),
+                    b.right().max(rect.right()),
+                    b.bottom().max(rect.bottom()),
+                )?,
+                None => rect,
+            });
+        }
+
+        bounds
+    }
+}
+
+
 /// A path segment.
 #[allow(missing_docs)]
 #[derive(Copy, Clone, PartialEq, Debug)]
@@ -180,6 +315,7 @@ pub enum PathSegment {
 #[derive(Clone)]
 pub struct PathSegmentsIter<'a> {
     path: &'a Path,
+    map: Option<PointMap>,
     verb_index: usize,
     points_index: usize,
 
@@ -250,6 +386,15 @@ impl<'a> PathSegmentsIter<'a> {
     pub(crate) fn next_verb(&self) -> Option<PathVerb> {
         self.path.verbs.get(self.verb_index).cloned()
     }
+
+    #[inline]
+    fn point(&self, index: usize) -> Point {
+        let p = self.path.points[index];
+        match self.map {
+            Some(ref map) => map.map(p),
+            None => p,
+        }
+    }
 }
 
 impl<'a> Iterator for PathSegmentsIter<'a> {
@@ -263,29 +408,29 @@ impl<'a> Iterator for PathSegmentsIter<'a> {
             match verb {
                 PathVerb::Move => {
                     self.points_index += 1;
-                    self.last_move_to = self.path.points[self.points_index - 1];
+                    self.last_move_to = self.point(self.points_index - 1);
                     self.last_point = self.last_move_to;
                     Some(PathSegment::MoveTo(self.last_move_to))
                 }
                 PathVerb::Line => {
                     self.points_index += 1;
-                    self.last_point = self.path.points[self.points_index - 1];
+                    self.last_point = self.point(self.points_index - 1);
                     Some(PathSegment::LineTo(self.last_point))
                 }
                 PathVerb::Quad => {
                     self.points_index += 2;
-                    self.last_point = self.path.points[self.points_index - 1];
+                    self.last_point = self.point(self.points_index - 1);
                     Some(PathSegment::QuadTo(
-                        self.path.points[self.points_index - 2],
+                        self.point(self.points_index - 2),
                         self.last_point,
                     ))
                 }
                 PathVerb::Cubic => {
                     self.points_index += 3;
-                    self.last_point = self.path.points[self.points_index - 1];
+                    self.last_point = self.point(self.points_index - 1);
                     Some(PathSegment::CubicTo(
-                        self.path.points[self.points_index - 3],
-                        self.path.points[self.points_index - 2],
+                        self.point(self.points_index - 3),
+                        self.point(self.points_index - 2),
                         self.last_point
                     ))
                 }
@@ -314,6 +459,7 @@ pub enum PathEdge {
 /// Does not return Move or Close. Always "auto-closes" each contour.
 pub struct PathEdgeIter<'a> {
     path: &'a Path,
+    map: Option<PointMap>,
     verb_index: usize,
     points_index: usize,
     move_to: Point,
@@ -321,10 +467,19 @@ pub struct PathEdgeIter<'a> {
 }
 
 impl<'a, 'b> PathEdgeIter<'a> {
+    #[inline]
+    fn point(&self, index: usize) -> Point {
+        let p = self.path.points[index];
+        match self.map {
+            Some(ref map) => map.map(p),
+            None => p,
+        }
+    }
+
     fn close_line(&mut self) -> Option<PathEdge> {
         self.needs_close_line = false;
 
-        let edge = PathEdge::LineTo(self.path.points[self.points_index - 1], self.move_to);
+        let edge = PathEdge::LineTo(self.point(self.points_index - 1), self.move_to);
         Some(edge)
     }
 }
@@ -341,12 +496,12 @@ impl<'a> Iterator for PathEdgeIter<'a> {
                 PathVerb::Move => {
                     if self.needs_close_line {
                         let res = self.close_line();
-                        self.move_to = self.path.points[self.points_index];
+                        self.move_to = self.point(self.points_index);
                         self.points_index += 1;
                         return res;
                     }
 
-                    self.move_to = self.path.points[self.points_index];
+                    self.move_to = self.point(self.points_index);
                     self.points_index += 1;
                     self.next()
                 }
@@ -365,25 +520,25 @@ impl<'a> Iterator for PathEdgeIter<'a> {
                     match verb {
                         PathVerb::Line => {
                             edge = PathEdge::LineTo(
-                                self.path.points[self.points_index - 1],
-                                self.path.points[self.points_index + 0],
+                                self.point(self.points_index - 1),
+                                self.point(self.points_index + 0),
                             );
                             self.points_index += 1;
                         }
                         PathVerb::Quad => {
                             edge = PathEdge::QuadTo(
-                                self.path.points[self.points_index - 1],
-                                self.path.points[self.points_index + 0],
-                                self.path.points[self.points_index + 1],
+                                self.point(self.points_index - 1),
+                                self.point(self.points_index + 0),
+                                self.point(self.points_index + 1),
                             );
                             self.points_index += 2;
                         }
                         PathVerb::Cubic => {
                             edge = PathEdge::CubicTo(
-                                self.path.points[self.points_index - 1],
-                                self.path.points[self.points_index + 0],
-                                self.path.points[self.points_index + 1],
-                                self.path.points[self.points_index + 2],
+                                self.point(self.points_index - 1),
+                                self.point(self.points_index + 0),
+                                self.point(self.points_index + 1),
+                                self.point(self.points_index + 2),
                             );
                             self.points_index += 3;
                         }
@@ -111,12 +111,42 @@ pub fn chop_quad_at_x_extrema(src: &[Point; 3], dst: &mut [Point; 5]) -> usize {
 ///
 /// Guarantees that the 1/2 quads will be monotonic.
 pub fn chop_quad_at_y_extrema(src: &[Point; 3], dst: &mut [Point; 5]) -> usize {
+    let extremum = find_quad_extremum(src[0].y, src[1].y, src[2].y);
+    chop_quad_at_y_extremum(src, extremum, dst)
+}
+
+/// An extremum of a quad in a single direction.
+#[derive(Copy, Clone, PartialEq)]
+pub enum QuadExtremum {
+    /// The quad is already monotonic.
+    None,
+    At(NormalizedF32Exclusive),
+    /// The quad is not monotonic, but we couldn't compute a unit_divide value
+    /// (probably underflow).
+    Unresolved,
+}
+
+/// Finds an extremum of a quad with `a`, `b` and `c` coordinates.
+pub fn find_quad_extremum(a: f32, b: f32, c: f32) -> QuadExtremum {
+    if is_not_monotonic(a, b, c) {
+        match valid_unit_divide(a - b, a - b - b + c) {
+            Some(t_value) => QuadExtremum::At(t_value),
+            None => QuadExtremum::Unresolved,
+        }
+    } else {
+        QuadExtremum::None
+    }
+}
+
+/// Like `chop_quad_at_y_extrema`, but with an already known Y extremum.
+pub fn chop_quad_at_y_extremum(src: &[Point; 3], extremum: QuadExtremum, dst: &mut [Point; 5]) -> usize {
     let a = src[0].y;
     let mut b = src[1].y;
     let c = src[2].y;
 
-    if is_not_monotonic(a, b, c) {
-        if let Some(t_value) = valid_unit_divide(a - b, a - b - b + c) {
+    match extremum {
+        QuadExtremum::None => {}
+        QuadExtremum::At(t_value) => {
             chop_quad_at(src, t_value, dst);
 
             // flatten double quad extrema
@@ -125,10 +155,11 @@ pub fn chop_quad_at_y_extrema(src: &[Point; 3], dst: &mut [Point; 5]) -> usize {
 
             return 1;
         }
-
-        // if we get here, we need to force dst to be monotonic, even though
-        // we couldn't compute a unit_divide value (probably underflow).
-        b = if (a - b).abs() < (b - c).abs() { a } else { c };
+        QuadExtremum::Unresolved => {
+            // we need to force dst to be monotonic, even though
+            // we couldn't compute a unit_divide value.
+            b = if (a - b).abs() < (b - c).abs() { a } else { c };
+        }
     }
 
     dst[0] = Point::from_xy(src[0].x, a);
@@ -192,8 +223,15 @@ pub fn chop_cubic_at_x_extrema(src: &[Point; 4], dst: &mut [Point; 10]) -> usize
 /// - 1: dst[0..3] and dst[3..6] are the two new cubics
 /// - 2: dst[0..3], dst[3..6], dst[6..9] are the three new cubics
 pub fn chop_cubic_at_y_extrema(src: &[Point; 4], dst: &mut [Point; 10]) -> usize {
+    let coeff = cubic_extrema_coeff(src[0].y, src[1].y, src[2].y, src[3].y);
+    chop_cubic_at_y_extrema_coeff(src, coeff, dst)
+}
+
+/// Like `chop_cubic_at_y_extrema`, but with already computed `cubic_extrema_coeff`.
+pub fn chop_cubic_at_y_extrema_coeff(src: &[Point; 4], coeff: [f32; 3], dst: &mut [Point; 10]) -> usize {
     let mut t_values = new_t_values();
-    let t_values = find_cubic_extrema(src[0].y, src[1].y, src[2].y, src[3].y, &mut t_values);
+    let roots = find_unit_quad_roots(coeff[0], coeff[1], coeff[2], &mut t_values);
+    let t_values = &t_values[0..roots];
 
     chop_cubic_at(src, &t_values, dst);
     if !t_values.is_empty() {
@@ -215,13 +253,18 @@ pub fn chop_cubic_at_y_extrema(src: &[Point; 4], dst: &mut [Point; 10]) -> usize
 // C = 3(b - a)
 // Solve for t, keeping only those that fit between 0 < t < 1
 fn find_cubic_extrema(a: f32, b: f32, c: f32, d: f32, t_values: &mut [NormalizedF32Exclusive; 3]) -> &[NormalizedF32Exclusive] {
+    let coeff = cubic_extrema_coeff(a, b, c, d);
+    let roots = find_unit_quad_roots(coeff[0], coeff[1], coeff[2], t_values);
+    &t_values[0..roots]
+}
+
+/// Returns A, B and C of the cubic derivative, divided by 3.
+pub fn cubic_extrema_coeff(a: f32, b: f32, c: f32, d: f32) -> [f32; 3] {
     // we divide A,B,C by 3 to simplify
     let na = d - a + 3.0 * (b - c);
     let nb = 2.0 * (a - b - b + c);
     let nc = b - a;
-
-    let roots = find_unit_quad_roots(na, nb, nc, t_values);
-    &t_values[0..roots]
+    [na, nb, nc]
 }
 
 /// From Numerical Recipes in C.
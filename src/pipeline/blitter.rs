@@ -4,7 +4,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-use crate::{Paint, BlendMode, LengthU32, PixmapMut, PremultipliedColorU8, Shader, PixmapRef};
+use crate::{Paint, BlendMode, LengthU32, PixelFormat, PixmapMut, PremultipliedColorU8, Shader};
+use crate::PixmapRef;
 use crate::{ALPHA_U8_OPAQUE, ALPHA_U8_TRANSPARENT};
 
 use crate::alpha_runs::AlphaRun;
@@ -15,12 +16,19 @@ use crate::geom::ScreenIntRect;
 use crate::math::LENGTH_U32_ONE;
 use crate::pipeline::{self, RasterPipeline, RasterPipelineBuilder};
 
+/// Opaque and transparent sprite runs shorter than this are left to the pipeline,
+/// since splitting a row into many tiny pipeline runs is slower than blending them.
+const MIN_SPRITE_RUN: usize = 16;
 
 pub struct RasterPipelineBlitter<'a, 'b: 'a> {
-    clip_mask: Option<&'a ClipMaskData>,
+    clip_mask: Option<pipeline::ClipMaskCtx<'a>>,
     pixmap_src: PixmapRef<'a>,
     pixmap: &'a mut PixmapMut<'b>,
     memset2d_color: Option<PremultipliedColorU8>,
+    /// Pattern offset relative to the band, when it can be copied as is.
+    sprite_offset: Option<(i64, i64)>,
+    /// Whether the sprite replaces the destination, instead of being blended onto it.
+    sprite_source: bool,
     blit_anti_h_rp: RasterPipeline,
     blit_rect_rp: RasterPipeline,
     blit_mask_rp: RasterPipeline,
@@ -39,6 +47,19 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
             }
         }
 
+        Self::new_band(paint, clip_mask.map(|c| c.clip_mask_ctx()), 0, pixmap)
+    }
+
+    /// Creates a blitter for a horizontal band of a larger image.
+    ///
+    /// `pixmap` and `clip_mask` must start at the `origin_y` row of the image
+    /// and have the same width as it. Coordinates are relative to the band.
+    pub fn new_band(
+        paint: &Paint<'a>,
+        clip_mask: Option<pipeline::ClipMaskCtx<'a>>,
+        origin_y: u32,
+        pixmap: &'a mut PixmapMut<'b>,
+    ) -> Option<Self> {
         // Fast-reject.
         // This is basically SkInterpretXfermode().
         match paint.blend_mode {
@@ -55,13 +76,15 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
             blend_mode = BlendMode::Source;
         }
 
+        let format = pixmap.format();
+
         // When we're drawing a constant color in Source mode, we can sometimes just memset.
         let mut memset2d_color = None;
         if paint.is_solid_color() && blend_mode == BlendMode::Source && clip_mask.is_none() {
             // Unlike Skia, our shader cannot be constant.
             // Therefore there is no need to run a raster pipeline to get shader's color.
             if let Shader::SolidColor(ref color) = paint.shader {
-                memset2d_color = Some(color.premultiply().to_color_u8());
+                memset2d_color = Some(format.pack_color(*color));
             }
         };
 
@@ -71,9 +94,22 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
             memset2d_color = Some(PremultipliedColorU8::TRANSPARENT);
         }
 
+        // An untransformed pixmap is mostly a memcpy, like SkSpriteBlitter.
+        let mut sprite_offset = None;
+        if let Shader::Pattern(ref patt) = paint.shader {
+            let is_supported_mode = blend_mode == BlendMode::Source
+                || blend_mode == BlendMode::SourceOver;
+            // Pixels are copied as is, so the destination must have the same format.
+            if is_supported_mode && clip_mask.is_none() && format == PixelFormat::default() {
+                sprite_offset = patt.sprite_offset()
+                    .map(|(x, y)| (x as i64, y as i64 - origin_y as i64));
+            }
+        }
+
         let blit_anti_h_rp = {
             let mut p = RasterPipelineBuilder::new();
             p.set_force_hq_pipeline(paint.force_hq_pipeline);
+            p.ctx.origin_y = origin_y as usize;
             paint.shader.push_stages(&mut p);
 
             if clip_mask.is_some() {
@@ -82,12 +118,12 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
 
             if blend_mode.should_pre_scale_coverage() {
                 p.push(pipeline::Stage::Scale1Float);
-                p.push(pipeline::Stage::LoadDestination);
+                p.push_load_dst(format);
                 if let Some(blend_stage) = blend_mode.to_stage() {
                     p.push(blend_stage);
                 }
             } else {
-                p.push(pipeline::Stage::LoadDestination);
+                p.push_load_dst(format);
                 if let Some(blend_stage) = blend_mode.to_stage() {
                     p.push(blend_stage);
                 }
@@ -95,7 +131,7 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
                 p.push(pipeline::Stage::Lerp1Float);
             }
 
-            p.push(pipeline::Stage::Store);
+            p.push_store(format);
 
             p.compile()
         };
@@ -103,24 +139,27 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
         let blit_rect_rp = {
             let mut p = RasterPipelineBuilder::new();
             p.set_force_hq_pipeline(paint.force_hq_pipeline);
+            p.ctx.origin_y = origin_y as usize;
             paint.shader.push_stages(&mut p);
 
             if clip_mask.is_some() {
                 p.push(pipeline::Stage::MaskU8);
             }
 
-            if blend_mode == BlendMode::SourceOver && clip_mask.is_none() {
+            // SourceOverRgba loads and stores premultiplied RGBA by itself.
+            let is_rgba = format == PixelFormat::default();
+            if blend_mode == BlendMode::SourceOver && clip_mask.is_none() && is_rgba {
                 // TODO: ignore when dither_rate is non-zero
                 p.push(pipeline::Stage::SourceOverRgba);
             } else {
                 if blend_mode != BlendMode::Source {
-                    p.push(pipeline::Stage::LoadDestination);
+                    p.push_load_dst(format);
                     if let Some(blend_stage) = blend_mode.to_stage() {
                         p.push(blend_stage);
                     }
                 }
 
-                p.push(pipeline::Stage::Store);
+                p.push_store(format);
             }
 
             p.compile()
@@ -129,6 +168,7 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
         let blit_mask_rp = {
             let mut p = RasterPipelineBuilder::new();
             p.set_force_hq_pipeline(paint.force_hq_pipeline);
+            p.ctx.origin_y = origin_y as usize;
             paint.shader.push_stages(&mut p);
 
             if clip_mask.is_some() {
@@ -137,12 +177,12 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
 
             if blend_mode.should_pre_scale_coverage() {
                 p.push(pipeline::Stage::ScaleU8);
-                p.push(pipeline::Stage::LoadDestination);
+                p.push_load_dst(format);
                 if let Some(blend_stage) = blend_mode.to_stage() {
                     p.push(blend_stage);
                 }
             } else {
-                p.push(pipeline::Stage::LoadDestination);
+                p.push_load_dst(format);
                 if let Some(blend_stage) = blend_mode.to_stage() {
                     p.push(blend_stage);
                 }
@@ -150,7 +190,7 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
                 p.push(pipeline::Stage::LerpU8);
             }
 
-            p.push(pipeline::Stage::Store);
+            p.push_store(format);
 
             p.compile()
         };
@@ -166,6 +206,8 @@ impl<'a, 'b: 'a> RasterPipelineBlitter<'a, 'b> {
             pixmap_src,
             pixmap,
             memset2d_color,
+            sprite_offset,
+            sprite_source: blend_mode == BlendMode::Source,
             blit_anti_h_rp,
             blit_rect_rp,
             blit_mask_rp,
@@ -180,7 +222,7 @@ impl Blitter for RasterPipelineBlitter<'_, '_> {
     }
 
     fn blit_anti_h(&mut self, mut x: u32, y: u32, aa: &mut [AlphaU8], runs: &mut [AlphaRun]) {
-        let clip_mask_ctx = self.clip_mask.map(|c| c.clip_mask_ctx()).unwrap_or_default();
+        let clip_mask_ctx = self.clip_mask.unwrap_or_default();
 
         let mut aa_offset = 0;
         let mut run_offset = 0;
@@ -195,8 +237,10 @@ impl Blitter for RasterPipelineBlitter<'_, '_> {
                 }
                 alpha => {
                     self.blit_anti_h_rp.ctx.current_coverage = alpha as f32 * (1.0 / 255.0);
+                    count!(ANTI_H_PIXELS, width.get());
 
                     let rect = ScreenIntRect::from_xywh_safe(x, y, width, LENGTH_U32_ONE);
+                    self.pixmap.mark_dirty(&rect);
                     self.blit_anti_h_rp.run(
                         &rect,
                         pipeline::AAMaskCtx::default(),
@@ -251,25 +295,25 @@ impl Blitter for RasterPipelineBlitter<'_, '_> {
     }
 
     fn blit_rect(&mut self, rect: &ScreenIntRect) {
+        self.pixmap.mark_dirty(rect);
+
         if let Some(c) = self.memset2d_color {
+            count!(MEMSET_PIXELS, rect.width() as usize * rect.height() as usize);
             for y in 0..rect.height() {
                 let start = self.pixmap.offset(rect.x() as usize, (rect.y() + y) as usize);
                 let end = start + rect.width() as usize;
-                self.pixmap.pixels_mut()[start..end].iter_mut().for_each(|p| *p = c);
+                self.pixmap.storage_mut()[start..end].iter_mut().for_each(|p| *p = c);
             }
 
             return;
         }
 
-        let clip_mask_ctx = self.clip_mask.map(|c| c.clip_mask_ctx()).unwrap_or_default();
+        if let Some((dx, dy)) = self.sprite_offset {
+            self.blit_sprite(rect, dx, dy);
+            return;
+        }
 
-        self.blit_rect_rp.run(
-            rect,
-            pipeline::AAMaskCtx::default(),
-            clip_mask_ctx,
-            self.pixmap_src,
-            self.pixmap,
-        );
+        self.blit_rect_pipeline(rect);
     }
 
     fn blit_mask(&mut self, mask: &Mask, clip: &ScreenIntRect) {
@@ -279,7 +323,9 @@ impl Blitter for RasterPipelineBlitter<'_, '_> {
             shift: (mask.bounds.left() + mask.bounds.top() * mask.row_bytes) as usize,
         };
 
-        let clip_mask_ctx = self.clip_mask.map(|c| c.clip_mask_ctx()).unwrap_or_default();
+        let clip_mask_ctx = self.clip_mask.unwrap_or_default();
+        count!(MASK_PIXELS, clip.width() as usize * clip.height() as usize);
+        self.pixmap.mark_dirty(clip);
 
         self.blit_mask_rp.run(
             clip,
@@ -290,3 +336,117 @@ impl Blitter for RasterPipelineBlitter<'_, '_> {
         );
     }
 }
+
+impl RasterPipelineBlitter<'_, '_> {
+    fn blit_rect_pipeline(&mut self, rect: &ScreenIntRect) {
+        let clip_mask_ctx = self.clip_mask.unwrap_or_default();
+        count!(RECT_PIXELS, rect.width() as usize * rect.height() as usize);
+
+        self.blit_rect_rp.run(
+            rect,
+            pipeline::AAMaskCtx::default(),
+            clip_mask_ctx,
+            self.pixmap_src,
+            self.pixmap,
+        );
+    }
+
+    /// Copies sprite pixels onto the destination.
+    ///
+    /// Opaque runs are copied and transparent ones are skipped. Everything else,
+    /// including parts of `rect` outside the sprite, is still handled by the pipeline,
+    /// so the result is identical to it.
+    fn blit_sprite(&mut self, rect: &ScreenIntRect, dx: i64, dy: i64) {
+        let pixmap_src = self.pixmap_src;
+
+        // Sprite area inside `rect`.
+        let left = (rect.left() as i64).max(dx);
+        let top = (rect.top() as i64).max(dy);
+        let right = (rect.right() as i64).min(dx + pixmap_src.width() as i64);
+        let bottom = (rect.bottom() as i64).min(dy + pixmap_src.height() as i64);
+        if left >= right || top >= bottom {
+            self.blit_rect_pipeline(rect);
+            return;
+        }
+
+        // Cannot overflow, since the area is inside `rect`.
+        let (left, top, right, bottom) = (left as u32, top as u32, right as u32, bottom as u32);
+        self.blit_rect_pipeline_ltrb(rect.left(), rect.top(), rect.right(), top);
+        self.blit_rect_pipeline_ltrb(rect.left(), top, left, bottom);
+        self.blit_rect_pipeline_ltrb(right, top, rect.right(), bottom);
+        self.blit_rect_pipeline_ltrb(rect.left(), bottom, rect.right(), rect.bottom());
+
+        let src_x = (left as i64 - dx) as usize;
+        let src_y = (top as i64 - dy) as usize;
+        let width = (right - left) as usize;
+        let src_stride = pixmap_src.stride();
+        for y in top..bottom {
+            let src_start = (src_y + (y - top) as usize) * src_stride + src_x;
+            let src = &pixmap_src.storage()[src_start..src_start + width];
+            let dst_start = self.pixmap.offset(left as usize, y as usize);
+
+            if self.sprite_source {
+                self.pixmap.storage_mut()[dst_start..dst_start + width].copy_from_slice(src);
+                continue;
+            }
+
+            // The start of a run that has to be blended by the pipeline.
+            let mut blend_start = None;
+            let mut x = 0;
+            while x < width {
+                let kind = sprite_pixel_kind(src[x]);
+                let mut end = x + 1;
+                while end < width && sprite_pixel_kind(src[end]) == kind {
+                    end += 1;
+                }
+
+                if kind == SpritePixel::Blend || end - x < MIN_SPRITE_RUN {
+                    blend_start = blend_start.or(Some(x));
+                } else {
+                    if let Some(start) = blend_start.take() {
+                        self.blit_rect_pipeline_ltrb(
+                            left + start as u32, y, left + x as u32, y + 1,
+                        );
+                    }
+
+                    if kind == SpritePixel::Opaque {
+                        let dst = &mut self.pixmap.storage_mut()[dst_start + x..dst_start + end];
+                        dst.copy_from_slice(&src[x..end]);
+                    }
+                }
+
+                x = end;
+            }
+
+            if let Some(start) = blend_start {
+                self.blit_rect_pipeline_ltrb(left + start as u32, y, right, y + 1);
+            }
+        }
+    }
+
+    fn blit_rect_pipeline_ltrb(&mut self, left: u32, top: u32, right: u32, bottom: u32) {
+        if left < right && top < bottom {
+            // Cannot fail, since we're always inside the blitted rect.
+            let rect = ScreenIntRect::from_xywh(left, top, right - left, bottom - top).unwrap();
+            self.blit_rect_pipeline(&rect);
+        }
+    }
+}
+
+#[derive(Copy, Clone, PartialEq)]
+enum SpritePixel {
+    Opaque,
+    Transparent,
+    Blend,
+}
+
+#[inline]
+fn sprite_pixel_kind(c: PremultipliedColorU8) -> SpritePixel {
+    if c.alpha() == ALPHA_U8_OPAQUE {
+        SpritePixel::Opaque
+    } else if c == PremultipliedColorU8::TRANSPARENT {
+        SpritePixel::Transparent
+    } else {
+        SpritePixel::Blend
+    }
+}
@@ -0,0 +1,95 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+//! A per-thread cache of compiled pipeline programs.
+//!
+//! Most of the time, only a handful of distinct stage lists are used,
+//! so we keep a small list instead of a hash map. New programs are inserted
+//! at the front and the oldest one is evicted. Hits do not reorder the list,
+//! since moving entries costs about as much as compiling a program.
+
+use alloc::rc::Rc;
+use alloc::vec::Vec;
+use core::cell::RefCell;
+
+use arrayvec::ArrayVec;
+
+use super::{Stage, Program, RasterPipelineKind, MAX_STAGES};
+
+const CACHE_SIZE: usize = 32;
+
+struct Entry {
+    stages: ArrayVec<[Stage; MAX_STAGES]>,
+    force_hq_pipeline: bool,
+    kind: Rc<RasterPipelineKind>,
+}
+
+std::thread_local! {
+    static CACHE: RefCell<Vec<Entry>> = RefCell::new(Vec::new());
+}
+
+/// Returns a cached program or compiles a new one.
+pub fn get_or_compile(
+    stages: &[Stage],
+    force_hq_pipeline: bool,
+    compile: impl FnOnce() -> RasterPipelineKind,
+) -> Program {
+    let mut compile = Some(compile);
+    let cached = CACHE.try_with(|cache| {
+        let mut cache = cache.borrow_mut();
+
+        let pos = cache.iter().position(|e| {
+            e.force_hq_pipeline == force_hq_pipeline && e.stages.as_slice() == stages
+        });
+
+        if let Some(pos) = pos {
+            return cache[pos].kind.clone();
+        }
+
+        let kind = Rc::new((compile.take().unwrap())());
+        if cache.len() == CACHE_SIZE {
+            cache.pop();
+        }
+
+        cache.insert(0, Entry {
+            stages: stages.iter().copied().collect(),
+            force_hq_pipeline,
+            kind: kind.clone(),
+        });
+
+        kind
+    });
+
+    match cached {
+        Ok(kind) => Program::Shared(kind),
+        // Thread-local storage is already destroyed. Compile directly.
+        Err(_) => Program::Owned((compile.take().unwrap())()),
+    }
+}
+
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn shared(program: Program) -> Rc<RasterPipelineKind> {
+        match program {
+            Program::Shared(kind) => kind,
+            Program::Owned(_) => panic!("a program must be cached"),
+        }
+    }
+
+    #[test]
+    fn reuse() {
+        let stages = [Stage::UniformColor, Stage::LoadDestination, Stage::SourceOver, Stage::Store];
+        let a = shared(get_or_compile(&stages, false, || super::super::compile_kind(&stages, false)));
+        let b = shared(get_or_compile(&stages, false, || unreachable!()));
+        assert!(Rc::ptr_eq(&a, &b));
+
+        let c = shared(get_or_compile(&stages, true, || super::super::compile_kind(&stages, true)));
+        assert!(!Rc::ptr_eq(&a, &c));
+        assert!(matches!(*c, RasterPipelineKind::High { .. }));
+    }
+}
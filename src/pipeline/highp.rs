@@ -108,6 +108,7 @@ pub const STAGES: &[StageFn; super::STAGES_COUNT] = &[
     reflect_x1,
     repeat_x1,
     gradient,
+    gradient_lut,
     evenly_spaced_2_stop_gradient,
     xy_to_radius,
     xy_to_2pt_conical_focal_on_circle,
@@ -115,6 +116,10 @@ pub const STAGES: &[StageFn; super::STAGES_COUNT] = &[
     xy_to_2pt_conical_greater,
     mask_2pt_conical_degenerates,
     apply_vector_mask,
+    swap_rb,
+    swap_rb_dst,
+    premultiply_dst,
+    unpremultiply,
 ];
 
 pub fn fn_ptr(f: StageFn) -> *const () {
@@ -195,6 +200,35 @@ fn premultiply(p: &mut Pipeline) {
     p.next_stage();
 }
 
+fn premultiply_dst(p: &mut Pipeline) {
+    p.dr *= p.da;
+    p.dg *= p.da;
+    p.db *= p.da;
+
+    p.next_stage();
+}
+
+fn unpremultiply(p: &mut Pipeline) {
+    let scale = p.a.cmp_gt(f32x8::default()).blend(f32x8::splat(1.0) / p.a, f32x8::default());
+    p.r *= scale;
+    p.g *= scale;
+    p.b *= scale;
+
+    p.next_stage();
+}
+
+fn swap_rb(p: &mut Pipeline) {
+    core::mem::swap(&mut p.r, &mut p.b);
+
+    p.next_stage();
+}
+
+fn swap_rb_dst(p: &mut Pipeline) {
+    core::mem::swap(&mut p.dr, &mut p.db);
+
+    p.next_stage();
+}
+
 fn move_destination_to_source(p: &mut Pipeline) {
     p.r = p.dr;
     p.g = p.dg;
@@ -236,7 +270,7 @@ fn seed_shader(p: &mut Pipeline) {
     let iota = f32x8::from([0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5]);
 
     p.r = f32x8::splat(p.dx as f32) + iota;
-    p.g = f32x8::splat(p.dy as f32 + 0.5);
+    p.g = f32x8::splat((p.dy + p.ctx.origin_y) as f32 + 0.5);
     p.b = f32x8::splat(1.0);
     p.a = f32x8::default();
 
@@ -271,14 +305,14 @@ pub fn gather(p: &mut Pipeline) {
 }
 
 #[inline(always)]
-fn gather_ix(pixmap: PixmapRef, mut x: f32x8, mut y: f32x8) -> u32x8 {
+pub(super) fn gather_ix(pixmap: PixmapRef, mut x: f32x8, mut y: f32x8) -> u32x8 {
     // Exclusive -> inclusive.
     let w = ulp_sub(pixmap.width() as f32);
     let h = ulp_sub(pixmap.height() as f32);
     x = x.max(f32x8::default()).min(f32x8::splat(w));
     y = y.max(f32x8::default()).min(f32x8::splat(h));
 
-    (y.trunc_int() * i32x8::splat(pixmap.width() as i32) + x.trunc_int()).to_u32x8_bitcast()
+    (y.trunc_int() * i32x8::splat(pixmap.stride() as i32) + x.trunc_int()).to_u32x8_bitcast()
 }
 
 #[inline(always)]
@@ -294,9 +328,10 @@ pub fn store_tail(p: &mut Pipeline) {
 
 fn mask_u8(p: &mut Pipeline) {
     let offset = p.clip_mask_ctx.offset(p.dx, p.dy);
+    let data = &p.clip_mask_ctx.data[offset..offset + p.tail];
     let mut c = [0.0; 8];
     for i in 0..p.tail {
-        c[i] = p.clip_mask_ctx.data[offset + i] as f32;
+        c[i] = data[i] as f32;
     }
     let c = f32x8::from(c) / f32x8::splat(255.0);
 
@@ -304,6 +339,12 @@ fn mask_u8(p: &mut Pipeline) {
         return;
     }
 
+    // Fully covered. Nothing to scale.
+    if data.iter().all(|&c| c == 255) {
+        p.next_stage();
+        return;
+    }
+
     p.r *= c;
     p.g *= c;
     p.b *= c;
@@ -674,7 +715,7 @@ fn reflect(p: &mut Pipeline) {
 }
 
 #[inline(always)]
-fn exclusive_reflect(v: f32x8, limit: f32, inv_limit: f32) -> f32x8 {
+pub(super) fn exclusive_reflect(v: f32x8, limit: f32, inv_limit: f32) -> f32x8 {
     let limit = f32x8::splat(limit);
     let inv_limit = f32x8::splat(inv_limit);
     ((v - limit) - (limit + limit)
@@ -692,22 +733,33 @@ fn repeat(p: &mut Pipeline) {
 }
 
 #[inline(always)]
-fn exclusive_repeat(v: f32x8, limit: f32, inv_limit: f32) -> f32x8 {
+pub(super) fn exclusive_repeat(v: f32x8, limit: f32, inv_limit: f32) -> f32x8 {
     v - (v * f32x8::splat(inv_limit)).floor() * f32x8::splat(limit)
 }
 
 fn bilinear(p: &mut Pipeline) {
     let x = p.r;
-    let fx = (x + f32x8::splat(0.5)).fract();
     let y = p.g;
+    sample_bilinear(p.pixmap_src, &p.ctx.sampler, x, y, &mut p.r, &mut p.g, &mut p.b, &mut p.a);
+
+    p.next_stage();
+}
+
+// Also used by lowp, which doesn't have enough precision for weights.
+#[inline(always)]
+pub(super) fn sample_bilinear(
+    pixmap: PixmapRef,
+    ctx: &super::SamplerCtx,
+    x: f32x8, y: f32x8,
+    r: &mut f32x8, g: &mut f32x8, b: &mut f32x8, a: &mut f32x8,
+) {
+    let fx = (x + f32x8::splat(0.5)).fract();
     let fy = (y + f32x8::splat(0.5)).fract();
     let one = f32x8::splat(1.0);
     let wx = [one - fx, fx];
     let wy = [one - fy, fy];
 
-    sampler_2x2(p.pixmap_src, &p.ctx.sampler, x, y, &wx, &wy, &mut p.r, &mut p.g, &mut p.b, &mut p.a);
-
-    p.next_stage();
+    sampler_2x2(pixmap, ctx, x, y, &wx, &wy, r, g, b, a);
 }
 
 fn bicubic(p: &mut Pipeline) {
@@ -896,6 +948,30 @@ fn gradient(p: &mut Pipeline) {
     p.next_stage();
 }
 
+fn gradient_lut(p: &mut Pipeline) {
+    // Always set together with the stage.
+    let ctx = p.ctx.gradient_lut.as_ref().unwrap();
+
+    // `t` is not clamped in the pad mode.
+    let t = p.r.normalize();
+    let cells = (ctx.len - 1) as u32;
+    let tc: [f32; 8] = (t * f32x8::splat(cells as f32)).into();
+    // Float to int casts are saturating, so `idx` is always valid, even for NaN.
+    let idx: u32x8 = bytemuck::cast([
+        (tc[0] as u32).min(cells),
+        (tc[1] as u32).min(cells),
+        (tc[2] as u32).min(cells),
+        (tc[3] as u32).min(cells),
+        (tc[4] as u32).min(cells),
+        (tc[5] as u32).min(cells),
+        (tc[6] as u32).min(cells),
+        (tc[7] as u32).min(cells),
+    ]);
+    gradient_lookup(ctx, &idx, t, &mut p.r, &mut p.g, &mut p.b, &mut p.a);
+
+    p.next_stage();
+}
+
 fn gradient_lookup(
     ctx: &super::GradientCtx, idx: &u32x8, t: f32x8,
     r: &mut f32x8, g: &mut f32x8, b: &mut f32x8, a: &mut f32x8,
@@ -11,6 +11,9 @@ A lowp pipeline uses u16 instead of f32 for math.
 Because of that, it doesn't implement stages that require high precision.
 The pipeline compiler will automatically decide which one to use.
 
+Shader coordinates are still stored as f32x16, split between a pair of u16x16 registers:
+`r`/`g` for x and `b`/`a` for y. Sampling stages reuse the highp code for each half.
+
 Skia uses u16x8 (128bit) types for a generic CPU and u16x16 (256bit) for modern x86 CPUs.
 But instead of explicit SIMD instructions, it mainly relies on clang's vector extensions.
 And since they are unavailable in Rust, we have to do everything manually.
@@ -26,11 +29,13 @@ And while `-C target-cpu=haswell` boosts our performance by around 25%,
 we are still 40-60% behind Skia built for Haswell.
 */
 
-use crate::{PremultipliedColorU8, PixmapMut};
+use crate::{PremultipliedColorU8, PixmapMut, PixmapRef};
 
 use crate::geom::ScreenIntRect;
 use crate::wide::{f32x8, u16x16, f32x16};
 
+use super::highp;
+
 pub const STAGE_WIDTH: usize = 16;
 
 pub type StageFn = fn(p: &mut Pipeline);
@@ -38,6 +43,7 @@ pub type StageFn = fn(p: &mut Pipeline);
 pub struct Pipeline<'a, 'b: 'a> {
     index: usize,
     functions: &'a [StageFn],
+    pixmap_src: PixmapRef<'a>,
     pixmap: &'a mut PixmapMut<'b>,
     clip_mask_ctx: super::ClipMaskCtx<'a>,
     mask_ctx: super::AAMaskCtx,
@@ -76,7 +82,7 @@ pub const STAGES: &[StageFn; super::STAGES_COUNT] = &[
     seed_shader,
     load_dst,
     store,
-    null_fn, // Gather
+    gather,
     mask_u8,
     scale_u8,
     lerp_u8,
@@ -111,21 +117,26 @@ pub const STAGES: &[StageFn; super::STAGES_COUNT] = &[
     null_fn, // Luminosity
     source_over_rgba,
     transform,
-    null_fn, // Reflect
-    null_fn, // Repeat
-    null_fn, // Bilinear
+    reflect,
+    repeat,
+    bilinear,
     null_fn, // Bicubic
     pad_x1,
     reflect_x1,
     repeat_x1,
     gradient,
+    gradient_lut,
     evenly_spaced_2_stop_gradient,
     xy_to_radius,
     null_fn, // XYTo2PtConicalFocalOnCircle
-    null_fn, // XYTo2PtConicalWellBehaved
+    xy_to_2pt_conical_well_behaved,
     null_fn, // XYTo2PtConicalGreater
     null_fn, // Mask2PtConicalDegenerates
     null_fn, // ApplyVectorMask
+    swap_rb,
+    swap_rb_dst,
+    premultiply_dst,
+    null_fn, // Unpremultiply
 ];
 
 pub fn fn_ptr(f: StageFn) -> *const () {
@@ -144,11 +155,13 @@ pub fn start(
     mask_ctx: super::AAMaskCtx,
     clip_mask_ctx: super::ClipMaskCtx,
     ctx: &mut super::Context,
+    pixmap_src: PixmapRef,
     pixmap: &mut PixmapMut,
 ) {
     let mut p = Pipeline {
         index: 0,
         functions: &[],
+        pixmap_src,
         pixmap,
         clip_mask_ctx,
         mask_ctx,
@@ -217,6 +230,26 @@ fn premultiply(p: &mut Pipeline) {
     p.next_stage();
 }
 
+fn premultiply_dst(p: &mut Pipeline) {
+    p.dr = div255(p.dr * p.da);
+    p.dg = div255(p.dg * p.da);
+    p.db = div255(p.db * p.da);
+
+    p.next_stage();
+}
+
+fn swap_rb(p: &mut Pipeline) {
+    core::mem::swap(&mut p.r, &mut p.b);
+
+    p.next_stage();
+}
+
+fn swap_rb_dst(p: &mut Pipeline) {
+    core::mem::swap(&mut p.dr, &mut p.db);
+
+    p.next_stage();
+}
+
 fn uniform_color(p: &mut Pipeline) {
     let ctx = p.ctx.uniform_color;
     p.r = u16x16::splat(ctx.rgba[0]);
@@ -234,7 +267,7 @@ fn seed_shader(p: &mut Pipeline) {
     ]);
 
     let x = f32x16::splat(p.dx as f32) + iota;
-    let y = f32x16::splat(p.dy as f32 + 0.5);
+    let y = f32x16::splat((p.dy + p.ctx.origin_y) as f32 + 0.5);
     split(&x, &mut p.r, &mut p.g);
     split(&y, &mut p.b, &mut p.a);
 
@@ -263,16 +296,23 @@ pub fn store_tail(p: &mut Pipeline) {
 
 fn mask_u8(p: &mut Pipeline) {
     let offset = p.clip_mask_ctx.offset(p.dx, p.dy);
+    let data = &p.clip_mask_ctx.data[offset..offset + p.tail];
 
     let mut c = u16x16::default();
     for i in 0..p.tail {
-        c.0[i] = u16::from(p.clip_mask_ctx.data[offset + i]);
+        c.0[i] = u16::from(data[i]);
     }
 
     if c == u16x16::default() {
         return;
     }
 
+    // Fully covered. Nothing to scale.
+    if data.iter().all(|&c| c == 255) {
+        p.next_stage();
+        return;
+    }
+
     p.r = div255(p.r * c);
     p.g = div255(p.g * c);
     p.b = div255(p.b * c);
@@ -470,6 +510,74 @@ fn transform(p: &mut Pipeline) {
     p.next_stage();
 }
 
+fn gather(p: &mut Pipeline) {
+    let x = join(&p.r, &p.g);
+    let y = join(&p.b, &p.a);
+    let pixels = gather_8888(p.pixmap_src, &x, &y);
+    load_8888(&pixels, &mut p.r, &mut p.g, &mut p.b, &mut p.a);
+
+    p.next_stage();
+}
+
+#[inline(always)]
+fn gather_8888(pixmap: PixmapRef, x: &f32x16, y: &f32x16) -> [PremultipliedColorU8; STAGE_WIDTH] {
+    let lo = pixmap.gather(highp::gather_ix(pixmap, x.0[0], y.0[0]));
+    let hi = pixmap.gather(highp::gather_ix(pixmap, x.0[1], y.0[1]));
+
+    let mut pixels = [PremultipliedColorU8::TRANSPARENT; STAGE_WIDTH];
+    pixels[..highp::STAGE_WIDTH].copy_from_slice(&lo);
+    pixels[highp::STAGE_WIDTH..].copy_from_slice(&hi);
+    pixels
+}
+
+fn reflect(p: &mut Pipeline) {
+    let ctx = p.ctx.limit_x;
+    let x = join(&p.r, &p.g);
+    let x = map_halves(&x, |v| highp::exclusive_reflect(v, ctx.scale, ctx.inv_scale));
+    split(&x, &mut p.r, &mut p.g);
+
+    let ctx = p.ctx.limit_y;
+    let y = join(&p.b, &p.a);
+    let y = map_halves(&y, |v| highp::exclusive_reflect(v, ctx.scale, ctx.inv_scale));
+    split(&y, &mut p.b, &mut p.a);
+
+    p.next_stage();
+}
+
+fn repeat(p: &mut Pipeline) {
+    let ctx = p.ctx.limit_x;
+    let x = join(&p.r, &p.g);
+    let x = map_halves(&x, |v| highp::exclusive_repeat(v, ctx.scale, ctx.inv_scale));
+    split(&x, &mut p.r, &mut p.g);
+
+    let ctx = p.ctx.limit_y;
+    let y = join(&p.b, &p.a);
+    let y = map_halves(&y, |v| highp::exclusive_repeat(v, ctx.scale, ctx.inv_scale));
+    split(&y, &mut p.b, &mut p.a);
+
+    p.next_stage();
+}
+
+fn bilinear(p: &mut Pipeline) {
+    let x = join(&p.r, &p.g);
+    let y = join(&p.b, &p.a);
+
+    let mut r = f32x16::default();
+    let mut g = f32x16::default();
+    let mut b = f32x16::default();
+    let mut a = f32x16::default();
+    for i in 0..2 {
+        highp::sample_bilinear(
+            p.pixmap_src, &p.ctx.sampler, x.0[i], y.0[i],
+            &mut r.0[i], &mut g.0[i], &mut b.0[i], &mut a.0[i],
+        );
+    }
+
+    round_f32_to_u16(r, g, b, a, &mut p.r, &mut p.g, &mut p.b, &mut p.a);
+
+    p.next_stage();
+}
+
 fn pad_x1(p: &mut Pipeline) {
     let x = join(&p.r, &p.g);
     let x = x.normalize();
@@ -531,6 +639,27 @@ fn gradient(p: &mut Pipeline) {
     p.next_stage();
 }
 
+fn gradient_lut(p: &mut Pipeline) {
+    // Always set together with the stage.
+    let ctx = p.ctx.gradient_lut.as_ref().unwrap();
+
+    // `t` is not clamped in the pad mode.
+    let t = join(&p.r, &p.g).normalize();
+    let cells = (ctx.len - 1) as u16;
+    let tc = t * f32x16::splat(cells as f32);
+    let t0: [f32; 8] = tc.0[0].into();
+    let t1: [f32; 8] = tc.0[1].into();
+    // Float to int casts are saturating, so `idx` is always valid, even for NaN.
+    let mut idx = u16x16::splat(0);
+    for i in 0..8 {
+        idx.0[i] = (t0[i] as u16).min(cells);
+        idx.0[i + 8] = (t1[i] as u16).min(cells);
+    }
+    gradient_lookup(ctx, &idx, t, &mut p.r, &mut p.g, &mut p.b, &mut p.a);
+
+    p.next_stage();
+}
+
 fn evenly_spaced_2_stop_gradient(p: &mut Pipeline) {
     let ctx = &p.ctx.evenly_spaced_2_stop_gradient;
 
@@ -556,6 +685,17 @@ fn xy_to_radius(p: &mut Pipeline) {
     p.next_stage();
 }
 
+fn xy_to_2pt_conical_well_behaved(p: &mut Pipeline) {
+    let ctx = &p.ctx.two_point_conical_gradient;
+
+    let x = join(&p.r, &p.g);
+    let y = join(&p.b, &p.a);
+    let x = (x * x + y * y).sqrt() - x * f32x16::splat(ctx.p0);
+    split(&x, &mut p.r, &mut p.g);
+
+    p.next_stage();
+}
+
 // We are using u16 for index, not u32 as Skia, to simplify the code a bit.
 // The gradient creation code will not allow that many stops anyway.
 fn gradient_lookup(
@@ -782,6 +922,11 @@ fn join(lo: &u16x16, hi: &u16x16) -> f32x16 {
     v
 }
 
+#[inline(always)]
+fn map_halves(v: &f32x16, f: impl Fn(f32x8) -> f32x8) -> f32x16 {
+    f32x16([f(v.0[0]), f(v.0[1])])
+}
+
 #[inline(always)]
 fn mad(f: f32x16, m: f32x16, a: f32x16) -> f32x16 {
     f * m + a
@@ -44,12 +44,15 @@ There are still some exceptions, which are basically an imperfect implementation
 and should be optimized out in the future.
 */
 
+#[cfg(feature = "std")]
+use alloc::rc::Rc;
+use alloc::sync::Arc;
 use alloc::vec::Vec;
 
 use arrayvec::ArrayVec;
 
 use crate::{LengthU32, Color, SpreadMode, PremultipliedColor, PremultipliedColorU8};
-use crate::{Transform, PixmapRef, PixmapMut};
+use crate::{Transform, PixelFormat, PixmapRef, PixmapMut};
 
 pub use blitter::RasterPipelineBlitter;
 
@@ -59,13 +62,15 @@ use crate::math::LENGTH_U32_ONE;
 use crate::wide::u32x8;
 
 mod blitter;
+#[cfg(feature = "std")]
+mod cache;
 mod lowp;
 mod highp;
 
 const MAX_STAGES: usize = 32; // More than enough.
 
 #[allow(dead_code)]
-#[derive(Copy, Clone, Debug)]
+#[derive(Copy, Clone, PartialEq, Debug)]
 pub enum Stage {
     MoveSourceToDestination = 0,
     MoveDestinationToSource,
@@ -119,6 +124,7 @@ pub enum Stage {
     ReflectX1,
     RepeatX1,
     Gradient,
+    GradientLut,
     EvenlySpaced2StopGradient,
     XYToRadius,
     XYTo2PtConicalFocalOnCircle,
@@ -126,16 +132,20 @@ pub enum Stage {
     XYTo2PtConicalGreater,
     Mask2PtConicalDegenerates,
     ApplyVectorMask,
+    SwapRb,
+    SwapRbDestination,
+    PremultiplyDestination,
+    Unpremultiply,
 }
 
-pub const STAGES_COUNT: usize = Stage::ApplyVectorMask as usize + 1;
+pub const STAGES_COUNT: usize = Stage::Unpremultiply as usize + 1;
 
 
 impl<'a> PixmapRef<'a> {
     #[inline(always)]
     pub(crate) fn gather(&self, index: u32x8) -> [PremultipliedColorU8; highp::STAGE_WIDTH] {
         let index: [u32; 8] = bytemuck::cast(index);
-        let pixels = self.pixels();
+        let pixels = self.storage();
         [
             pixels[index[0] as usize],
             pixels[index[1] as usize],
@@ -152,13 +162,13 @@ impl<'a> PixmapRef<'a> {
 impl<'a> PixmapMut<'a> {
     #[inline(always)]
     pub(crate) fn offset(&self, dx: usize, dy: usize) -> usize {
-        self.width() as usize * dy + dx
+        self.stride() * dy + dx
     }
 
     #[inline(always)]
     pub(crate) fn slice_at_xy(&mut self, dx: usize, dy: usize) -> &mut [PremultipliedColorU8] {
         let offset = self.offset(dx, dy);
-        &mut self.pixels_mut()[offset..]
+        &mut self.storage_mut()[offset..]
     }
 
     #[inline(always)]
@@ -167,7 +177,7 @@ impl<'a> PixmapMut<'a> {
         dx: usize,
         dy: usize,
     ) -> &mut [PremultipliedColorU8; highp::STAGE_WIDTH] {
-        arrayref::array_mut_ref!(self.pixels_mut(), self.offset(dx, dy), highp::STAGE_WIDTH)
+        arrayref::array_mut_ref!(self.storage_mut(), self.offset(dx, dy), highp::STAGE_WIDTH)
     }
 
     #[inline(always)]
@@ -176,7 +186,7 @@ impl<'a> PixmapMut<'a> {
         dx: usize,
         dy: usize,
     ) -> &mut [PremultipliedColorU8; lowp::STAGE_WIDTH] {
-        arrayref::array_mut_ref!(self.pixels_mut(), self.offset(dx, dy), lowp::STAGE_WIDTH)
+        arrayref::array_mut_ref!(self.storage_mut(), self.offset(dx, dy), lowp::STAGE_WIDTH)
     }
 }
 
@@ -207,6 +217,10 @@ impl AAMaskCtx {
 pub struct ClipMaskCtx<'a> {
     pub data: &'a [u8],
     pub stride: LengthU32,
+    /// Mask offset/position in pixmap coordinates.
+    ///
+    /// The mask covers only a part of the pixmap and pipelines must not run outside of it.
+    pub shift: usize,
 }
 
 impl Default for ClipMaskCtx<'_> {
@@ -214,6 +228,7 @@ impl Default for ClipMaskCtx<'_> {
         ClipMaskCtx {
             data: &[],
             stride: LENGTH_U32_ONE,
+            shift: 0,
         }
     }
 }
@@ -221,7 +236,8 @@ impl Default for ClipMaskCtx<'_> {
 impl ClipMaskCtx<'_> {
     #[inline(always)]
     fn offset(&self, dx: usize, dy: usize) -> usize {
-        self.stride.get() as usize * dy + dx
+        // `shift` can be "negative" for band pipelines.
+        (self.stride.get() as usize * dy + dx).wrapping_sub(self.shift)
     }
 }
 
@@ -233,10 +249,16 @@ pub struct Context {
     pub uniform_color: UniformColorCtx,
     pub evenly_spaced_2_stop_gradient: EvenlySpaced2StopGradientCtx,
     pub gradient: GradientCtx,
+    /// A lookup table, which is shared with the shader.
+    pub gradient_lut: Option<Arc<GradientCtx>>,
     pub two_point_conical_gradient: TwoPointConicalGradientCtx,
     pub limit_x: TileCtx,
     pub limit_y: TileCtx,
     pub transform: Transform,
+    /// A vertical offset of the destination inside the whole image.
+    ///
+    /// Used by shaders, so a pixmap band would be shaded as a part of a larger one.
+    pub origin_y: usize,
 }
 
 
@@ -260,7 +282,7 @@ pub struct UniformColorCtx {
 
 // A gradient color is an unpremultiplied RGBA not in a 0..1 range.
 // It basically can have any float value.
-#[derive(Copy, Clone, Default, Debug)]
+#[derive(Copy, Clone, Default, PartialEq, Debug)]
 pub struct GradientColor {
     pub r: f32,
     pub g: f32,
@@ -293,7 +315,7 @@ pub struct EvenlySpaced2StopGradientCtx {
 }
 
 
-#[derive(Clone, Default, Debug)]
+#[derive(Clone, Default, PartialEq, Debug)]
 pub struct GradientCtx {
     /// This value stores the actual colors count.
     /// `factors` and `biases` must store at least 16 values,
@@ -315,7 +337,7 @@ impl GradientCtx {
 
 #[derive(Copy, Clone, Default, Debug)]
 pub struct TwoPointConicalGradientCtx {
-    // This context is used only in highp, where we use Tx4.
+    // `mask` is used only in highp, where we use Tx4.
     pub mask: u32x8,
     pub p0: f32,
 }
@@ -357,6 +379,31 @@ impl RasterPipelineBuilder {
         }
     }
 
+    /// Pushes the destination loading, followed by a conversion from the `format`.
+    pub fn push_load_dst(&mut self, format: PixelFormat) {
+        self.stages.push(Stage::LoadDestination);
+        if format.is_bgra() {
+            self.stages.push(Stage::SwapRbDestination);
+        }
+
+        if !format.is_premultiplied() {
+            self.stages.push(Stage::PremultiplyDestination);
+        }
+    }
+
+    /// Pushes a conversion into the `format`, followed by the store.
+    pub fn push_store(&mut self, format: PixelFormat) {
+        if !format.is_premultiplied() {
+            self.stages.push(Stage::Unpremultiply);
+        }
+
+        if format.is_bgra() {
+            self.stages.push(Stage::SwapRb);
+        }
+
+        self.stages.push(Stage::Store);
+    }
+
     pub fn push_uniform_color(&mut self, c: PremultipliedColor) {
         let r = c.red();
         let g = c.green();
@@ -381,73 +428,98 @@ impl RasterPipelineBuilder {
     pub fn compile(self) -> RasterPipeline {
         if self.stages.is_empty() {
             return RasterPipeline {
-                kind: RasterPipelineKind::High {
+                kind: Program::Owned(RasterPipelineKind::High {
                     functions: ArrayVec::new(),
                     tail_functions: ArrayVec::new(),
-                },
+                }),
                 ctx: Context::default(),
             };
         }
 
-        let is_lowp_compatible = self.stages.iter()
-            .all(|stage| !lowp::fn_ptr_eq(lowp::STAGES[*stage as usize], lowp::null_fn));
-
-        if self.force_hq_pipeline || !is_lowp_compatible {
-            let mut functions: ArrayVec<_> = self.stages.iter()
-                .map(|stage| highp::STAGES[*stage as usize] as highp::StageFn)
-                .collect();
-            functions.push(highp::just_return as highp::StageFn);
-
-            // I wasn't able to reproduce Skia's load_8888_/store_8888_ performance.
-            // Skia uses fallthrough switch, which is probably the reason.
-            // In Rust, any branching in load/store code drastically affects the performance.
-            // So instead, we're using two "programs": one for "full stages" and one for "tail stages".
-            // While the only difference is the load/store methods.
-            let mut tail_functions = functions.clone();
-            for fun in &mut tail_functions {
-                if highp::fn_ptr(*fun) == highp::fn_ptr(highp::load_dst) {
-                    *fun = highp::load_dst_tail as highp::StageFn;
-                } else if highp::fn_ptr(*fun) == highp::fn_ptr(highp::store) {
-                    *fun = highp::store_tail as highp::StageFn;
-                } else if highp::fn_ptr(*fun) == highp::fn_ptr(highp::source_over_rgba) {
-                    // SourceOverRgba calls load/store manually, without the pipeline,
-                    // therefore we have to switch it too.
-                    *fun = highp::source_over_rgba_tail as highp::StageFn;
-                }
-            }
+        let kind = compile_cached(&self.stages, self.force_hq_pipeline);
 
-            RasterPipeline {
-                kind: RasterPipelineKind::High { functions, tail_functions },
-                ctx: self.ctx,
-            }
-        } else {
-            let mut functions: ArrayVec<_> = self.stages.iter()
-                .map(|stage| lowp::STAGES[*stage as usize] as lowp::StageFn)
-                .collect();
-            functions.push(lowp::just_return as lowp::StageFn);
-
-            // See above.
-            let mut tail_functions = functions.clone();
-            for fun in &mut tail_functions {
-                if lowp::fn_ptr(*fun) == lowp::fn_ptr(lowp::load_dst) {
-                    *fun = lowp::load_dst_tail as lowp::StageFn;
-                } else if lowp::fn_ptr(*fun) == lowp::fn_ptr(lowp::store) {
-                    *fun = lowp::store_tail as lowp::StageFn;
-                } else if lowp::fn_ptr(*fun) == lowp::fn_ptr(lowp::source_over_rgba) {
-                    // SourceOverRgba calls load/store manually, without the pipeline,
-                    // therefore we have to switch it too.
-                    *fun = lowp::source_over_rgba_tail as lowp::StageFn;
-                }
+        match *kind {
+            RasterPipelineKind::High { .. } => { count!(HIGHP_PIPELINES); }
+            RasterPipelineKind::Low { .. } => { count!(LOWP_PIPELINES); }
+        }
+        count!(PIPELINE_STAGES, self.stages.len());
+
+        RasterPipeline {
+            kind,
+            ctx: self.ctx,
+        }
+    }
+}
+
+#[cfg(feature = "std")]
+fn compile_cached(stages: &[Stage], force_hq_pipeline: bool) -> Program {
+    cache::get_or_compile(stages, force_hq_pipeline, || compile_kind(stages, force_hq_pipeline))
+}
+
+#[cfg(not(feature = "std"))]
+fn compile_cached(stages: &[Stage], force_hq_pipeline: bool) -> Program {
+    // There is no cache to share a program with, so there is no need to allocate it.
+    Program::Owned(compile_kind(stages, force_hq_pipeline))
+}
+
+fn compile_kind(stages: &[Stage], force_hq_pipeline: bool) -> RasterPipelineKind {
+    count!(COMPILED_PIPELINES);
+
+    let is_lowp_compatible = stages.iter()
+        .all(|stage| !lowp::fn_ptr_eq(lowp::STAGES[*stage as usize], lowp::null_fn));
+
+    if force_hq_pipeline || !is_lowp_compatible {
+        let mut functions: ArrayVec<_> = stages.iter()
+            .map(|stage| highp::STAGES[*stage as usize] as highp::StageFn)
+            .collect();
+        functions.push(highp::just_return as highp::StageFn);
+
+        // I wasn't able to reproduce Skia's load_8888_/store_8888_ performance.
+        // Skia uses fallthrough switch, which is probably the reason.
+        // In Rust, any branching in load/store code drastically affects the performance.
+        // So instead, we're using two "programs": one for "full stages" and one for "tail stages".
+        // While the only difference is the load/store methods.
+        let mut tail_functions = functions.clone();
+        for fun in &mut tail_functions {
+            if highp::fn_ptr(*fun) == highp::fn_ptr(highp::load_dst) {
+                *fun = highp::load_dst_tail as highp::StageFn;
+            } else if highp::fn_ptr(*fun) == highp::fn_ptr(highp::store) {
+                *fun = highp::store_tail as highp::StageFn;
+            } else if highp::fn_ptr(*fun) == highp::fn_ptr(highp::source_over_rgba) {
+                // SourceOverRgba calls load/store manually, without the pipeline,
+                // therefore we have to switch it too.
+                *fun = highp::source_over_rgba_tail as highp::StageFn;
             }
+        }
 
-            RasterPipeline {
-                kind: RasterPipelineKind::Low { functions, tail_functions },
-                ctx: self.ctx,
+        RasterPipelineKind::High { functions, tail_functions }
+    } else {
+        let mut functions: ArrayVec<_> = stages.iter()
+            .map(|stage| lowp::STAGES[*stage as usize] as lowp::StageFn)
+            .collect();
+        functions.push(lowp::just_return as lowp::StageFn);
+
+        // See above.
+        let mut tail_functions = functions.clone();
+        for fun in &mut tail_functions {
+            if lowp::fn_ptr(*fun) == lowp::fn_ptr(lowp::load_dst) {
+                *fun = lowp::load_dst_tail as lowp::StageFn;
+            } else if lowp::fn_ptr(*fun) == lowp::fn_ptr(lowp::store) {
+                *fun = lowp::store_tail as lowp::StageFn;
+            } else if lowp::fn_ptr(*fun) == lowp::fn_ptr(lowp::source_over_rgba) {
+                // SourceOverRgba calls load/store manually, without the pipeline,
+                // therefore we have to switch it too.
+                *fun = lowp::source_over_rgba_tail as lowp::StageFn;
             }
         }
+
+        RasterPipelineKind::Low { functions, tail_functions }
     }
 }
 
+/// A compiled pipeline program.
+///
+/// Programs are immutable and can be shared between pipelines with different contexts.
 pub enum RasterPipelineKind {
     High {
         functions: ArrayVec<[highp::StageFn; MAX_STAGES]>,
@@ -459,8 +531,27 @@ pub enum RasterPipelineKind {
     },
 }
 
+/// A compiled program, which is either owned by a pipeline or shared with the cache.
+enum Program {
+    Owned(RasterPipelineKind),
+    #[cfg(feature = "std")]
+    Shared(Rc<RasterPipelineKind>),
+}
+
+impl core::ops::Deref for Program {
+    type Target = RasterPipelineKind;
+
+    fn deref(&self) -> &Self::Target {
+        match self {
+            Program::Owned(ref kind) => kind,
+            #[cfg(feature = "std")]
+            Program::Shared(ref kind) => kind,
+        }
+    }
+}
+
 pub struct RasterPipeline {
-    kind: RasterPipelineKind,
+    kind: Program,
     pub ctx: Context,
 }
 
@@ -473,7 +564,7 @@ impl RasterPipeline {
         pixmap_src: PixmapRef,
         pixmap_dst: &mut PixmapMut,
     ) {
-        match self.kind {
+        match *self.kind {
             RasterPipelineKind::High { ref functions, ref tail_functions } => {
                 highp::start(
                     functions.as_slice(),
@@ -494,7 +585,7 @@ impl RasterPipeline {
                     mask_ctx,
                     clip_mask_ctx,
                     &mut self.ctx,
-                    // lowp doesn't support pattern, so no `pixmap_src` for it.
+                    pixmap_src,
                     pixmap_dst,
                 );
             }
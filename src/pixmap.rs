@@ -12,9 +12,9 @@ use alloc::vec::Vec;
 use core::convert::TryFrom;
 use core::num::NonZeroUsize;
 
-use crate::{Color, IntRect};
+use crate::{Color, DirtyRegion, IntRect};
 
-use crate::color::PremultipliedColorU8;
+use crate::color::{ColorU8, PremultipliedColorU8};
 use crate::geom::{IntSize, ScreenIntRect};
 
 #[cfg(feature = "png-format")]
@@ -24,6 +24,146 @@ use crate::color::{premultiply_u8, ALPHA_U8_OPAQUE};
 pub const BYTES_PER_PIXEL: usize = 4;
 
 
+/// A pixels storage format of a `PixmapMut`.
+///
+/// Rendering is always done using premultiplied colors. Other formats are converted
+/// into during the pipeline store and back during the destination load,
+/// so no separate conversion pass is needed.
+///
+/// Non-premultiplied pixels lose some precision after each blending,
+/// since they are premultiplied and demultiplied again. Prefer them only
+/// for the final compositing. They are also always rendered using the high precision
+/// pipeline, which is slower, because only it can demultiply.
+///
+/// Pixels are converted into premultiplied RGBA on access, like in `PixmapRef::pixel`,
+/// while slices of premultiplied pixels are not available for other formats.
+#[derive(Copy, Clone, PartialEq, Eq, Debug)]
+pub enum PixelFormat {
+    /// Premultiplied RGBA. The default one.
+    RgbaPremultiplied,
+    /// Premultiplied BGRA.
+    BgraPremultiplied,
+    /// Non-premultiplied RGBA.
+    RgbaUnpremultiplied,
+    /// Non-premultiplied BGRA.
+    BgraUnpremultiplied,
+}
+
+impl Default for PixelFormat {
+    fn default() -> Self {
+        PixelFormat::RgbaPremultiplied
+    }
+}
+
+impl PixelFormat {
+    #[inline]
+    pub(crate) fn is_bgra(self) -> bool {
+        self == PixelFormat::BgraPremultiplied || self == PixelFormat::BgraUnpremultiplied
+    }
+
+    #[inline]
+    pub(crate) fn is_premultiplied(self) -> bool {
+        self == PixelFormat::RgbaPremultiplied || self == PixelFormat::BgraPremultiplied
+    }
+
+    /// Converts a color into this format.
+    pub(crate) fn pack_color(self, color: Color) -> PremultipliedColorU8 {
+        self.pack(color.premultiply().to_color_u8())
+    }
+
+    /// Converts a premultiplied RGBA pixel into this format.
+    ///
+    /// The result is a storage value, which is premultiplied RGBA only
+    /// in the default format. It must never leave the crate as is.
+    #[inline]
+    pub(crate) fn pack(self, c: PremultipliedColorU8) -> PremultipliedColorU8 {
+        let (r, g, b, a) = if self.is_premultiplied() {
+            (c.red(), c.green(), c.blue(), c.alpha())
+        } else {
+            let c = c.demultiply();
+            (c.red(), c.green(), c.blue(), c.alpha())
+        };
+
+        if self.is_bgra() {
+            PremultipliedColorU8::from_rgba_unchecked(b, g, r, a)
+        } else {
+            PremultipliedColorU8::from_rgba_unchecked(r, g, b, a)
+        }
+    }
+
+    /// Converts a storage value in this format back into a premultiplied RGBA pixel.
+    #[inline]
+    pub(crate) fn unpack(self, c: PremultipliedColorU8) -> PremultipliedColorU8 {
+        let c = self.swizzle(c);
+        if self.is_premultiplied() {
+            PremultipliedColorU8::from_rgba_unchecked(c.red(), c.green(), c.blue(), c.alpha())
+        } else {
+            c.premultiply()
+        }
+    }
+
+    /// Reorders a storage value in this format into RGBA, keeping its premultiplication.
+    #[inline]
+    fn swizzle(self, c: PremultipliedColorU8) -> ColorU8 {
+        let (r, g, b, a) = if self.is_bgra() {
+            (c.blue(), c.green(), c.red(), c.alpha())
+        } else {
+            (c.red(), c.green(), c.blue(), c.alpha())
+        };
+
+        ColorU8::from_rgba(r, g, b, a)
+    }
+
+    /// Converts a storage value in this format into a demultiplied RGBA pixel.
+    #[cfg(feature = "png-format")]
+    #[inline]
+    fn to_color_u8(self, c: PremultipliedColorU8) -> ColorU8 {
+        if self.is_premultiplied() {
+            self.unpack(c).demultiply()
+        } else {
+            self.swizzle(c)
+        }
+    }
+}
+
+
+/// PNG encoding options.
+#[cfg(feature = "png-format")]
+#[derive(Copy, Clone, Debug)]
+pub struct PngEncodeOptions {
+    /// Compression level.
+    ///
+    /// Default: `png::Compression::Default`
+    pub compression: png::Compression,
+
+    /// Rows filter.
+    ///
+    /// Default: `png::FilterType::Sub`
+    pub filter: png::FilterType,
+}
+
+#[cfg(feature = "png-format")]
+impl Default for PngEncodeOptions {
+    fn default() -> Self {
+        PngEncodeOptions {
+            compression: png::Compression::Default,
+            filter: png::FilterType::Sub,
+        }
+    }
+}
+
+#[cfg(feature = "png-format")]
+impl PngEncodeOptions {
+    /// Returns options that prefer encoding speed over the file size.
+    pub fn fast() -> Self {
+        PngEncodeOptions {
+            compression: png::Compression::Fast,
+            filter: png::FilterType::Sub,
+        }
+    }
+}
+
+
 /// A container that owns premultiplied RGBA pixels.
 ///
 /// The data is not aligned, therefore width == stride.
@@ -76,78 +216,15 @@ impl Pixmap {
         let decoder = png::Decoder::new(data);
         let (info, mut reader) = decoder.read_info()?;
 
-        if info.bit_depth != png::BitDepth::Eight {
-            return Err(png::DecodingError::from("unsupported bit depth".to_string()));
-        }
-
         let size = IntSize::from_wh(info.width, info.height)
             .ok_or_else(|| png::DecodingError::from("invalid image size".to_string()))?;
         let data_len = data_len_for_size(size)
             .ok_or_else(|| png::DecodingError::from("image is too big".to_string()))?;
 
-        let mut img_data = vec![0; info.buffer_size()];
-        reader.next_frame(&mut img_data)?;
-
-        img_data = match info.color_type {
-            png::ColorType::RGB => {
-                let mut rgba_data = Vec::with_capacity(data_len);
-                for rgb in img_data.chunks(3) {
-                    rgba_data.push(rgb[0]);
-                    rgba_data.push(rgb[1]);
-                    rgba_data.push(rgb[2]);
-                    rgba_data.push(ALPHA_U8_OPAQUE);
-                }
-
-                rgba_data
-            }
-            png::ColorType::RGBA => {
-                img_data
-            }
-            png::ColorType::Grayscale => {
-                let mut rgba_data = Vec::with_capacity(data_len);
-                for gray in img_data {
-                    rgba_data.push(gray);
-                    rgba_data.push(gray);
-                    rgba_data.push(gray);
-                    rgba_data.push(ALPHA_U8_OPAQUE);
-                }
-
-                rgba_data
-            }
-            png::ColorType::GrayscaleAlpha => {
-                let mut rgba_data = Vec::with_capacity(data_len);
-                for slice in img_data.chunks(2) {
-                    let gray = slice[0];
-                    let alpha = slice[1];
-                    rgba_data.push(gray);
-                    rgba_data.push(gray);
-                    rgba_data.push(gray);
-                    rgba_data.push(alpha);
-                }
-
-                rgba_data
-            }
-            png::ColorType::Indexed => {
-                return Err(png::DecodingError::from("indexed PNG is not supported".to_string()));
-            }
-        };
+        let mut data = vec![0; data_len];
+        decode_png_frame(&info, &mut reader, size.width() as usize * BYTES_PER_PIXEL, &mut data)?;
 
-        // Premultiply alpha.
-        //
-        // We cannon use RasterPipeline here, which is faster,
-        // because it produces slightly different results.
-        // Seems like Skia does the same.
-        //
-        // Also, in our tests unsafe version (no bound checking)
-        // had roughly the same performance. So we keep the safe one.
-        for pixel in img_data.as_mut_slice().chunks_mut(BYTES_PER_PIXEL) {
-            let a = pixel[3];
-            pixel[0] = premultiply_u8(pixel[0], a);
-            pixel[1] = premultiply_u8(pixel[1], a);
-            pixel[2] = premultiply_u8(pixel[2], a);
-        }
-
-        Pixmap::from_vec(img_data, size)
+        Pixmap::from_vec(data, size)
             .ok_or_else(|| png::DecodingError::from("failed to create a pixmap".to_string()))
     }
 
@@ -170,6 +247,24 @@ impl Pixmap {
         self.as_ref().encode_png()
     }
 
+    /// Encodes pixmap into a PNG data using the specified options.
+    #[cfg(feature = "png-format")]
+    pub fn encode_png_with(&self, options: &PngEncodeOptions) -> Result<Vec<u8>, png::EncodingError> {
+        self.as_ref().encode_png_with(options)
+    }
+
+    /// Encodes pixmap into a PNG data and writes it into the `writer`.
+    ///
+    /// See [`PixmapRef::write_png`](struct.PixmapRef.html#method.write_png) for details.
+    #[cfg(feature = "png-format")]
+    pub fn write_png<W: std::io::Write>(
+        &self,
+        writer: W,
+        options: &PngEncodeOptions,
+    ) -> Result<(), png::EncodingError> {
+        self.as_ref().write_png(writer, options)
+    }
+
     /// Saves pixmap as a PNG file.
     #[cfg(feature = "png-format")]
     pub fn save_png<P: AsRef<std::path::Path>>(&self, path: P) -> Result<(), png::EncodingError> {
@@ -181,6 +276,8 @@ impl Pixmap {
         PixmapRef {
             data: &self.data,
             size: self.size,
+            stride: self.size.width() as usize,
+            format: PixelFormat::default(),
         }
     }
 
@@ -189,6 +286,9 @@ impl Pixmap {
         PixmapMut {
             data: &mut self.data,
             size: self.size,
+            stride: self.size.width() as usize,
+            format: PixelFormat::default(),
+            dirty_region: None,
         }
     }
 
@@ -213,7 +313,7 @@ impl Pixmap {
     /// Fills the entire pixmap with a specified color.
     pub fn fill(&mut self, color: Color) {
         let c = color.premultiply().to_color_u8();
-        for p in self.as_mut().pixels_mut() {
+        for p in self.pixels_mut() {
             *p = c;
         }
     }
@@ -257,6 +357,13 @@ impl Pixmap {
         self.data
     }
 
+    /// Converts pixels copied from a pixmap in `format` into premultiplied RGBA.
+    fn unpack(&mut self, format: PixelFormat) {
+        if format != PixelFormat::default() {
+            self.pixels_mut().iter_mut().for_each(|p| *p = format.unpack(*p));
+        }
+    }
+
     /// Returns a copy of the pixmap that intersects the `rect`.
     ///
     /// Returns `None` when `Pixmap`'s rect doesn't contain `rect`.
@@ -280,14 +387,38 @@ impl core::fmt::Debug for Pixmap {
 ///
 /// Can be created from `Pixmap` or from a user provided data.
 ///
-/// The data is not aligned, therefore width == stride.
-#[derive(Clone, Copy, PartialEq)]
+/// Rows can be padded, see [`from_bytes_with_stride`](#method.from_bytes_with_stride).
+#[derive(Clone, Copy)]
 pub struct PixmapRef<'a> {
     data: &'a [u8],
     size: IntSize,
+    /// Row length in pixels.
+    stride: usize,
+    /// Set only when referencing a `PixmapMut` with a non-default format.
+    format: PixelFormat,
+}
+
+// Rows padding is not a part of the image, so it's ignored.
+impl PartialEq for PixmapRef<'_> {
+    fn eq(&self, other: &Self) -> bool {
+        let row_len = self.width() as usize * BYTES_PER_PIXEL;
+        self.size == other.size && self.format == other.format
+            && self.data.chunks(self.row_bytes())
+            .zip(other.data.chunks(other.row_bytes()))
+            .take(self.height() as usize)
+            .all(|(a, b)| a[..row_len] == b[..row_len])
+    }
 }
 
 impl<'a> PixmapRef<'a> {
+    /// Checks that pixmaps reference the same data in the same way.
+    pub(crate) fn ptr_eq(&self, other: &Self) -> bool {
+        core::ptr::eq(self.data, other.data)
+            && self.size == other.size
+            && self.stride == other.stride
+            && self.format == other.format
+    }
+
     /// Creates a new `PixmapRef` from bytes.
     ///
     /// The size must be at least `size.width() * size.height() * BYTES_PER_PIXEL`.
@@ -296,7 +427,25 @@ impl<'a> PixmapRef<'a> {
     /// The `data` is assumed to have premultiplied RGBA pixels (byteorder: RGBA).
     pub fn from_bytes(data: &'a [u8], width: u32, height: u32) -> Option<Self> {
         let size = IntSize::from_wh(width, height)?;
-        let data_len = data_len_for_size(size)?;
+        let row_bytes = min_row_bytes(size)?.get();
+        Self::from_bytes_with_stride(data, width, height, row_bytes)
+    }
+
+    /// Creates a new `PixmapRef` from bytes with padded rows.
+    ///
+    /// `row_bytes` is the distance between rows in bytes. It must be a multiple of
+    /// `BYTES_PER_PIXEL` and at least `width * BYTES_PER_PIXEL`.
+    /// The last row doesn't have to be padded.
+    ///
+    /// Useful for framebuffers and video frames, which are rarely tightly packed.
+    pub fn from_bytes_with_stride(
+        data: &'a [u8],
+        width: u32,
+        height: u32,
+        row_bytes: usize,
+    ) -> Option<Self> {
+        let size = IntSize::from_wh(width, height)?;
+        let data_len = data_len_for_stride(size, row_bytes)?;
         if data.len() < data_len {
             return None;
         }
@@ -304,17 +453,36 @@ impl<'a> PixmapRef<'a> {
         Some(PixmapRef {
             data,
             size,
+            stride: row_bytes / BYTES_PER_PIXEL,
+            format: PixelFormat::default(),
         })
     }
 
     /// Creates a new `Pixmap` from the current data.
     ///
-    /// Clones the underlying data.
+    /// Clones the underlying data. Rows padding is removed
+    /// and pixels are converted into premultiplied RGBA.
     pub fn to_owned(&self) -> Pixmap {
-        Pixmap {
-            data: self.data.to_vec(),
-            size: self.size,
-        }
+        let mut pixmap = if self.is_packed() {
+            Pixmap {
+                data: self.data.to_vec(),
+                size: self.size,
+            }
+        } else {
+            let width = self.width() as usize;
+            let mut data = Vec::with_capacity(width * self.height() as usize * BYTES_PER_PIXEL);
+            for y in 0..self.height() {
+                data.extend_from_slice(bytemuck::cast_slice(self.row(y)));
+            }
+
+            Pixmap {
+                data,
+                size: self.size,
+            }
+        };
+
+        pixmap.unpack(self.format);
+        pixmap
     }
 
     /// Returns pixmap's width.
@@ -339,8 +507,27 @@ impl<'a> PixmapRef<'a> {
         self.size.to_screen_int_rect(0, 0)
     }
 
+    /// Returns the distance between rows in bytes.
+    pub fn row_bytes(&self) -> usize {
+        self.stride * BYTES_PER_PIXEL
+    }
+
+    /// Returns the distance between rows in pixels.
+    #[inline]
+    pub(crate) fn stride(&self) -> usize {
+        self.stride
+    }
+
+    /// Checks that rows are not padded.
+    #[inline]
+    fn is_packed(&self) -> bool {
+        self.stride == self.width() as usize
+    }
+
     /// Returns the internal data.
     ///
+    /// Includes rows padding, if any.
+    ///
     /// Byteorder: RGBA
     pub fn data(&self) -> &'a [u8] {
         self.data
@@ -348,17 +535,56 @@ impl<'a> PixmapRef<'a> {
 
     /// Returns a pixel color.
     ///
+    /// The pixel is converted into premultiplied RGBA, when referencing
+    /// a `PixmapMut` with a different format.
+    ///
     /// Returns `None` when position is out of bounds.
     pub fn pixel(&self, x: u32, y: u32) -> Option<PremultipliedColorU8> {
-        let idx = self.width().checked_mul(y)?.checked_add(x)?;
-        self.pixels().get(idx as usize).cloned()
+        if x >= self.width() || y >= self.height() {
+            return None;
+        }
+
+        let c = self.storage().get(self.stride * y as usize + x as usize).cloned()?;
+        Some(self.format.unpack(c))
     }
 
     /// Returns a slice of pixels.
+    ///
+    /// Includes rows padding, if any. A row `y` starts at `y * row_bytes() / BYTES_PER_PIXEL`.
+    ///
+    /// When referencing a `PixmapMut` with a format other than `PixelFormat::RgbaPremultiplied`,
+    /// pixels are returned as stored, in that format. Use `try_pixels` to check it.
     pub fn pixels(&self) -> &'a [PremultipliedColorU8] {
+        self.storage()
+    }
+
+    /// Returns a slice of pixels.
+    ///
+    /// Same as `pixels`, but returns `None` when referencing a `PixmapMut`
+    /// with a format other than `PixelFormat::RgbaPremultiplied`.
+    pub fn try_pixels(&self) -> Option<&'a [PremultipliedColorU8]> {
+        if self.format == PixelFormat::default() {
+            Some(self.storage())
+        } else {
+            None
+        }
+    }
+
+    /// Returns stored pixels, which are premultiplied RGBA only in the default format.
+    #[inline]
+    pub(crate) fn storage(&self) -> &'a [PremultipliedColorU8] {
         bytemuck::cast_slice(self.data())
     }
 
+    /// Returns pixels of a single row, without padding.
+    ///
+    /// `y` must be smaller than height.
+    #[inline]
+    pub(crate) fn row(&self, y: u32) -> &'a [PremultipliedColorU8] {
+        let start = self.stride * y as usize;
+        &self.storage()[start..start + self.width() as usize]
+    }
+
     // TODO: add rows() iterator
 
     /// Returns a copy of the pixmap that intersects the `rect`.
@@ -370,60 +596,112 @@ impl<'a> PixmapRef<'a> {
         let rect = self.rect().to_int_rect().intersect(&rect)?;
         let mut new = Pixmap::new(rect.width(), rect.height())?;
         {
-            let old_pixels = self.pixels();
-            let mut new_mut = new.as_mut();
-            let new_pixels = new_mut.pixels_mut();
+            let old_pixels = self.storage();
+            let new_pixels = new.pixels_mut();
 
             // TODO: optimize
             for y in 0..rect.height() {
                 for x in 0..rect.width() {
-                    let old_idx = (y + rect.y() as u32) * self.width() + (x + rect.x() as u32);
+                    let old_idx = (y + rect.y() as u32) as usize * self.stride
+                        + (x + rect.x() as u32) as usize;
                     let new_idx = y * rect.width() + x;
-                    new_pixels[new_idx as usize] = old_pixels[old_idx as usize];
+                    new_pixels[new_idx as usize] = old_pixels[old_idx];
                 }
             }
         }
 
+        new.unpack(self.format);
         Some(new)
     }
 
     /// Encodes pixmap into a PNG data.
     #[cfg(feature = "png-format")]
     pub fn encode_png(&self) -> Result<Vec<u8>, png::EncodingError> {
-        // Skia uses skcms here, which is somewhat similar to RasterPipeline.
+        self.encode_png_with(&PngEncodeOptions::default())
+    }
 
-        // Sadly, we have to copy the pixmap here.
-        // Not sure how to avoid this.
-        // TODO: remove allocation
-        let mut tmp_pixmap = self.to_owned();
+    /// Encodes pixmap into a PNG data using the specified options.
+    #[cfg(feature = "png-format")]
+    pub fn encode_png_with(&self, options: &PngEncodeOptions) -> Result<Vec<u8>, png::EncodingError> {
+        let mut data = Vec::new();
+        self.write_png_impl(&mut data, options)?;
+        Ok(data)
+    }
 
-        // Demultiply alpha.
-        //
-        // RasterPipeline is 15% faster here, but produces slightly different results
-        // due to rounding. So we stick with this method for now.
-        for pixel in tmp_pixmap.pixels_mut() {
-            let c = pixel.demultiply();
-            *pixel = PremultipliedColorU8::from_rgba_unchecked(
-                c.red(), c.green(), c.blue(), c.alpha());
-        }
+    /// Encodes pixmap into a PNG data and writes it into the `writer`.
+    ///
+    /// The data is demultiplied and compressed in small batches of rows,
+    /// so no pixmap sized allocations are made.
+    #[cfg(feature = "png-format")]
+    pub fn write_png<W: std::io::Write>(
+        &self,
+        mut writer: W,
+        options: &PngEncodeOptions,
+    ) -> Result<(), png::EncodingError> {
+        self.write_png_impl(&mut writer, options)
+    }
 
-        let mut data = Vec::new();
-        {
-            let mut encoder = png::Encoder::new(&mut data, self.width(), self.height());
-            encoder.set_color(png::ColorType::RGBA);
-            encoder.set_depth(png::BitDepth::Eight);
-            let mut writer = encoder.write_header()?;
-            writer.write_image_data(&tmp_pixmap.data)?;
+    // `png::Encoder` is generic over output, so we're using only one type
+    // to prevent code bloat.
+    #[cfg(feature = "png-format")]
+    fn write_png_impl(
+        &self,
+        writer: &mut dyn std::io::Write,
+        options: &PngEncodeOptions,
+    ) -> Result<(), png::EncodingError> {
+        use std::io::Write;
+
+        // How many bytes to demultiply at once.
+        const BATCH_SIZE: usize = 64 * 1024;
+
+        let mut encoder = png::Encoder::new(writer, self.width(), self.height());
+        encoder.set_color(png::ColorType::RGBA);
+        encoder.set_depth(png::BitDepth::Eight);
+        encoder.set_compression(options.compression);
+        encoder.set_filter(options.filter);
+        let mut writer = encoder.write_header()?;
+
+        let height = self.height();
+        let row_len = self.width() as usize * BYTES_PER_PIXEL;
+        // Always use whole rows, since this is what the encoder processes.
+        let batch_rows = (BATCH_SIZE / row_len).max(1).min(height as usize) as u32;
+        let mut batch = vec![0; batch_rows as usize * row_len];
+
+        let mut stream = writer.stream_writer();
+        for top in (0..height).step_by(batch_rows as usize) {
+            let rows = batch_rows.min(height - top);
+            let batch = &mut batch[..rows as usize * row_len];
+
+            // Demultiply alpha.
+            //
+            // Skia uses skcms here, which is somewhat similar to RasterPipeline.
+            // RasterPipeline is 15% faster here, but produces slightly different results
+            // due to rounding. So we stick with this method for now.
+            for (y, batch_row) in (top..top + rows).zip(batch.chunks_exact_mut(row_len)) {
+                let row = self.row(y);
+                for (pixel, rgba) in row.iter().zip(batch_row.chunks_exact_mut(BYTES_PER_PIXEL)) {
+                    let c = self.format.to_color_u8(*pixel);
+                    rgba[0] = c.red();
+                    rgba[1] = c.green();
+                    rgba[2] = c.blue();
+                    rgba[3] = c.alpha();
+                }
+            }
+
+            stream.write_all(batch)?;
         }
 
-        Ok(data)
+        stream.finish()
     }
 
     /// Saves pixmap as a PNG file.
     #[cfg(feature = "png-format")]
     pub fn save_png<P: AsRef<std::path::Path>>(&self, path: P) -> Result<(), png::EncodingError> {
-        let data = self.encode_png()?;
-        std::fs::write(path, data)?;
+        use std::io::Write;
+
+        let mut writer = std::io::BufWriter::new(std::fs::File::create(path)?);
+        self.write_png_impl(&mut writer, &PngEncodeOptions::default())?;
+        writer.flush()?;
         Ok(())
     }
 }
@@ -443,11 +721,20 @@ impl core::fmt::Debug for PixmapRef<'_> {
 ///
 /// Can be created from `Pixmap` or from a user provided data.
 ///
-/// The data is not aligned, therefore width == stride.
-#[derive(PartialEq)]
+/// Rows can be padded, see [`from_bytes_with_stride`](#method.from_bytes_with_stride).
 pub struct PixmapMut<'a> {
     data: &'a mut [u8],
     size: IntSize,
+    /// Row length in pixels.
+    stride: usize,
+    format: PixelFormat,
+    dirty_region: Option<&'a mut DirtyRegion>,
+}
+
+impl PartialEq for PixmapMut<'_> {
+    fn eq(&self, other: &Self) -> bool {
+        self.as_ref() == other.as_ref()
+    }
 }
 
 impl<'a> PixmapMut<'a> {
@@ -459,7 +746,26 @@ impl<'a> PixmapMut<'a> {
     /// The `data` is assumed to have premultiplied RGBA pixels (byteorder: RGBA).
     pub fn from_bytes(data: &'a mut [u8], width: u32, height: u32) -> Option<Self> {
         let size = IntSize::from_wh(width, height)?;
-        let data_len = data_len_for_size(size)?;
+        let row_bytes = min_row_bytes(size)?.get();
+        Self::from_bytes_with_stride(data, width, height, row_bytes)
+    }
+
+    /// Creates a new `PixmapMut` from bytes with padded rows.
+    ///
+    /// `row_bytes` is the distance between rows in bytes. It must be a multiple of
+    /// `BYTES_PER_PIXEL` and at least `width * BYTES_PER_PIXEL`.
+    /// The last row doesn't have to be padded.
+    ///
+    /// Allows rendering right into a framebuffer or a staging buffer with padded rows.
+    /// Padding bytes are never touched by drawing.
+    pub fn from_bytes_with_stride(
+        data: &'a mut [u8],
+        width: u32,
+        height: u32,
+        row_bytes: usize,
+    ) -> Option<Self> {
+        let size = IntSize::from_wh(width, height)?;
+        let data_len = data_len_for_stride(size, row_bytes)?;
         if data.len() < data_len {
             return None;
         }
@@ -467,17 +773,105 @@ impl<'a> PixmapMut<'a> {
         Some(PixmapMut {
             data,
             size,
+            stride: row_bytes / BYTES_PER_PIXEL,
+            format: PixelFormat::default(),
+            dirty_region: None,
+        })
+    }
+
+    /// Sets the pixels storage format.
+    ///
+    /// All drawing onto the returned pixmap reads and writes pixels in `format`.
+    /// The current data is not converted and must already be in this format.
+    ///
+    /// Methods that interpret pixels outside of drawing, like `PixmapRef::encode_png`
+    /// or using the pixmap as a `Pattern`, expect premultiplied RGBA.
+    pub fn with_format(self, format: PixelFormat) -> Self {
+        PixmapMut {
+            format,
+            ..self
+        }
+    }
+
+    /// Returns the pixels storage format.
+    pub fn format(&self) -> PixelFormat {
+        self.format
+    }
+
+    /// Enables changed pixels tracking.
+    ///
+    /// All drawing onto the returned pixmap marks the touched areas in `region`.
+    /// See `DirtyRegion` for details.
+    ///
+    /// Returns `None` when `region` size is not the same as the pixmap one.
+    pub fn with_dirty_region(self, region: &'a mut DirtyRegion) -> Option<Self> {
+        if region.width() != self.width() || region.height() != self.height() {
+            return None;
+        }
+
+        Some(PixmapMut {
+            dirty_region: Some(region),
+            ..self
         })
     }
 
+    /// Marks an area as changed, when the tracking is enabled.
+    #[inline]
+    pub(crate) fn mark_dirty(&mut self, rect: &ScreenIntRect) {
+        if let Some(ref mut region) = self.dirty_region {
+            region.add_screen_rect(rect);
+        }
+    }
+
+    /// Decodes a PNG data into the current pixmap.
+    ///
+    /// Unlike [`Pixmap::decode_png`](struct.Pixmap.html#method.decode_png),
+    /// doesn't allocate a new pixmap. Useful for reusing preallocated buffers.
+    ///
+    /// The image size must be equal to the pixmap size.
+    /// Pixels are converted into the pixmap format.
+    /// In case of an error, the pixmap content is unspecified.
+    ///
+    /// Only 8-bit images are supported.
+    /// Index PNGs are not supported.
+    #[cfg(feature = "png-format")]
+    pub fn decode_png_into(&mut self, data: &[u8]) -> Result<(), png::DecodingError> {
+        let decoder = png::Decoder::new(data);
+        let (info, mut reader) = decoder.read_info()?;
+
+        if info.width != self.width() || info.height != self.height() {
+            return Err(png::DecodingError::from("image size doesn't match pixmap size".to_string()));
+        }
+
+        if let Some(ref mut region) = self.dirty_region {
+            region.add_all();
+        }
+
+        // Cannot overflow, since already checked by the constructor.
+        // The last row may be not padded.
+        let row_bytes = self.row_bytes();
+        let data_len = (self.height() as usize - 1) * row_bytes
+            + self.width() as usize * BYTES_PER_PIXEL;
+        decode_png_frame(&info, &mut reader, row_bytes, &mut self.data[..data_len])?;
+
+        let format = self.format;
+        if format != PixelFormat::default() {
+            let width = self.width() as usize;
+            let height = self.height() as usize;
+            let stride = self.stride;
+            for row in self.storage_mut().chunks_mut(stride).take(height) {
+                row[..width].iter_mut().for_each(|p| *p = format.pack(*p));
+            }
+        }
+
+        Ok(())
+    }
+
     /// Creates a new `Pixmap` from the current data.
     ///
-    /// Clones the underlying data.
+    /// Clones the underlying data. Rows padding is removed.
     pub fn to_owned(&self) -> Pixmap {
-        Pixmap {
-            data: self.data.to_vec(),
-            size: self.size,
-        }
+        self.as_ref().to_owned()
     }
 
     /// Returns a container that references Pixmap's data.
@@ -485,6 +879,8 @@ impl<'a> PixmapMut<'a> {
         PixmapRef {
             data: &self.data,
             size: self.size,
+            stride: self.stride,
+            format: self.format,
         }
     }
 
@@ -505,23 +901,68 @@ impl<'a> PixmapMut<'a> {
         self.size
     }
 
+    /// Returns the distance between rows in bytes.
+    pub fn row_bytes(&self) -> usize {
+        self.stride * BYTES_PER_PIXEL
+    }
+
+    /// Returns the distance between rows in pixels.
+    #[inline]
+    pub(crate) fn stride(&self) -> usize {
+        self.stride
+    }
+
     /// Fills the entire pixmap with a specified color.
+    ///
+    /// Rows padding is not touched.
     pub fn fill(&mut self, color: Color) {
-        let c = color.premultiply().to_color_u8();
-        for p in self.pixels_mut() {
-            *p = c;
+        let c = self.format.pack_color(color);
+        let width = self.width() as usize;
+        let height = self.height() as usize;
+        let stride = self.stride;
+        for row in self.storage_mut().chunks_mut(stride).take(height) {
+            row[..width].iter_mut().for_each(|p| *p = c);
+        }
+
+        if let Some(ref mut region) = self.dirty_region {
+            region.add_all();
         }
     }
 
     /// Returns the mutable internal data.
     ///
+    /// Includes rows padding, if any.
+    ///
     /// Byteorder: RGBA
     pub fn data_mut(&mut self) -> &mut [u8] {
         self.data
     }
 
     /// Returns a mutable slice of pixels.
+    ///
+    /// Includes rows padding, if any.
+    ///
+    /// When the format is not `PixelFormat::RgbaPremultiplied`, pixels are returned as stored,
+    /// in that format. Use `try_pixels_mut` to check it.
     pub fn pixels_mut(&mut self) -> &mut [PremultipliedColorU8] {
+        self.storage_mut()
+    }
+
+    /// Returns a mutable slice of pixels.
+    ///
+    /// Same as `pixels_mut`, but returns `None` when the format is not
+    /// `PixelFormat::RgbaPremultiplied`.
+    pub fn try_pixels_mut(&mut self) -> Option<&mut [PremultipliedColorU8]> {
+        if self.format == PixelFormat::default() {
+            Some(self.storage_mut())
+        } else {
+            None
+        }
+    }
+
+    /// Returns stored pixels, which are premultiplied RGBA only in the default format.
+    #[inline]
+    pub(crate) fn storage_mut(&mut self) -> &mut [PremultipliedColorU8] {
         bytemuck::cast_slice_mut(self.data_mut())
     }
 }
@@ -546,6 +987,18 @@ fn min_row_bytes(size: IntSize) -> Option<NonZeroUsize> {
     NonZeroUsize::new(w as usize)
 }
 
+/// Returns storage size required by pixel array with the specified row bytes.
+///
+/// Like the minimum row bytes, stride must fit in 31 bits.
+fn data_len_for_stride(size: IntSize, row_bytes: usize) -> Option<usize> {
+    let min = min_row_bytes(size)?.get();
+    if row_bytes < min || row_bytes % BYTES_PER_PIXEL != 0 || row_bytes > i32::MAX as usize {
+        return None;
+    }
+
+    compute_data_len(size, row_bytes)
+}
+
 /// Returns storage size required by pixel array.
 fn compute_data_len(size: IntSize, row_bytes: usize) -> Option<usize> {
     let h = size.height().checked_sub(1)?;
@@ -556,6 +1009,123 @@ fn compute_data_len(size: IntSize, row_bytes: usize) -> Option<usize> {
     h.checked_add(w)
 }
 
+/// Decodes a PNG frame right into premultiplied RGBA `data`.
+///
+/// Rows are `row_bytes` apart, so `data` must be exactly
+/// `row_bytes * (height - 1) + width * 4` bytes long. Rows padding is not touched.
+/// Only 8-bit images are supported.
+/// Index PNGs are not supported.
+#[cfg(feature = "png-format")]
+fn decode_png_frame(
+    info: &png::OutputInfo,
+    reader: &mut png::Reader<&[u8]>,
+    row_bytes: usize,
+    data: &mut [u8],
+) -> Result<(), png::DecodingError> {
+    if info.bit_depth != png::BitDepth::Eight {
+        return Err(png::DecodingError::from("unsupported bit depth".to_string()));
+    }
+
+    if info.color_type == png::ColorType::Indexed {
+        return Err(png::DecodingError::from("indexed PNG is not supported".to_string()));
+    }
+
+    let width = info.width as usize;
+    let row_len = width * BYTES_PER_PIXEL;
+    debug_assert_eq!(data.len(), row_bytes * (info.height as usize - 1) + row_len);
+
+    if reader.info().interlaced && row_bytes != row_len {
+        // Interlaced rows are not sequential, so we have to decode the whole frame first.
+        // A decoded frame is not padded and would overwrite rows padding,
+        // so it's decoded into a separate buffer instead.
+        let mut frame = vec![0; info.buffer_size()];
+        reader.next_frame(&mut frame)?;
+
+        for (row, decoded) in data.chunks_mut(row_bytes).zip(frame.chunks(info.line_size)) {
+            expand_png_row(info.color_type, decoded, &mut row[..row_len]);
+        }
+    } else if reader.info().interlaced {
+        // Interlaced rows are not sequential, so we have to decode the whole frame first.
+        // To avoid an additional allocation, decode it right into the pixmap
+        // and then expand it in place. An RGBA row is never shorter than a decoded one,
+        // so by going from the end we will never overwrite not yet processed pixels.
+        reader.next_frame(data)?;
+
+        let samples = info.color_type.samples();
+        for y in (0..info.height as usize).rev() {
+            for x in (0..width).rev() {
+                let idx = y * info.line_size + x * samples;
+                let mut pixel = [0; BYTES_PER_PIXEL];
+                pixel[..samples].copy_from_slice(&data[idx..idx + samples]);
+
+                let idx = y * row_bytes + x * BYTES_PER_PIXEL;
+                expand_png_row(info.color_type, &pixel[..samples],
+                               &mut data[idx..idx + BYTES_PER_PIXEL]);
+            }
+        }
+    } else {
+        // Process the image row by row, so decoded data will stay in cache.
+        // Rows are written right into their place, even when they are padded.
+        for row in data.chunks_mut(row_bytes) {
+            let decoded = reader.next_row()?
+                .ok_or_else(|| png::DecodingError::from("not enough image data".to_string()))?;
+            expand_png_row(info.color_type, decoded, &mut row[..row_len]);
+        }
+    }
+
+    Ok(())
+}
+
+/// Converts a decoded PNG row into a premultiplied RGBA one.
+///
+/// We cannon use RasterPipeline here, which is faster,
+/// because it produces slightly different results.
+/// Seems like Skia does the same.
+#[cfg(feature = "png-format")]
+fn expand_png_row(color_type: png::ColorType, src: &[u8], dst: &mut [u8]) {
+    let dst = dst.chunks_exact_mut(BYTES_PER_PIXEL);
+    match color_type {
+        png::ColorType::RGB => {
+            for (pixel, rgb) in dst.zip(src.chunks_exact(3)) {
+                pixel[0] = rgb[0];
+                pixel[1] = rgb[1];
+                pixel[2] = rgb[2];
+                pixel[3] = ALPHA_U8_OPAQUE;
+            }
+        }
+        png::ColorType::RGBA => {
+            for (pixel, rgba) in dst.zip(src.chunks_exact(4)) {
+                let a = rgba[3];
+                pixel[0] = premultiply_u8(rgba[0], a);
+                pixel[1] = premultiply_u8(rgba[1], a);
+                pixel[2] = premultiply_u8(rgba[2], a);
+                pixel[3] = a;
+            }
+        }
+        png::ColorType::Grayscale => {
+            for (pixel, gray) in dst.zip(src.iter().copied()) {
+                pixel[0] = gray;
+                pixel[1] = gray;
+                pixel[2] = gray;
+                pixel[3] = ALPHA_U8_OPAQUE;
+            }
+        }
+        png::ColorType::GrayscaleAlpha => {
+            for (pixel, slice) in dst.zip(src.chunks_exact(2)) {
+                let gray = premultiply_u8(slice[0], slice[1]);
+                pixel[0] = gray;
+                pixel[1] = gray;
+                pixel[2] = gray;
+                pixel[3] = slice[1];
+            }
+        }
+        png::ColorType::Indexed => {
+            // Checked by the caller.
+            debug_assert!(false);
+        }
+    }
+}
+
 fn data_len_for_size(size: IntSize) -> Option<usize> {
     let row_bytes = min_row_bytes(size)?;
     compute_data_len(size, row_bytes.get())
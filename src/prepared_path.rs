@@ -0,0 +1,187 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+use alloc::vec;
+use alloc::vec::Vec;
+use core::num::NonZeroU16;
+
+use crate::{Path, FillRule, IntRect, LengthU32, Transform};
+use crate::{ALPHA_U8_OPAQUE, ALPHA_U8_TRANSPARENT};
+
+use crate::alpha_runs::AlphaRun;
+use crate::blitter::Blitter;
+use crate::color::AlphaU8;
+use crate::geom::ScreenIntRect;
+use crate::path::TransformedPath;
+use crate::scan;
+
+/// A path with precomputed coverage.
+///
+/// Filling a path requires building its edges and scan converting them,
+/// which is usually more expensive than blending the resulting pixels.
+/// A prepared path stores the coverage produced by scan conversion,
+/// so it can be filled many times, at different integer offsets and with different paints,
+/// without touching the path geometry again.
+///
+/// Useful for icons and glyphs that are drawn many times at the same scale.
+/// To draw a path at fractional offsets, prepare it once per subpixel position,
+/// by adding the fractional part to the transform.
+///
+/// Only paths up to 8191x8191 pixels can be prepared.
+#[derive(Clone, Debug)]
+pub struct PreparedPath {
+    spans: Vec<Span>,
+    /// Device-space position of the local coverage coordinates.
+    origin: IntRect,
+    transform: Transform,
+    max_span_width: u32,
+}
+
+/// A horizontal run of pixels with the same coverage, in local coordinates.
+#[derive(Clone, Copy, Debug)]
+struct Span {
+    x: u32,
+    y: u32,
+    width: LengthU32,
+    alpha: AlphaU8,
+}
+
+impl PreparedPath {
+    /// Prepares a path for filling.
+    ///
+    /// `transform` is applied to the path, while `Paint::anti_alias`
+    /// and `Paint::analytic_aa` are replaced by `anti_alias` during filling.
+    ///
+    /// Returns `None` when the path is empty, too large or in case of a numeric overflow.
+    pub fn new(
+        path: &Path,
+        fill_rule: FillRule,
+        anti_alias: bool,
+        transform: Transform,
+    ) -> Option<Self> {
+        let path = TransformedPath::new(path, transform)?;
+        if !crate::painter::is_fillable_path(path) {
+            return None;
+        }
+
+        // Anti-aliasing doesn't affect pixels outside the outset bounds.
+        let origin = scan::tiler::outset_bounds(&path.bounds())?;
+        if origin.width() > scan::tiler::MAX_DIM || origin.height() > scan::tiler::MAX_DIM {
+            return None;
+        }
+
+        // Coverage is computed in a local space, which starts at the bounds origin,
+        // the same way tiles are filled.
+        let path = path.translate(-origin.x() as f32, -origin.y() as f32)?;
+        let clip = ScreenIntRect::from_xywh(0, 0, origin.width(), origin.height())?;
+
+        let mut recorder = SpanRecorder(Vec::new());
+        if anti_alias {
+            scan::path_aa::fill_path(path, fill_rule, &clip, &mut recorder)?;
+        } else {
+            scan::path::fill_path(path, fill_rule, &clip, &mut recorder)?;
+        }
+
+        let spans = recorder.0;
+        let max_span_width = spans.iter().map(|s| s.width.get()).max()?;
+
+        Some(PreparedPath {
+            spans,
+            origin,
+            transform,
+            max_span_width,
+        })
+    }
+
+    /// Returns the transform the path was prepared with.
+    pub fn transform(&self) -> Transform {
+        self.transform
+    }
+
+    /// Returns device-space bounds of the coverage, that includes anti-aliasing.
+    pub fn bounds(&self) -> IntRect {
+        self.origin
+    }
+
+    /// Returns the coverage bounds translated by the specified offset.
+    pub(crate) fn bounds_at(&self, dx: i32, dy: i32) -> Option<IntRect> {
+        IntRect::from_xywh(
+            self.origin.x().checked_add(dx)?,
+            self.origin.y().checked_add(dy)?,
+            self.origin.width(),
+            self.origin.height(),
+        )
+    }
+
+    /// Blits the coverage translated by the specified offset.
+    ///
+    /// Spans outside the `clip` are cut.
+    pub(crate) fn fill(&self, dx: i32, dy: i32, clip: &ScreenIntRect, blitter: &mut dyn Blitter) {
+        let left = self.origin.x() as i64 + dx as i64;
+        let top = self.origin.y() as i64 + dy as i64;
+        let clip_left = clip.left() as i64;
+        let clip_right = clip.right() as i64;
+        let clip_top = clip.top() as i64;
+        let clip_bottom = clip.bottom() as i64;
+
+        // Each span is blitted as a single run.
+        let mut aa = vec![ALPHA_U8_TRANSPARENT; self.max_span_width as usize + 1];
+        let mut runs: Vec<AlphaRun> = vec![None; self.max_span_width as usize + 1];
+
+        for span in &self.spans {
+            let y = top + span.y as i64;
+            if y < clip_top || y >= clip_bottom {
+                continue;
+            }
+
+            let x0 = (left + span.x as i64).max(clip_left);
+            let x1 = (left + span.x as i64 + span.width.get() as i64).min(clip_right);
+            if x0 >= x1 {
+                continue;
+            }
+
+            // Cannot overflow, since the span is inside the clip now.
+            let (x, y, width) = (x0 as u32, y as u32, (x1 - x0) as u32);
+            let width = match LengthU32::new(width) {
+                Some(v) => v,
+                None => continue,
+            };
+
+            if span.alpha == ALPHA_U8_OPAQUE {
+                blitter.blit_h(x, y, width);
+            } else {
+                aa[0] = span.alpha;
+                runs[0] = NonZeroU16::new(width.get() as u16);
+                runs[width.get() as usize] = None;
+                blitter.blit_anti_h(x, y, &mut aa, &mut runs);
+            }
+        }
+    }
+}
+
+
+/// Stores blitted runs as spans.
+struct SpanRecorder(Vec<Span>);
+
+impl Blitter for SpanRecorder {
+    fn blit_h(&mut self, x: u32, y: u32, width: LengthU32) {
+        self.0.push(Span { x, y, width, alpha: ALPHA_U8_OPAQUE });
+    }
+
+    fn blit_anti_h(&mut self, mut x: u32, y: u32, aa: &mut [AlphaU8], runs: &mut [AlphaRun]) {
+        let mut offset = 0;
+        let mut run_opt = runs[0];
+        while let Some(run) = run_opt {
+            let width = LengthU32::from(run);
+            if aa[offset] != ALPHA_U8_TRANSPARENT {
+                self.0.push(Span { x, y, width, alpha: aa[offset] });
+            }
+
+            x += width.get();
+            offset += usize::from(run.get());
+            run_opt = runs[offset];
+        }
+    }
+}
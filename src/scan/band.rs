@@ -0,0 +1,269 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+//! Band-wise path filling.
+//!
+//! Edges are built only once for the whole destination and then advanced down
+//! the path a single time. At each band start, a copy of the edges that are still needed
+//! is made, so each band walks only its own rows. Since the edges state is exactly
+//! the same as in a single walk, the result is identical to it as well.
+
+use crate::{Paint, IntRect, FillRule, LengthU32};
+
+use crate::alpha_runs::AlphaRun;
+use crate::blitter::Blitter;
+use crate::color::AlphaU8;
+use crate::geom::ScreenIntRect;
+use crate::path::TransformedPath;
+
+use super::path::EdgeList;
+use super::path_aa::{SuperBlitter, SHIFT};
+use super::path_aaa::Lines;
+
+/// Bands smaller than this are not worth a separate task.
+const MIN_BAND_HEIGHT: u32 = 32;
+
+/// Returns the height of bands a destination with the specified height is split into.
+pub fn band_height(height: u32) -> u32 {
+    // Use more bands than threads, since rows are rarely equally expensive.
+    let bands_count = rayon::current_num_threads().max(1) as u32 * 4;
+    ((height + bands_count - 1) / bands_count).max(MIN_BAND_HEIGHT)
+}
+
+
+/// A path prepared for band-wise filling.
+pub struct BandedPath {
+    kind: Kind,
+    fill_rule: FillRule,
+}
+
+enum Kind {
+    Edges {
+        edges: EdgeList,
+        /// Supersampling bounds. `None` when not anti-aliased.
+        aa_bounds: Option<IntRect>,
+    },
+    Analytic(Lines),
+}
+
+impl BandedPath {
+    /// Builds path edges.
+    ///
+    /// `clip` must cover the whole destination, just like in a serial fill.
+    pub fn new(
+        path: TransformedPath,
+        fill_rule: FillRule,
+        paint: &Paint,
+        clip: &ScreenIntRect,
+    ) -> Option<Self> {
+        if paint.anti_alias && paint.analytic_aa {
+            return Some(BandedPath {
+                kind: Kind::Analytic(Lines::new(path, clip)?),
+                fill_rule,
+            });
+        }
+
+        let aa_bounds = if paint.anti_alias {
+            super::path_aa::supersampling_bounds(path, clip)?
+        } else {
+            None
+        };
+
+        let edges = match aa_bounds {
+            Some(ref ir) => {
+                let path_contained_in_clip = super::path_aa::is_contained_in_clip(ir, clip);
+                EdgeList::new(
+                    path, clip, ir.top(), ir.bottom(), SHIFT as i32, path_contained_in_clip,
+                )?
+            }
+            None => {
+                let ir = super::path::conservative_round_to_int(&path.bounds())?;
+                let path_contained_in_clip = super::path_aa::is_contained_in_clip(&ir, clip);
+                EdgeList::new(path, clip, ir.y(), ir.bottom(), 0, path_contained_in_clip)?
+            }
+        };
+
+        Some(BandedPath {
+            kind: Kind::Edges { edges, aa_bounds },
+            fill_rule,
+        })
+    }
+
+    /// Returns parts of the path inside bands of `band_height` rows,
+    /// from `top` to `bottom`, in bands order.
+    ///
+    /// A part is returned for each band, even when there is nothing to fill there.
+    pub fn bands(&self, top: u32, bottom: u32, band_height: u32) -> Bands {
+        let edges = match self.kind {
+            Kind::Edges { ref edges, .. } => Some(edges.clone()),
+            Kind::Analytic(_) => None,
+        };
+
+        Bands {
+            path: self,
+            edges,
+            top,
+            bottom,
+            band_height,
+        }
+    }
+}
+
+
+/// An iterator over path parts inside consecutive bands.
+///
+/// Edges are advanced between bands, so parts must be taken in order,
+/// but can be filled in any order afterwards.
+pub struct Bands<'a> {
+    path: &'a BandedPath,
+    /// Edges advanced up to the current band.
+    edges: Option<EdgeList>,
+    top: u32,
+    bottom: u32,
+    band_height: u32,
+}
+
+impl<'a> Iterator for Bands<'a> {
+    type Item = PathBand<'a>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if self.top >= self.bottom {
+            return None;
+        }
+
+        let top = self.top;
+        let bottom = (top + self.band_height).min(self.bottom);
+        self.top = bottom;
+
+        let kind = match self.path.kind {
+            Kind::Edges { ref aa_bounds, .. } => {
+                let shift = if aa_bounds.is_some() { SHIFT } else { 0 };
+                let edges = match self.edges {
+                    Some(ref mut edges) => {
+                        advance_edges(edges, self.path.fill_rule, top << shift, bottom << shift)
+                    }
+                    None => None,
+                };
+
+                PartKind::Edges { edges, aa_bounds: aa_bounds.as_ref() }
+            }
+            Kind::Analytic(ref lines) => PartKind::Analytic(lines),
+        };
+
+        Some(PathBand {
+            kind,
+            fill_rule: self.path.fill_rule,
+            top,
+        })
+    }
+}
+
+/// Advances edges up to the `top` row, without blitting anything,
+/// and returns a copy of them that can be walked down to the `bottom` row.
+///
+/// Returns `None` when the band is not covered by the edges.
+fn advance_edges(
+    edges: &mut EdgeList,
+    fill_rule: FillRule,
+    top: u32,
+    bottom: u32,
+) -> Option<(EdgeList, u32)> {
+    let stop_y = edges.stop_y().min(bottom);
+    // The first walked row is always blitted, so it must be inside the band.
+    if top >= stop_y || edges.start_y() >= stop_y {
+        return None;
+    }
+
+    if edges.start_y() < top {
+        edges.walk(fill_rule, top, &mut NullBlitter)?;
+    }
+
+    Some((edges.truncated(stop_y), stop_y))
+}
+
+
+/// A part of a path inside a band.
+pub struct PathBand<'a> {
+    kind: PartKind<'a>,
+    fill_rule: FillRule,
+    top: u32,
+}
+
+enum PartKind<'a> {
+    Edges {
+        /// Edges starting at the band top or below it and the row to stop at.
+        /// `None` when the band is not covered.
+        edges: Option<(EdgeList, u32)>,
+        aa_bounds: Option<&'a IntRect>,
+    },
+    Analytic(&'a Lines),
+}
+
+impl PathBand<'_> {
+    /// Fills the part of the path that is inside the band.
+    ///
+    /// `band` must span the whole clip width and the band rows,
+    /// but can be vertically smaller, when the band is partially clipped.
+    /// The `blitter` rows are relative to the `origin_y` row.
+    pub fn fill(
+        self,
+        band: &ScreenIntRect,
+        origin_y: u32,
+        blitter: &mut dyn Blitter,
+    ) -> Option<()> {
+        debug_assert!(band.top() >= self.top);
+
+        let mut blitter = TranslateY {
+            blitter,
+            dy: origin_y,
+        };
+
+        let (edges, stop_y, aa_bounds) = match self.kind {
+            PartKind::Edges { edges: Some((edges, stop_y)), aa_bounds } => {
+                (edges, stop_y, aa_bounds)
+            }
+            PartKind::Edges { edges: None, .. } => return None,
+            PartKind::Analytic(lines) => {
+                // Rows are independent, so the band can simply act as a clip.
+                return lines.fill(self.fill_rule, band, &mut blitter);
+            }
+        };
+
+        let mut edges = edges;
+        match aa_bounds {
+            Some(bounds) => {
+                // The band itself is the clip, so the super blitter flushes only its rows.
+                let mut blitter = SuperBlitter::new(bounds, band, &mut blitter)?;
+                edges.walk(self.fill_rule, stop_y, &mut blitter)
+            }
+            None => edges.walk(self.fill_rule, stop_y, &mut blitter),
+        }
+    }
+}
+
+
+/// Discards everything, so edges can be advanced without blitting.
+struct NullBlitter;
+
+impl Blitter for NullBlitter {
+    fn blit_h(&mut self, _x: u32, _y: u32, _width: LengthU32) {}
+}
+
+
+/// Converts destination coordinates into band ones.
+struct TranslateY<'a> {
+    blitter: &'a mut dyn Blitter,
+    dy: u32,
+}
+
+impl Blitter for TranslateY<'_> {
+    fn blit_h(&mut self, x: u32, y: u32, width: LengthU32) {
+        self.blitter.blit_h(x, y - self.dy, width);
+    }
+
+    fn blit_anti_h(&mut self, x: u32, y: u32, aa: &mut [AlphaU8], runs: &mut [AlphaRun]) {
+        self.blitter.blit_anti_h(x, y - self.dy, aa, runs);
+    }
+}
@@ -6,29 +6,25 @@
 
 use core::convert::TryInto;
 
-use crate::{Path, LineCap, Point, PathSegment, Rect, IntRect};
+use crate::{LineCap, Point, PathSegment, Rect, IntRect};
 
 use crate::blitter::Blitter;
 use crate::fixed_point::{fdot6, fdot16};
-use crate::floating_point::{FLOAT_PI, SaturateCast};
+use crate::flatten::{self, MAX_CUBIC_SUBDIVIDE_LEVEL, MAX_QUAD_SUBDIVIDE_LEVEL};
+use crate::floating_point::FLOAT_PI;
 use crate::geom::ScreenIntRect;
 use crate::line_clipper;
 use crate::math::LENGTH_U32_ONE;
-use crate::path::PathVerb;
+use crate::path::{PathVerb, TransformedPath};
 use crate::path_geometry;
-use crate::scalar::Scalar;
-use crate::wide::f32x2;
 
 #[cfg(all(not(feature = "std"), feature = "libm"))]
 use crate::scalar::FloatExt;
 
 pub type LineProc = fn(&[Point], Option<&ScreenIntRect>, &mut dyn Blitter) -> Option<()>;
 
-const MAX_CUBIC_SUBDIVIDE_LEVEL: u8 = 9;
-const MAX_QUAD_SUBDIVIDE_LEVEL: u8 = 5;
-
 pub fn stroke_path(
-    path: &Path,
+    path: TransformedPath,
     line_cap: LineCap,
     clip: &ScreenIntRect,
     blitter: &mut dyn Blitter,
@@ -36,6 +32,21 @@ pub fn stroke_path(
     super::hairline::stroke_path_impl(path, line_cap, clip, hair_line_rgn, blitter)
 }
 
+/// Strokes a polyline without caps.
+///
+/// Points must be transformed beforehand.
+pub fn stroke_polyline(
+    points: &[Point],
+    clip: &ScreenIntRect,
+    blitter: &mut dyn Blitter,
+) -> Option<()> {
+    if points.len() < 2 {
+        return None;
+    }
+
+    hair_line_rgn(points, Some(clip), blitter)
+}
+
 fn hair_line_rgn(
     points: &[Point],
     clip: Option<&ScreenIntRect>,
@@ -148,7 +159,7 @@ fn hair_line_rgn(
 
 
 pub fn stroke_path_impl(
-    path: &Path,
+    path: TransformedPath,
     line_cap: LineCap,
     clip: &ScreenIntRect,
     line_proc: LineProc,
@@ -217,7 +228,7 @@ pub fn stroke_path_impl(
                     clip,
                     inset_clip.as_ref(),
                     outset_clip.as_ref(),
-                    compute_quad_level(&points),
+                    flatten::quad_level(&points),
                     line_proc,
                     blitter,
                 );
@@ -426,61 +437,15 @@ fn hair_quad2(
 ) {
     debug_assert!(level <= MAX_QUAD_SUBDIVIDE_LEVEL); // TODO: to type
 
-    let coeff = path_geometry::QuadCoeff::from_points(points);
-
     const MAX_POINTS: usize = (1 << MAX_QUAD_SUBDIVIDE_LEVEL) + 1;
     let lines = 1 << level;
     debug_assert!(lines < MAX_POINTS);
 
     let mut tmp = [Point::zero(); MAX_POINTS];
-    tmp[0] = points[0];
-
-    let mut t = f32x2::default();
-    let dt = f32x2::splat(1.0 / lines as f32);
-    for i in 1..lines {
-        t = t + dt;
-        tmp[i] = Point::from_f32x2((coeff.a * t + coeff.b) * t + coeff.c);
-    }
-
-    tmp[lines] = points[2];
+    flatten::quad_points(points, lines, &mut tmp);
     line_proc(&tmp[0..lines + 1], clip, blitter);
 }
 
-fn compute_quad_level(points: &[Point; 3]) -> u8 {
-    let d = compute_int_quad_dist(points);
-    // Quadratics approach the line connecting their start and end points
-    // 4x closer with each subdivision, so we compute the number of
-    // subdivisions to be the minimum need to get that distance to be less
-    // than a pixel.
-    let mut level = (33 - d.leading_zeros()) >> 1;
-    // sanity check on level (from the previous version)
-    if level > MAX_QUAD_SUBDIVIDE_LEVEL as u32 {
-        level = MAX_QUAD_SUBDIVIDE_LEVEL as u32;
-    }
-
-    level as u8
-}
-
-fn compute_int_quad_dist(points: &[Point; 3]) -> u32 {
-    // compute the vector between the control point ([1]) and the middle of the
-    // line connecting the start and end ([0] and [2])
-    let dx = ((points[0].x + points[2].x).half() - points[1].x).abs();
-    let dy = ((points[0].y + points[2].y).half() - points[1].y).abs();
-
-    // convert to whole pixel values (use ceiling to be conservative).
-    // assign to unsigned so we can safely add 1/2 of the smaller and still fit in
-    // u32, since T::saturate_from() returns 31 bits at most.
-    let idx = i32::saturate_from(dx.ceil()) as u32;
-    let idy = i32::saturate_from(dy.ceil()) as u32;
-
-    // use the cheap approx for distance
-    if idx > idy {
-        idx + (idy >> 1)
-    } else {
-        idy + (idx >> 1)
-    }
-}
-
 fn hair_cubic(
     points: &[Point; 4],
     mut clip: Option<&ScreenIntRect>,
@@ -554,58 +519,22 @@ fn hair_cubic2(
     line_proc: LineProc,
     blitter: &mut dyn Blitter,
 ) {
-    let lines = compute_cubic_segments(points);
+    let lines = flatten::cubic_segments(points);
     debug_assert!(lines > 0);
     if lines == 1 {
         line_proc(&[points[0], points[3]], clip, blitter);
         return;
     }
 
-    let coeff = path_geometry::CubicCoeff::from_points(points);
-
     const MAX_POINTS: usize = (1 << MAX_CUBIC_SUBDIVIDE_LEVEL) + 1;
     debug_assert!(lines < MAX_POINTS);
     let mut tmp = [Point::zero(); MAX_POINTS];
+    flatten::cubic_points(points, lines, &mut tmp);
 
-    let dt = f32x2::splat(1.0 / lines as f32);
-    let mut t = f32x2::default();
-
-    tmp[0] = points[0];
-    for i in 1..lines {
-        t = t + dt;
-        tmp[i] = Point::from_f32x2(((coeff.a * t + coeff.b) * t + coeff.c) * t + coeff.d);
-    }
-
-    if tmp.iter().all(|p| p.is_finite()) {
-        tmp[lines] = points[3];
+    // The end point is copied as is and, like in Skia, is not checked.
+    if tmp[0..lines].iter().all(|p| p.is_finite()) {
         line_proc(&tmp[0..lines + 1], clip, blitter);
     } else {
         // else some point(s) are non-finite, so don't draw
     }
 }
-
-fn compute_cubic_segments(points: &[Point; 4]) -> usize {
-    let p0 = points[0].to_f32x2();
-    let p1 = points[1].to_f32x2();
-    let p2 = points[2].to_f32x2();
-    let p3 = points[3].to_f32x2();
-
-    let one_third = f32x2::splat(1.0 / 3.0);
-    let two_third = f32x2::splat(2.0 / 3.0);
-
-    let p13 = one_third * p3 + two_third * p0;
-    let p23 = one_third * p0 + two_third * p3;
-
-    let diff = (p1 - p13).abs().max((p2 - p23).abs()).max_component();
-    let mut tol = 1.0 / 8.0;
-
-    for i in 0..MAX_CUBIC_SUBDIVIDE_LEVEL {
-        if diff < tol {
-            return 1 << i;
-        }
-
-        tol *= 4.0;
-    }
-
-    1 << MAX_CUBIC_SUBDIVIDE_LEVEL
-}
@@ -7,7 +7,7 @@
 use core::convert::TryFrom;
 use core::num::NonZeroU16;
 
-use crate::{IntRect, LengthU32, Path, LineCap, Point, Rect};
+use crate::{IntRect, LengthU32, LineCap, Point, Rect};
 
 use crate::alpha_runs::{AlphaRun, AlphaRuns};
 use crate::blitter::Blitter;
@@ -16,6 +16,7 @@ use crate::fixed_point::{fdot6, fdot8, fdot16, FDot6, FDot8, FDot16};
 use crate::geom::ScreenIntRect;
 use crate::line_clipper;
 use crate::math::LENGTH_U32_ONE;
+use crate::path::TransformedPath;
 
 #[derive(Copy, Clone, Debug)]
 struct FixedRect {
@@ -230,7 +231,7 @@ fn call_hline_blitter(
 
 
 pub fn stroke_path(
-    path: &Path,
+    path: TransformedPath,
     line_cap: LineCap,
     clip: &ScreenIntRect,
     blitter: &mut dyn Blitter,
@@ -238,6 +239,21 @@ pub fn stroke_path(
     super::hairline::stroke_path_impl(path, line_cap, clip, anti_hair_line_rgn, blitter)
 }
 
+/// Strokes a polyline without caps.
+///
+/// Points must be transformed beforehand.
+pub fn stroke_polyline(
+    points: &[Point],
+    clip: &ScreenIntRect,
+    blitter: &mut dyn Blitter,
+) -> Option<()> {
+    if points.len() < 2 {
+        return None;
+    }
+
+    anti_hair_line_rgn(points, Some(clip), blitter)
+}
+
 fn anti_hair_line_rgn(
     points: &[Point],
     clip: Option<&ScreenIntRect>,
@@ -818,7 +834,7 @@ impl Blitter for RectClipBlitter<'_> {
         mut runs: &mut [AlphaRun],
     ) {
         fn y_in_rect(y: u32, rect: ScreenIntRect) -> bool {
-            (y - rect.top()) < rect.height()
+            y.wrapping_sub(rect.top()) < rect.height()
         }
 
         if !y_in_rect(y, self.clip) || x >= self.clip.right() {
@@ -856,7 +872,7 @@ impl Blitter for RectClipBlitter<'_> {
 
     fn blit_v(&mut self, x: u32, y: u32, height: LengthU32, alpha: AlphaU8) {
         fn x_in_rect(x: u32, rect: ScreenIntRect) -> bool {
-            (x - rect.left()) < rect.width()
+            x.wrapping_sub(rect.left()) < rect.width()
         }
 
         if !x_in_rect(x, self.clip) {
@@ -5,9 +5,13 @@
 // found in the LICENSE file.
 
 pub mod path_aa;
+pub mod path_aaa;
 pub mod path;
+#[cfg(feature = "parallel")]
+pub mod band;
 pub mod hairline_aa;
 pub mod hairline;
+pub mod tiler;
 
 
 use crate::{IntRect, Rect};
@@ -6,7 +6,9 @@
 
 use core::convert::TryFrom;
 
-use crate::{Path, IntRect, FillRule, LengthU32, Rect};
+use alloc::vec::Vec;
+
+use crate::{IntRect, FillRule, LengthU32, Rect};
 
 use crate::blitter::Blitter;
 use crate::edge::{Edge, LineEdge};
@@ -14,12 +16,13 @@ use crate::edge_builder::{BasicEdgeBuilder, ShiftedIntRect};
 use crate::fixed_point::{fdot6, fdot16, FDot16};
 use crate::floating_point::SaturateCast;
 use crate::geom::ScreenIntRect;
+use crate::path::TransformedPath;
 
 #[cfg(all(not(feature = "std"), feature = "libm"))]
 use crate::scalar::FloatExt;
 
 pub fn fill_path(
-    path: &Path,
+    path: TransformedPath,
     fill_rule: FillRule,
     clip: &ScreenIntRect,
     blitter: &mut dyn Blitter,
@@ -45,7 +48,7 @@ pub fn fill_path(
 // edges will fit inside the clip's bounds. The scan-converter introduces slight numeric errors
 // due to accumulated += of the slope, so this function is used to return a conservatively large
 // int-bounds, and thus we will only disable clipping if we're sure the edges will stay in-bounds.
-fn conservative_round_to_int(src: &Rect) -> Option<IntRect> {
+pub(crate) fn conservative_round_to_int(src: &Rect) -> Option<IntRect> {
     // We must use `from_ltrb`, otherwise rounding will be incorrect.
     IntRect::from_ltrb(
         round_down_to_int(src.left()),
@@ -85,76 +88,180 @@ fn round_up_to_int(x: f32) -> i32 {
 }
 
 pub fn fill_path_impl(
-    path: &Path,
+    path: TransformedPath,
     fill_rule: FillRule,
     clip_rect: &ScreenIntRect,
-    mut start_y: i32,
-    mut stop_y: i32,
+    start_y: i32,
+    stop_y: i32,
     shift_edges_up: i32,
     path_contained_in_clip: bool,
     blitter: &mut dyn Blitter,
 ) -> Option<()> {
-    let shifted_clip = ShiftedIntRect::new(clip_rect, shift_edges_up)?;
-    let clip = if path_contained_in_clip { None } else { Some(&shifted_clip) };
-    let mut edges = BasicEdgeBuilder::build_edges(path, clip, shift_edges_up)?;
+    let mut edges = EdgeList::new(
+        path,
+        clip_rect,
+        start_y,
+        stop_y,
+        shift_edges_up,
+        path_contained_in_clip,
+    )?;
+
+    let stop_y = edges.stop_y;
+    edges.walk(fill_rule, stop_y, blitter)
+}
+
+/// A sorted, sentinel-terminated list of path edges, ready to be walked.
+///
+/// Can be cloned and walked multiple times, which allows building edges only once
+/// and rasterizing different parts of the same path independently.
+#[derive(Clone, Debug)]
+pub struct EdgeList {
+    edges: Vec<Edge>,
+    start_y: u32,
+    stop_y: u32,
+    right_clip: u32,
+}
 
-    edges.sort_by(|a, b| {
-        let mut value_a = a.as_line().first_y;
-        let mut value_b = b.as_line().first_y;
+impl EdgeList {
+    pub fn new(
+        path: TransformedPath,
+        clip_rect: &ScreenIntRect,
+        mut start_y: i32,
+        mut stop_y: i32,
+        shift_edges_up: i32,
+        path_contained_in_clip: bool,
+    ) -> Option<Self> {
+        let shifted_clip = ShiftedIntRect::new(clip_rect, shift_edges_up)?;
+        let clip = if path_contained_in_clip { None } else { Some(&shifted_clip) };
+        let mut edges = BasicEdgeBuilder::build_edges(path, clip, shift_edges_up)?;
+
+        edges.sort_by(|a, b| {
+            let mut value_a = a.as_line().first_y;
+            let mut value_b = b.as_line().first_y;
+
+            if value_a == value_b {
+                value_a = a.as_line().x;
+                value_b = b.as_line().x;
+            }
+
+            value_a.cmp(&value_b)
+        });
+
+        for i in 0..edges.len() {
+            // 0 will be set later, so start with 1.
+            edges[i].prev = Some(i as u32 + 0);
+            edges[i].next = Some(i as u32 + 2);
+        }
+
+        const EDGE_HEAD_Y: i32 = i32::MIN;
+        const EDGE_TAIL_Y: i32 = i32::MAX;
+
+        edges.insert(0, Edge::Line(LineEdge {
+            prev: None,
+            next: Some(1),
+            x: i32::MIN,
+            first_y: EDGE_HEAD_Y,
+            ..LineEdge::default()
+        }));
+
+        edges.push(Edge::Line(LineEdge {
+            prev: Some(edges.len() as u32 - 1),
+            next: None,
+            first_y: EDGE_TAIL_Y,
+            ..LineEdge::default()
+        }));
+
+        start_y <<= shift_edges_up;
+        stop_y <<= shift_edges_up;
+
+        let top = shifted_clip.shifted().y() as i32;
+        if !path_contained_in_clip && start_y < top {
+            start_y = top;
+        }
 
-        if value_a == value_b {
-            value_a = a.as_line().x;
-            value_b = b.as_line().x;
+        let bottom = shifted_clip.shifted().bottom() as i32;
+        if !path_contained_in_clip && stop_y > bottom as i32 {
+            stop_y = bottom as i32;
         }
 
-        value_a.cmp(&value_b)
-    });
+        let start_y = u32::try_from(start_y).ok()?;
+        let stop_y = u32::try_from(stop_y).ok()?;
 
-    for i in 0..edges.len() {
-        // 0 will be set later, so start with 1.
-        edges[i].prev = Some(i as u32 + 0);
-        edges[i].next = Some(i as u32 + 2);
+        Some(EdgeList {
+            edges,
+            start_y,
+            stop_y,
+            right_clip: shifted_clip.shifted().right(),
+        })
     }
 
-    const EDGE_HEAD_Y: i32 = i32::MIN;
-    const EDGE_TAIL_Y: i32 = i32::MAX;
-
-    edges.insert(0, Edge::Line(LineEdge {
-        prev: None,
-        next: Some(1),
-        x: i32::MIN,
-        first_y: EDGE_HEAD_Y,
-        ..LineEdge::default()
-    }));
-
-    edges.push(Edge::Line(LineEdge {
-        prev: Some(edges.len() as u32 - 1),
-        next: None,
-        first_y: EDGE_TAIL_Y,
-        ..LineEdge::default()
-    }));
-
-    start_y <<= shift_edges_up;
-    stop_y <<= shift_edges_up;
-
-    let top = shifted_clip.shifted().y() as i32;
-    if !path_contained_in_clip && start_y < top {
-        start_y = top;
+    /// The first row that will be walked, in shifted coordinates.
+    pub fn start_y(&self) -> u32 {
+        self.start_y
     }
 
-    let bottom = shifted_clip.shifted().bottom() as i32;
-    if !path_contained_in_clip && stop_y > bottom as i32 {
-        stop_y = bottom as i32;
+    /// The row past the last one that will be walked, in shifted coordinates.
+    ///
+    /// At least one row is always walked.
+    pub fn stop_y(&self) -> u32 {
+        self.stop_y.max(self.start_y + 1)
     }
 
-    let start_y = u32::try_from(start_y).ok()?;
-    let stop_y = u32::try_from(stop_y).ok()?;
+    /// Walks edges from `start_y` up to, but not including, `stop_y`.
+    ///
+    /// `stop_y` must not be bigger than `EdgeList::stop_y`.
+    /// Edges are advanced during the walk, so afterwards the list starts at `stop_y`
+    /// and the next walk continues exactly where this one has stopped.
+    pub fn walk(&mut self, fill_rule: FillRule, stop_y: u32, blitter: &mut dyn Blitter) -> Option<()> {
+        debug_assert!(stop_y <= self.stop_y());
 
-    // TODO: walk_simple_edges
+        // TODO: walk_simple_edges
 
-    walk_edges(fill_rule, start_y, stop_y, shifted_clip.shifted().right(), &mut edges, blitter)
+        let next_idx = walk_edges(
+            fill_rule, self.start_y, stop_y, self.right_clip, &mut self.edges, blitter,
+        );
+
+        // Prepare the next row, just like the walk itself does.
+        insert_new_edges(next_idx, stop_y as i32, &mut self.edges);
+        self.start_y = stop_y;
+
+        Some(())
+    }
+
+    /// Returns a copy of edges, that can be walked from `start_y` to `stop_y` only.
+    ///
+    /// Finished edges and edges that start below `stop_y` are not copied.
+    /// The order of the remaining ones is preserved, so the walk is not affected.
+    pub fn truncated(&self, stop_y: u32) -> EdgeList {
+        let mut edges = Vec::new();
+        edges.push(self.edges[0].clone());
+
+        let mut idx = self.edges[0].next.unwrap() as usize;
+        while self.edges[idx].first_y < stop_y as i32 {
+            let mut edge = self.edges[idx].clone();
+            edge.prev = Some(edges.len() as u32 - 1);
+            edge.next = Some(edges.len() as u32 + 1);
+            edges.push(edge);
+            idx = self.edges[idx].next.unwrap() as usize;
+        }
+
+        // The tail sentinel is always the last one.
+        let mut tail = self.edges[self.edges.len() - 1].clone();
+        tail.prev = Some(edges.len() as u32 - 1);
+        edges.push(tail);
+        edges[0].next = Some(1);
+
+        EdgeList {
+            edges,
+            start_y: self.start_y,
+            stop_y: self.stop_y,
+            right_clip: self.right_clip,
+        }
+    }
 }
 
+// Returns the first edge that starts below `stop_y`.
+//
 // TODO: simplify!
 fn walk_edges(
     fill_rule: FillRule,
@@ -163,7 +270,7 @@ fn walk_edges(
     right_clip: u32,
     edges: &mut [Edge],
     blitter: &mut dyn Blitter,
-) -> Option<()> {
+) -> usize {
     let mut curr_y = start_y;
     let winding_mask = if fill_rule == FillRule::EvenOdd { 1 } else { -1 };
 
@@ -255,16 +362,15 @@ fn walk_edges(
             }
         }
 
+        count!(SCANLINES);
         curr_y += 1;
         if curr_y >= stop_y {
-            break;
+            return curr_idx;
         }
 
         // now current edge points to the first edge with a Yint larger than curr_y
         insert_new_edges(curr_idx, curr_y as i32, edges);
     }
-
-    Some(())
 }
 
 fn remove_edge(curr_idx: usize, edges: &mut [Edge]) {
@@ -6,13 +6,14 @@
 
 use core::convert::TryFrom;
 
-use crate::{Path, IntRect, FillRule, LengthU32, Rect};
+use crate::{IntRect, FillRule, LengthU32, Rect};
 
 use crate::alpha_runs::AlphaRuns;
 use crate::blitter::Blitter;
 use crate::color::AlphaU8;
 use crate::geom::ScreenIntRect;
 use crate::math::left_shift;
+use crate::path::TransformedPath;
 
 #[cfg(all(not(feature = "std"), feature = "libm"))]
 use crate::scalar::FloatExt;
@@ -20,23 +21,35 @@ use crate::scalar::FloatExt;
 /// controls how much we super-sample (when we use that scan conversion)
 const SUPERSAMPLE_SHIFT: u32 = 2;
 
-const SHIFT: u32 = SUPERSAMPLE_SHIFT;
+pub(crate) const SHIFT: u32 = SUPERSAMPLE_SHIFT;
 const SCALE: u32 = 1 << SHIFT;
 const MASK: u32  = SCALE - 1;
 
 pub fn fill_path(
-    path: &Path,
+    path: TransformedPath,
     fill_rule: FillRule,
     clip: &ScreenIntRect,
     blitter: &mut dyn Blitter,
 ) -> Option<()> {
+    match supersampling_bounds(path, clip)? {
+        Some(ir) => fill_path_impl(path, fill_rule, &ir, clip, blitter),
+        None => super::path::fill_path(path, fill_rule, clip, blitter),
+    }
+}
+
+/// Returns rounded out path bounds that can be used for supersampling.
+///
+/// Returns `Some(None)` when the path must be filled without antialiasing
+/// and `None` when there is nothing to fill.
+pub(crate) fn supersampling_bounds(path: TransformedPath, clip: &ScreenIntRect) -> Option<Option<IntRect>> {
     // Unlike `path.bounds.to_rect()?.round_out()`,
     // this method rounds out first and then converts into a Rect.
+    let bounds = path.bounds();
     let ir = Rect::from_ltrb(
-        path.bounds.left().floor(),
-        path.bounds.top().floor(),
-        path.bounds.right().ceil(),
-        path.bounds.bottom().ceil(),
+        bounds.left().floor(),
+        bounds.top().floor(),
+        bounds.right().ceil(),
+        bounds.bottom().ceil(),
     )?.round_out();
 
     // If the intersection of the path bounds and the clip bounds
@@ -44,7 +57,8 @@ pub fn fill_path(
     // so draw without antialiasing.
     let clipped_ir = ir.intersect(&clip.to_int_rect())?;
     if rect_overflows_short_shift(&clipped_ir, SHIFT as i32) != 0 {
-        return super::path::fill_path(path, fill_rule, clip, blitter);
+        count!(SUPERSAMPLING_FALLBACKS);
+        return Some(None);
     }
 
     // Our antialiasing can't handle a clip larger than 32767.
@@ -59,7 +73,7 @@ pub fn fill_path(
     // TODO: SkScanClipper
     // TODO: AAA
 
-    fill_path_impl(path, fill_rule, &ir, clip, blitter)
+    Some(Some(ir))
 }
 
 // Would any of the coordinates of this rectangle not fit in a short,
@@ -84,7 +98,7 @@ fn overflows_short_shift(value: i32, shift: i32) -> i32 {
 }
 
 fn fill_path_impl(
-    path: &Path,
+    path: TransformedPath,
     fill_rule: FillRule,
     bounds: &IntRect,
     clip: &ScreenIntRect,
@@ -95,13 +109,7 @@ fn fill_path_impl(
     // TODO: 15% slower than skia, find out why
     let mut blitter = SuperBlitter::new(bounds, clip, blitter)?;
 
-    let path_contained_in_clip = if let Some(bounds) = bounds.to_screen_int_rect() {
-        clip.contains(&bounds)
-    } else {
-        // If bounds cannot be converted into ScreenIntRect,
-        // the path is out of clip.
-        false
-    };
+    let path_contained_in_clip = is_contained_in_clip(bounds, clip);
 
     super::path::fill_path_impl(
         path,
@@ -115,6 +123,16 @@ fn fill_path_impl(
     )
 }
 
+pub(crate) fn is_contained_in_clip(bounds: &IntRect, clip: &ScreenIntRect) -> bool {
+    if let Some(bounds) = bounds.to_screen_int_rect() {
+        clip.contains(&bounds)
+    } else {
+        // If bounds cannot be converted into ScreenIntRect,
+        // the path is out of clip.
+        false
+    }
+}
+
 struct BaseSuperBlitter<'a> {
     real_blitter: &'a mut dyn Blitter,
 
@@ -153,14 +171,14 @@ impl<'a> BaseSuperBlitter<'a> {
 }
 
 
-struct SuperBlitter<'a> {
+pub(crate) struct SuperBlitter<'a> {
     base: BaseSuperBlitter<'a>,
     runs: AlphaRuns,
     offset_x: usize,
 }
 
 impl<'a> SuperBlitter<'a> {
-    fn new(
+    pub(crate) fn new(
         bounds: &IntRect,
         clip_rect: &ScreenIntRect,
         blitter: &'a mut dyn Blitter,
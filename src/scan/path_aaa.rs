@@ -0,0 +1,367 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+//! Analytic anti-aliasing.
+//!
+//! Unlike `path_aa`, which supersamples each pixel row 4 times, this scan converter
+//! computes an exact area coverage of each pixel by a path flattened into lines.
+//!
+//! Each line adds its signed area contribution into a per-row accumulation buffer.
+//! A prefix sum of this buffer results in a per-pixel coverage.
+//! This is the same approach as in font-rs and stb_truetype.
+//!
+//! The non-zero fill rule is computed as `min(|coverage|, 1)` and the even-odd one
+//! is approximated by folding the coverage to the 0..1 range.
+//! Both are exact unless edges of overlapping contours share the same pixel.
+
+use alloc::vec;
+use alloc::vec::Vec;
+use core::num::NonZeroU16;
+
+use crate::{Point, Rect, FillRule};
+
+use crate::alpha_runs::AlphaRun;
+use crate::blitter::Blitter;
+use crate::flatten;
+use crate::geom::ScreenIntRect;
+use crate::path::TransformedPath;
+
+#[cfg(all(not(feature = "std"), feature = "libm"))]
+use crate::scalar::FloatExt;
+
+pub fn fill_path(
+    path: TransformedPath,
+    fill_rule: FillRule,
+    clip: &ScreenIntRect,
+    blitter: &mut dyn Blitter,
+) -> Option<()> {
+    let lines = Lines::new(path, clip)?;
+    lines.fill(fill_rule, clip, blitter)
+}
+
+
+#[derive(Copy, Clone, Debug)]
+struct Line {
+    x0: f32,
+    y0: f32,
+    y1: f32,
+    dxdy: f32,
+    /// 1 when the line goes down and -1 otherwise.
+    dir: f32,
+}
+
+impl Line {
+    fn new(p0: Point, p1: Point) -> Option<Self> {
+        let (p0, p1, dir) = if p0.y < p1.y {
+            (p0, p1, 1.0)
+        } else if p0.y > p1.y {
+            (p1, p0, -1.0)
+        } else {
+            // Horizontal lines do not contribute to the coverage.
+            return None;
+        };
+
+        Some(Line {
+            x0: p0.x,
+            y0: p0.y,
+            y1: p1.y,
+            dxdy: (p1.x - p0.x) / (p1.y - p0.y),
+            dir,
+        })
+    }
+
+    #[inline]
+    fn x_at(&self, y: f32) -> f32 {
+        self.x0 + (y - self.y0) * self.dxdy
+    }
+}
+
+
+/// A flattened path, sorted by line top.
+#[derive(Clone, Debug)]
+pub struct Lines {
+    lines: Vec<Line>,
+    /// Path bounds clipped by the clip rectangle.
+    bounds: ScreenIntRect,
+}
+
+impl Lines {
+    /// Flattens a path.
+    ///
+    /// Returns `None` when the path is outside the clip.
+    pub fn new(path: TransformedPath, clip: &ScreenIntRect) -> Option<Self> {
+        let bounds = Rect::from_ltrb(
+            path.bounds().left().floor(),
+            path.bounds().top().floor(),
+            path.bounds().right().ceil(),
+            path.bounds().bottom().ceil(),
+        )?.round_out();
+        let bounds = bounds.intersect(&clip.to_int_rect())?.to_screen_int_rect()?;
+
+        let mut lines = Vec::new();
+        flatten::flatten_path(path, &mut |p0, p1| {
+            if let Some(line) = Line::new(p0, p1) {
+                lines.push(line);
+            }
+        });
+
+        lines.sort_by(|a, b| a.y0.partial_cmp(&b.y0).unwrap_or(core::cmp::Ordering::Equal));
+        count!(EDGES, lines.len());
+
+        Some(Lines { lines, bounds })
+    }
+
+    /// Fills the flattened path.
+    ///
+    /// `clip` can be smaller than the one used during flattening, but only vertically.
+    pub fn fill(
+        &self,
+        fill_rule: FillRule,
+        clip: &ScreenIntRect,
+        blitter: &mut dyn Blitter,
+    ) -> Option<()> {
+        let sect = self.bounds.to_int_rect().intersect(&clip.to_int_rect())?;
+        let sect = sect.to_screen_int_rect()?;
+
+        let width = sect.width() as usize;
+        let left = sect.left() as f32;
+
+        // Two extra cells, because lines can touch the right edge.
+        let mut acc = vec![0.0f32; width + 2];
+        let mut alpha = vec![0u8; width + 1];
+        let mut runs: Vec<AlphaRun> = vec![None; width + 1];
+
+        let mut active: Vec<Line> = Vec::new();
+        let mut next_idx = 0;
+        for y in sect.top()..sect.bottom() {
+            count!(SCANLINES);
+            let row_top = y as f32;
+            let row_bottom = row_top + 1.0;
+
+            while next_idx < self.lines.len() && self.lines[next_idx].y0 < row_bottom {
+                active.push(self.lines[next_idx]);
+                next_idx += 1;
+            }
+
+            active.retain(|line| line.y1 > row_top);
+            if active.is_empty() {
+                if next_idx == self.lines.len() {
+                    break;
+                }
+
+                continue;
+            }
+
+            let mut min_x = width;
+            for line in &active {
+                let ya = line.y0.max(row_top);
+                let yb = line.y1.min(row_bottom);
+                if yb <= ya {
+                    continue;
+                }
+
+                let xa = line.x_at(ya) - left;
+                let xb = line.x_at(yb) - left;
+                accumulate(&mut acc, xa, xb, (yb - ya) * line.dir, width, &mut min_x);
+            }
+
+            if min_x >= width {
+                acc[width] = 0.0;
+                acc[width + 1] = 0.0;
+                continue;
+            }
+
+            let mut sum = 0.0;
+            for (a, c) in alpha.iter_mut().zip(acc[min_x..width].iter_mut()) {
+                sum += *c;
+                *c = 0.0;
+                *a = coverage_to_alpha(sum, fill_rule);
+            }
+
+            acc[width] = 0.0;
+            acc[width + 1] = 0.0;
+
+            let len = width - min_x;
+            let mut i = 0;
+            while i < len {
+                let mut n = 1;
+                while i + n < len && alpha[i + n] == alpha[i] {
+                    n += 1;
+                }
+
+                // Runs are limited by `u16`, so longer ones are split.
+                let n = n.min(usize::from(u16::MAX));
+                runs[i] = NonZeroU16::new(n as u16);
+                i += n;
+            }
+            runs[len] = None;
+
+            blitter.blit_anti_h(sect.left() + min_x as u32, y, &mut alpha, &mut runs);
+        }
+
+        Some(())
+    }
+}
+
+#[inline]
+fn coverage_to_alpha(coverage: f32, fill_rule: FillRule) -> u8 {
+    let mut c = coverage.abs();
+    c = match fill_rule {
+        FillRule::Winding => c.min(1.0),
+        FillRule::EvenOdd => {
+            let c = c % 2.0;
+            if c > 1.0 { 2.0 - c } else { c }
+        }
+    };
+
+    (c * 255.0 + 0.5) as u8
+}
+
+/// Accumulates a line that lies inside a single pixel row.
+///
+/// `d` is a signed line height.
+fn accumulate(
+    acc: &mut [f32],
+    mut xa: f32,
+    mut xb: f32,
+    mut d: f32,
+    width: usize,
+    min_x: &mut usize,
+) {
+    let w = width as f32;
+
+    // Anything to the right of the row doesn't affect visible pixels.
+    if xa >= w && xb >= w {
+        return;
+    }
+
+    // Anything to the left of the row fully covers the row start.
+    if xa <= 0.0 && xb <= 0.0 {
+        acc[0] += d;
+        *min_x = 0;
+        return;
+    }
+
+    if xa < 0.0 || xb < 0.0 {
+        let t = -xa / (xb - xa);
+        let left_part = if xa < 0.0 { t } else { 1.0 - t };
+        acc[0] += d * left_part;
+        d -= d * left_part;
+        if xa < 0.0 { xa = 0.0; } else { xb = 0.0; }
+    }
+
+    if xa > w || xb > w {
+        let t = (w - xa) / (xb - xa);
+        let right_part = if xa > w { t } else { 1.0 - t };
+        d -= d * right_part;
+        if xa > w { xa = w; } else { xb = w; }
+    }
+
+    let (x0, x1) = if xa < xb { (xa, xb) } else { (xb, xa) };
+    let x0_floor = x0.floor();
+    let x0i = x0_floor as usize;
+    let x1_ceil = x1.ceil();
+    let x1i = x1_ceil as usize;
+
+    *min_x = (*min_x).min(x0i);
+
+    if x1i <= x0i + 1 {
+        // Both ends are in the same pixel.
+        let xmf = 0.5 * (xa + xb) - x0_floor;
+        acc[x0i] += d - d * xmf;
+        acc[x0i + 1] += d * xmf;
+    } else {
+        let s = 1.0 / (x1 - x0);
+        let x0f = x0 - x0_floor;
+        let a0 = 0.5 * s * (1.0 - x0f) * (1.0 - x0f);
+        let x1f = x1 - x1_ceil + 1.0;
+        let am = 0.5 * s * x1f * x1f;
+        acc[x0i] += d * a0;
+        if x1i == x0i + 2 {
+            acc[x0i + 1] += d * (1.0 - a0 - am);
+        } else {
+            let a1 = s * (1.5 - x0f);
+            acc[x0i + 1] += d * (a1 - a0);
+            for c in &mut acc[x0i + 2..x1i - 1] {
+                *c += d * s;
+            }
+            let a2 = a1 + (x1i - x0i - 3) as f32 * s;
+            acc[x1i - 1] += d * (1.0 - a2 - am);
+        }
+        acc[x1i] += d * am;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    struct Rows(Vec<Vec<u8>>);
+
+    impl Blitter for Rows {
+        fn blit_anti_h(&mut self, x: u32, y: u32, aa: &mut [u8], runs: &mut [AlphaRun]) {
+            let row = &mut self.0[y as usize];
+            let mut x = x as usize;
+            let mut i = 0;
+            while let Some(n) = runs[i] {
+                for _ in 0..n.get() {
+                    row[x] = aa[i];
+                    x += 1;
+                }
+                i += usize::from(n.get());
+            }
+        }
+    }
+
+    fn fill(path: &crate::Path, fill_rule: FillRule) -> Vec<Vec<u8>> {
+        let clip = ScreenIntRect::from_xywh(0, 0, 4, 4).unwrap();
+        let mut rows = Rows(vec![vec![0; 4]; 4]);
+        fill_path(path.into(), fill_rule, &clip, &mut rows).unwrap();
+        rows.0
+    }
+
+    #[test]
+    fn half_pixel_rect() {
+        let path = crate::PathBuilder::from_rect(Rect::from_ltrb(0.5, 1.0, 3.5, 2.0).unwrap());
+        assert_eq!(fill(&path, FillRule::Winding), vec![
+            vec![0, 0, 0, 0],
+            vec![128, 255, 255, 128],
+            vec![0, 0, 0, 0],
+            vec![0, 0, 0, 0],
+        ]);
+    }
+
+    #[test]
+    fn diagonal() {
+        let mut pb = crate::PathBuilder::new();
+        pb.move_to(0.0, 0.0);
+        pb.line_to(2.0, 2.0);
+        pb.line_to(0.0, 2.0);
+        pb.close();
+        let path = pb.finish().unwrap();
+        assert_eq!(fill(&path, FillRule::Winding), vec![
+            vec![128, 0, 0, 0],
+            vec![255, 128, 0, 0],
+            vec![0, 0, 0, 0],
+            vec![0, 0, 0, 0],
+        ]);
+    }
+
+    #[test]
+    fn even_odd_overlap() {
+        let mut pb = crate::PathBuilder::new();
+        pb.push_rect(0.0, 0.0, 2.0, 1.0);
+        pb.push_rect(1.0, 0.0, 2.0, 1.0);
+        let path = pb.finish().unwrap();
+        assert_eq!(fill(&path, FillRule::EvenOdd)[0], vec![255, 0, 255, 0]);
+        assert_eq!(fill(&path, FillRule::Winding)[0], vec![255, 255, 255, 0]);
+    }
+
+    #[test]
+    fn clipped_left() {
+        let path = crate::PathBuilder::from_rect(Rect::from_ltrb(-10.0, 0.0, 1.5, 1.0).unwrap());
+        assert_eq!(fill(&path, FillRule::Winding)[0], vec![255, 128, 0, 0]);
+    }
+}
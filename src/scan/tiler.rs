@@ -0,0 +1,291 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+//! Splits large destinations into tiles.
+//!
+//! Scan converters store coordinates in a fixed-point format, so edges cannot be built
+//! for coordinates larger than 8191 (with supersampling) or 32767 (without).
+//! To fill larger destinations, the geometry is translated into the local space
+//! of each tile and the blitter translates it back.
+//!
+//! Tiles are placed starting from the top-left corner of the visible geometry bounds
+//! and not from the destination origin, so geometry that fits a single tile
+//! is always rendered in a single pass.
+//!
+//! Edges are stored relative to a tile and cannot be shared between tiles,
+//! but a path is culled once per row of tiles, so each tile builds edges
+//! only from segments that can reach it.
+
+use alloc::vec::Vec;
+
+use crate::{IntRect, LengthU32, Path, PathSegment, Point, Rect};
+
+use crate::alpha_runs::AlphaRun;
+use crate::blitter::{Blitter, Mask};
+use crate::color::AlphaU8;
+use crate::geom::ScreenIntRect;
+use crate::path::{PathVerb, TransformedPath};
+
+/// The maximum tile size.
+///
+/// 8K is 1 too big, since 8K << supersample == 32768 which is too big for Fixed.
+pub const MAX_DIM: u32 = 8192 - 1;
+
+/// An iterator over destination tiles that intersect the geometry bounds.
+pub struct DrawTiler {
+    area: ScreenIntRect,
+    x: u32,
+    y: u32,
+}
+
+impl DrawTiler {
+    /// Checks that drawing onto the `clip` requires tiling.
+    #[inline]
+    pub fn required(clip: &ScreenIntRect) -> bool {
+        clip.right() > MAX_DIM || clip.bottom() > MAX_DIM
+    }
+
+    /// Creates a new tiler.
+    ///
+    /// `bounds` are geometry bounds in the destination coordinates.
+    /// They must include any anti-aliasing bleed.
+    ///
+    /// Returns `None` when the geometry is outside the `clip`.
+    pub fn new(bounds: &IntRect, clip: &ScreenIntRect) -> Option<Self> {
+        let area = bounds.intersect(&clip.to_int_rect())?.to_screen_int_rect()?;
+        Some(DrawTiler {
+            area,
+            x: 0,
+            y: 0,
+        })
+    }
+}
+
+impl Iterator for DrawTiler {
+    type Item = ScreenIntRect;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if self.y >= self.area.height() {
+            return None;
+        }
+
+        let width = MAX_DIM.min(self.area.width() - self.x);
+        let height = MAX_DIM.min(self.area.height() - self.y);
+        let tile = ScreenIntRect::from_xywh(
+            self.area.x() + self.x,
+            self.area.y() + self.y,
+            width,
+            height,
+        );
+
+        self.x += width;
+        if self.x >= self.area.width() {
+            self.x = 0;
+            self.y += height;
+        }
+
+        tile
+    }
+}
+
+/// Returns a bounds rectangle usable by `DrawTiler`.
+///
+/// Anti-aliasing can affect a pixel outside of the geometry bounds, so they are outset by one.
+pub fn outset_bounds(rect: &Rect) -> Option<IntRect> {
+    let r = rect.round_out();
+    IntRect::from_ltrb(
+        r.left().checked_sub(1)?,
+        r.top().checked_sub(1)?,
+        r.right().checked_add(1)?,
+        r.bottom().checked_add(1)?,
+    )
+}
+
+/// Returns a path with only the segments that can affect rows between `top` and `bottom`.
+///
+/// Runs of segments that are entirely above or below the rows are replaced with lines
+/// between their end points, so contours stay connected and are closed the same way.
+/// Such lines are outside the rows as well and do not produce any edges.
+/// Points are already transformed, so the result must be moved into the tile space
+/// the same way as the original path.
+///
+/// Returns `None` when none of the segments can affect the rows.
+pub fn cull_rows(path: TransformedPath, top: f32, bottom: f32) -> Option<Path> {
+    let mut verbs = Vec::new();
+    let mut points = Vec::new();
+    // The end point of the current run of culled segments.
+    let mut culled_end = None;
+    let mut has_edges = false;
+    let mut last = Point::zero();
+    let mut buf = [Point::zero(); 3];
+
+    for segment in path.segments() {
+        let (verb, len) = match segment {
+            PathSegment::MoveTo(p) => {
+                push_culled_line(&mut verbs, &mut points, &mut culled_end);
+                verbs.push(PathVerb::Move);
+                points.push(p);
+                last = p;
+                continue;
+            }
+            PathSegment::Close => {
+                push_culled_line(&mut verbs, &mut points, &mut culled_end);
+                verbs.push(PathVerb::Close);
+                continue;
+            }
+            PathSegment::LineTo(p) => {
+                buf[0] = p;
+                (PathVerb::Line, 1)
+            }
+            PathSegment::QuadTo(p1, p2) => {
+                buf[0] = p1;
+                buf[1] = p2;
+                (PathVerb::Quad, 2)
+            }
+            PathSegment::CubicTo(p1, p2, p3) => {
+                buf[0] = p1;
+                buf[1] = p2;
+                buf[2] = p3;
+                (PathVerb::Cubic, 3)
+            }
+        };
+
+        let segment_points = &buf[..len];
+
+        // A curve is inside the hull of its control points.
+        let mut min_y = last.y;
+        let mut max_y = last.y;
+        for p in segment_points {
+            min_y = min_y.min(p.y);
+            max_y = max_y.max(p.y);
+        }
+
+        last = segment_points[len - 1];
+        if max_y < top || min_y > bottom {
+            culled_end = Some(last);
+        } else {
+            push_culled_line(&mut verbs, &mut points, &mut culled_end);
+            verbs.push(verb);
+            points.extend_from_slice(segment_points);
+            has_edges = true;
+        }
+    }
+
+    push_culled_line(&mut verbs, &mut points, &mut culled_end);
+
+    if !has_edges {
+        return None;
+    }
+
+    let bounds = Rect::from_points(&points)?;
+    Some(Path { verbs, points, bounds })
+}
+
+fn push_culled_line(verbs: &mut Vec<PathVerb>, points: &mut Vec<Point>, end: &mut Option<Point>) {
+    if let Some(p) = end.take() {
+        verbs.push(PathVerb::Line);
+        points.push(p);
+    }
+}
+
+/// Returns a tile sized clip with a zero origin.
+#[inline]
+pub fn local_clip(tile: &ScreenIntRect) -> ScreenIntRect {
+    ScreenIntRect::from_xywh_safe(0, 0, tile.width_safe(), tile.height_safe())
+}
+
+
+/// Converts tile coordinates into destination ones.
+pub struct TileBlitter<'a> {
+    blitter: &'a mut dyn Blitter,
+    dx: u32,
+    dy: u32,
+}
+
+impl<'a> TileBlitter<'a> {
+    /// Creates a new blitter for the `tile`.
+    pub fn new(tile: &ScreenIntRect, blitter: &'a mut dyn Blitter) -> Self {
+        TileBlitter {
+            blitter,
+            dx: tile.x(),
+            dy: tile.y(),
+        }
+    }
+
+    fn translate(&self, rect: &ScreenIntRect) -> ScreenIntRect {
+        // Cannot fail, since tiles are inside the destination.
+        ScreenIntRect::from_xywh_safe(
+            rect.x() + self.dx,
+            rect.y() + self.dy,
+            rect.width_safe(),
+            rect.height_safe(),
+        )
+    }
+}
+
+impl Blitter for TileBlitter<'_> {
+    fn blit_h(&mut self, x: u32, y: u32, width: LengthU32) {
+        self.blitter.blit_h(x + self.dx, y + self.dy, width);
+    }
+
+    fn blit_anti_h(&mut self, x: u32, y: u32, aa: &mut [AlphaU8], runs: &mut [AlphaRun]) {
+        self.blitter.blit_anti_h(x + self.dx, y + self.dy, aa, runs);
+    }
+
+    fn blit_v(&mut self, x: u32, y: u32, height: LengthU32, alpha: AlphaU8) {
+        self.blitter.blit_v(x + self.dx, y + self.dy, height, alpha);
+    }
+
+    fn blit_anti_h2(&mut self, x: u32, y: u32, alpha0: AlphaU8, alpha1: AlphaU8) {
+        self.blitter.blit_anti_h2(x + self.dx, y + self.dy, alpha0, alpha1);
+    }
+
+    fn blit_anti_v2(&mut self, x: u32, y: u32, alpha0: AlphaU8, alpha1: AlphaU8) {
+        self.blitter.blit_anti_v2(x + self.dx, y + self.dy, alpha0, alpha1);
+    }
+
+    fn blit_rect(&mut self, rect: &ScreenIntRect) {
+        let rect = self.translate(rect);
+        self.blitter.blit_rect(&rect);
+    }
+
+    fn blit_mask(&mut self, mask: &Mask, clip: &ScreenIntRect) {
+        let mask = Mask {
+            image: mask.image,
+            bounds: self.translate(&mask.bounds),
+            row_bytes: mask.row_bytes,
+        };
+        let clip = self.translate(clip);
+        self.blitter.blit_mask(&mask, &clip);
+    }
+}
+
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use alloc::vec;
+    use alloc::vec::Vec;
+
+    #[test]
+    fn tiles() {
+        let clip = ScreenIntRect::from_xywh(0, 0, 20000, 10000).unwrap();
+        let bounds = IntRect::from_xywh(-10, 100, 20000, 100).unwrap();
+        let tiles: Vec<_> = DrawTiler::new(&bounds, &clip).unwrap().collect();
+        assert_eq!(tiles, vec![
+            ScreenIntRect::from_xywh(0, 100, MAX_DIM, 100).unwrap(),
+            ScreenIntRect::from_xywh(MAX_DIM, 100, MAX_DIM, 100).unwrap(),
+            ScreenIntRect::from_xywh(MAX_DIM * 2, 100, 19990 - MAX_DIM * 2, 100).unwrap(),
+        ]);
+    }
+
+    #[test]
+    fn single_tile() {
+        let clip = ScreenIntRect::from_xywh(0, 0, 20000, 20000).unwrap();
+        let bounds = IntRect::from_xywh(15000, 15000, 100, 100).unwrap();
+        let tiles: Vec<_> = DrawTiler::new(&bounds, &clip).unwrap().collect();
+        assert_eq!(tiles, vec![ScreenIntRect::from_xywh(15000, 15000, 100, 100).unwrap()]);
+    }
+}
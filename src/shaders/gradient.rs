@@ -4,6 +4,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+use alloc::sync::Arc;
 use alloc::vec::Vec;
 
 use crate::{Color, Transform, SpreadMode};
@@ -17,6 +18,13 @@ use crate::scalar::Scalar;
 // gradients defined in the wild.
 pub const DEGENERATE_THRESHOLD: f32 = 1.0 / (1 << 15) as f32;
 
+/// Gradients with more stops than this are rendered using a lookup table,
+/// because searching for a stop becomes slower than a table lookup.
+const LUT_STOPS_THRESHOLD: usize = 8;
+
+/// The number of lookup table cells.
+const LUT_CELLS: usize = 255;
+
 
 /// A gradient point.
 #[allow(missing_docs)]
@@ -44,6 +52,28 @@ pub struct Gradient {
     points_to_unit: Transform,
     pub(crate) colors_are_opaque: bool,
     has_uniform_stops: bool,
+    /// A premultiplied color lookup table.
+    ///
+    /// Stored in a `GradientCtx` format, where each cell interpolates between
+    /// two neighbour table colors. Shared with pipelines, since it's quite large.
+    lut: Option<Arc<GradientCtx>>,
+}
+
+impl PartialEq for Gradient {
+    fn eq(&self, other: &Self) -> bool {
+        self.tile_mode == other.tile_mode
+            && self.transform == other.transform
+            && self.points_to_unit == other.points_to_unit
+            && self.colors_are_opaque == other.colors_are_opaque
+            && self.has_uniform_stops == other.has_uniform_stops
+            && self.stops == other.stops
+            // Tables are large and are usually shared by clones, so pointers are checked first.
+            && match (&self.lut, &other.lut) {
+                (Some(a), Some(b)) => Arc::ptr_eq(a, b) || a == b,
+                (None, None) => true,
+                _ => false,
+            }
+    }
 }
 
 impl Gradient {
@@ -92,14 +122,17 @@ impl Gradient {
             prev = curr;
         }
 
-        Gradient {
+        let mut gradient = Gradient {
             stops,
             tile_mode,
             transform,
             points_to_unit,
             colors_are_opaque,
             has_uniform_stops,
-        }
+            lut: None,
+        };
+        gradient.lut = gradient.build_lut();
+        gradient
     }
 
     pub fn push_stages(
@@ -134,8 +167,11 @@ impl Gradient {
             }
         }
 
-        // The two-stop case with stops at 0 and 1.
-        if self.stops.len() == 2 {
+        if let Some(ref lut) = self.lut {
+            p.push(pipeline::Stage::GradientLut);
+            p.ctx.gradient_lut = Some(lut.clone());
+        } else if self.stops.len() == 2 {
+            // The two-stop case with stops at 0 and 1.
             debug_assert!(self.has_uniform_stops);
 
             let c0 = self.stops[0].color;
@@ -155,91 +191,12 @@ impl Gradient {
         } else {
             // Unlike Skia, we do not support the `evenly_spaced_gradient` stage.
             // In our case, there is no performance difference.
-
-            let mut ctx = GradientCtx::default();
-
-            // Note: In order to handle clamps in search, the search assumes
-            // a stop conceptually placed at -inf.
-            // Therefore, the max number of stops is `self.points.len()+1`.
-            //
-            // We also need at least 16 values for lowp pipeline.
-            ctx.factors.reserve((self.stops.len() + 1).max(16));
-            ctx.biases.reserve((self.stops.len() + 1).max(16));
-
-            ctx.t_values.reserve(self.stops.len() + 1);
-
-            // Remove the dummy stops inserted by Gradient::new
-            // because they are naturally handled by the search method.
-            let (first_stop, last_stop) = if self.stops.len() > 2 {
-                let first = if self.stops[0].color != self.stops[1].color { 0 } else { 1 };
-
-                let len = self.stops.len();
-                let last = if self.stops[len - 2].color != self.stops[len - 1].color {
-                    len - 1
-                } else {
-                    len - 2
-                };
-                (first, last)
-            } else {
-                (0, 1)
-            };
-
-            let mut t_l = self.stops[first_stop].position.get();
-            let mut c_l = GradientColor::from(self.stops[first_stop].color);
-            ctx.push_const_color(c_l);
-            ctx.t_values.push(NormalizedF32::ZERO);
-            // N.B. lastStop is the index of the last stop, not one after.
-            for i in first_stop..last_stop {
-                let t_r = self.stops[i + 1].position.get();
-                let c_r = GradientColor::from(self.stops[i + 1].color);
-                debug_assert!(t_l <= t_r);
-                if t_l < t_r {
-                    // For each stop we calculate a bias B and a scale factor F, such that
-                    // for any t between stops n and n+1, the color we want is B[n] + F[n]*t.
-                    let f = GradientColor::new(
-                        (c_r.r - c_l.r) / (t_r - t_l),
-                        (c_r.g - c_l.g) / (t_r - t_l),
-                        (c_r.b - c_l.b) / (t_r - t_l),
-                        (c_r.a - c_l.a) / (t_r - t_l),
-                    );
-                    ctx.factors.push(f);
-
-                    ctx.biases.push(
-                        GradientColor::new(
-                            c_l.r - f.r * t_l,
-                            c_l.g - f.g * t_l,
-                            c_l.b - f.b * t_l,
-                            c_l.a - f.a * t_l,
-                        )
-                    );
-
-                    ctx.t_values.push(NormalizedF32::new_bounded(t_l));
-                }
-
-                t_l = t_r;
-                c_l = c_r;
-            }
-
-            ctx.push_const_color(c_l);
-            ctx.t_values.push(NormalizedF32::new_bounded(t_l));
-
-            ctx.len = ctx.factors.len();
-
-            // All lists must have the same length.
-            debug_assert_eq!(ctx.factors.len(), ctx.t_values.len());
-            debug_assert_eq!(ctx.biases.len(), ctx.t_values.len());
-
-            // Will with zeros until we have enough data to fit into F32x16.
-            while ctx.factors.len() < 16 {
-                ctx.factors.push(GradientColor::default());
-                ctx.biases.push(GradientColor::default());
-            }
-
             p.push(pipeline::Stage::Gradient);
-            p.ctx.gradient = ctx;
+            p.ctx.gradient = self.search_ctx();
         }
 
-        if !self.colors_are_opaque {
+        // Lookup table colors are already premultiplied.
+        if !self.colors_are_opaque && self.lut.is_none() {
             p.push(pipeline::Stage::Premultiply);
         }
 
@@ -254,5 +211,154 @@ impl Gradient {
         }
 
         self.colors_are_opaque = self.stops.iter().all(|p| p.color.is_opaque());
+        self.lut = self.build_lut();
+    }
+
+    /// Prepares per stop factors and biases for the `gradient` stage.
+    fn search_ctx(&self) -> GradientCtx {
+        let mut ctx = GradientCtx::default();
+
+        // Note: In order to handle clamps in search, the search assumes
+        // a stop conceptually placed at -inf.
+        // Therefore, the max number of stops is `self.points.len()+1`.
+        //
+        // We also need at least 16 values for lowp pipeline.
+        ctx.factors.reserve((self.stops.len() + 1).max(16));
+        ctx.biases.reserve((self.stops.len() + 1).max(16));
+
+        ctx.t_values.reserve(self.stops.len() + 1);
+
+        // Remove the dummy stops inserted by Gradient::new
+        // because they are naturally handled by the search method.
+        let (first_stop, last_stop) = if self.stops.len() > 2 {
+            let first = if self.stops[0].color != self.stops[1].color { 0 } else { 1 };
+
+            let len = self.stops.len();
+            let last = if self.stops[len - 2].color != self.stops[len - 1].color {
+                len - 1
+            } else {
+                len - 2
+            };
+            (first, last)
+        } else {
+            (0, 1)
+        };
+
+        let mut t_l = self.stops[first_stop].position.get();
+        let mut c_l = GradientColor::from(self.stops[first_stop].color);
+        ctx.push_const_color(c_l);
+        ctx.t_values.push(NormalizedF32::ZERO);
+        // N.B. lastStop is the index of the last stop, not one after.
+        for i in first_stop..last_stop {
+            let t_r = self.stops[i + 1].position.get();
+            let c_r = GradientColor::from(self.stops[i + 1].color);
+            debug_assert!(t_l <= t_r);
+            if t_l < t_r {
+                // For each stop we calculate a bias B and a scale factor F, such that
+                // for any t between stops n and n+1, the color we want is B[n] + F[n]*t.
+                let f = GradientColor::new(
+                    (c_r.r - c_l.r) / (t_r - t_l),
+                    (c_r.g - c_l.g) / (t_r - t_l),
+                    (c_r.b - c_l.b) / (t_r - t_l),
+                    (c_r.a - c_l.a) / (t_r - t_l),
+                );
+                ctx.factors.push(f);
+
+                ctx.biases.push(
+                    GradientColor::new(
+                        c_l.r - f.r * t_l,
+                        c_l.g - f.g * t_l,
+                        c_l.b - f.b * t_l,
+                        c_l.a - f.a * t_l,
+                    )
+                );
+
+                ctx.t_values.push(NormalizedF32::new_bounded(t_l));
+            }
+
+            t_l = t_r;
+            c_l = c_r;
+        }
+
+        ctx.push_const_color(c_l);
+        ctx.t_values.push(NormalizedF32::new_bounded(t_l));
+
+        ctx.len = ctx.factors.len();
+
+        // All lists must have the same length.
+        debug_assert_eq!(ctx.factors.len(), ctx.t_values.len());
+        debug_assert_eq!(ctx.biases.len(), ctx.t_values.len());
+
+        // Will with zeros until we have enough data to fit into F32x16.
+        while ctx.factors.len() < 16 {
+            ctx.factors.push(GradientColor::default());
+            ctx.biases.push(GradientColor::default());
+        }
+
+        ctx
+    }
+
+    /// Builds a lookup table for the `gradient_lut` stage.
+    ///
+    /// Only gradients with a lot of stops and without hard stops are using a table.
+    /// With hard stops, a table cell would blur the stop and clamping of `t`
+    /// in the pad mode would no longer be correct.
+    fn build_lut(&self) -> Option<Arc<GradientCtx>> {
+        if self.stops.len() <= LUT_STOPS_THRESHOLD {
+            return None;
+        }
+
+        let has_hard_stops = self.stops.windows(2)
+            .any(|w| w[0].position.get() >= w[1].position.get());
+        if has_hard_stops {
+            return None;
+        }
+
+        let search = self.search_ctx();
+        let color_at = |t: f32| {
+            // The same as the `gradient` stage.
+            let idx = (1..search.len).filter(|i| t >= search.t_values[*i].get()).count();
+            let f = search.factors[idx];
+            let b = search.biases[idx];
+            let a = f.a * t + b.a;
+            GradientColor::new((f.r * t + b.r) * a, (f.g * t + b.g) * a, (f.b * t + b.b) * a, a)
+        };
+
+        let mut ctx = GradientCtx::default();
+        ctx.factors.reserve(LUT_CELLS + 1);
+        ctx.biases.reserve(LUT_CELLS + 1);
+
+        // For each cell we calculate a bias B and a scale factor F, such that
+        // for any t inside of the cell, the color is B[n] + F[n]*t.
+        let step = 1.0 / LUT_CELLS as f32;
+        let mut c_l = color_at(0.0);
+        for i in 0..LUT_CELLS {
+            let t_l = i as f32 * step;
+            let c_r = color_at((i + 1) as f32 * step);
+            let f = GradientColor::new(
+                (c_r.r - c_l.r) * LUT_CELLS as f32,
+                (c_r.g - c_l.g) * LUT_CELLS as f32,
+                (c_r.b - c_l.b) * LUT_CELLS as f32,
+                (c_r.a - c_l.a) * LUT_CELLS as f32,
+            );
+            ctx.factors.push(f);
+
+            ctx.biases.push(
+                GradientColor::new(
+                    c_l.r - f.r * t_l,
+                    c_l.g - f.g * t_l,
+                    c_l.b - f.b * t_l,
+                    c_l.a - f.a * t_l,
+                )
+            );
+
+            c_l = c_r;
+        }
+
+        // `t` equal to 1 is the only value that goes past the last cell.
+        ctx.push_const_color(c_l);
+        ctx.len = ctx.factors.len();
+
+        Some(Arc::new(ctx))
     }
 }
@@ -65,7 +65,7 @@ impl Default for PixmapPaint {
 ///
 /// Unlike Skia, we do not support FilterQuality::Medium, because it involves
 /// mipmap generation, which adds too much complexity.
-#[derive(Clone, Debug)]
+#[derive(Clone, PartialEq, Debug)]
 pub struct Pattern<'a> {
     pub(crate) pixmap: PixmapRef<'a>,
     quality: FilterQuality,
@@ -95,6 +95,44 @@ impl<'a> Pattern<'a> {
         })
     }
 
+    /// Checks that patterns have the same parameters and reference the same pixels.
+    ///
+    /// Unlike `==`, pixels are not compared, which is way too expensive.
+    pub(crate) fn is_same(&self, other: &Self) -> bool {
+        self.pixmap.ptr_eq(&other.pixmap)
+            && self.quality == other.quality
+            && self.spread_mode == other.spread_mode
+            && self.opacity == other.opacity
+            && self.transform == other.transform
+    }
+
+    /// Returns the pattern offset when it can be copied onto the destination as is.
+    ///
+    /// This is the case for an opaque, padded pattern with an integer translate,
+    /// where each destination pixel maps exactly onto a single source one.
+    pub(crate) fn sprite_offset(&self) -> Option<(i32, i32)> {
+        if self.opacity != NormalizedF32::ONE || self.spread_mode != SpreadMode::Pad {
+            return None;
+        }
+
+        let ts = self.transform;
+        if !(ts.is_identity() || ts.is_translate()) {
+            return None;
+        }
+
+        if ts.tx != ts.tx.trunc() || ts.ty != ts.ty.trunc() {
+            return None;
+        }
+
+        // Pixel centers must stay exact in f32.
+        const LIMIT: f32 = (1 << 22) as f32;
+        if ts.tx.abs() >= LIMIT || ts.ty.abs() >= LIMIT {
+            return None;
+        }
+
+        Some((ts.tx as i32, ts.ty as i32))
+    }
+
     pub(crate) fn push_stages(&self, p: &mut RasterPipelineBuilder) -> Option<()> {
         let ts = self.transform.invert()?;
 
@@ -17,7 +17,7 @@ use crate::pipeline::RasterPipelineBuilder;
 #[cfg(all(not(feature = "std"), feature = "libm"))]
 use crate::scalar::FloatExt;
 
-#[derive(Copy, Clone, Debug)]
+#[derive(Copy, Clone, PartialEq, Debug)]
 struct FocalData {
     r1: f32, // r1 after mapping focal point to (0, 0)
 }
@@ -43,7 +43,7 @@ impl FocalData {
 ///
 /// This is not `SkRadialGradient` like in Skia, but rather `SkTwoPointConicalGradient`
 /// without the start radius.
-#[derive(Clone, Debug)]
+#[derive(Clone, PartialEq, Debug)]
 pub struct RadialGradient {
     pub(crate) base: Gradient,
     center1: Point,
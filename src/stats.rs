@@ -0,0 +1,96 @@
+// Copyright 2020 Evgeniy Reizner
+//
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+//! Optional rendering statistics.
+//!
+//! Counters are updated only when the `stats` build feature is enabled.
+//! Otherwise, `count!` expands to nothing.
+
+/// Increments a rendering statistics counter.
+macro_rules! count {
+    ($counter:ident) => {
+        count!($counter, 1)
+    };
+    ($counter:ident, $n:expr) => {
+        #[cfg(feature = "stats")]
+        {
+            crate::stats::counters::$counter.fetch_add(
+                $n as usize, core::sync::atomic::Ordering::Relaxed,
+            );
+        }
+    };
+}
+
+#[cfg(feature = "stats")]
+macro_rules! render_stats {
+    ($($(#[$doc:meta])* $name:ident => $counter:ident,)+) => {
+        /// Rendering statistics.
+        ///
+        /// Counters are global and are updated by all threads.
+        /// Use [`RenderStats::reset`](#method.reset) before and
+        /// [`RenderStats::get`](#method.get) after the rendering you're interested in.
+        ///
+        /// Requires the `stats` build feature.
+        #[derive(Clone, Copy, Default, PartialEq, Eq, Debug)]
+        pub struct RenderStats {
+            $($(#[$doc])* pub $name: usize,)+
+        }
+
+        impl RenderStats {
+            /// Returns current counter values.
+            pub fn get() -> Self {
+                RenderStats {
+                    $($name: counters::$counter.load(Ordering::Relaxed),)+
+                }
+            }
+
+            /// Resets all counters to zero.
+            pub fn reset() {
+                $(counters::$counter.store(0, Ordering::Relaxed);)+
+            }
+        }
+
+        pub(crate) mod counters {
+            use core::sync::atomic::AtomicUsize;
+
+            $(pub static $counter: AtomicUsize = AtomicUsize::new(0);)+
+        }
+    };
+}
+
+#[cfg(feature = "stats")]
+use core::sync::atomic::Ordering;
+
+#[cfg(feature = "stats")]
+render_stats! {
+    /// The number of created low precision pipelines.
+    lowp_pipelines => LOWP_PIPELINES,
+    /// The number of created high precision pipelines.
+    ///
+    /// A pipeline falls back to high precision when `Paint::force_hq_pipeline` is set
+    /// or when any of its stages is not supported by the low precision one.
+    highp_pipelines => HIGHP_PIPELINES,
+    /// The number of pipeline programs actually compiled.
+    ///
+    /// Smaller than the number of created pipelines, when programs are reused from a cache.
+    compiled_pipelines => COMPILED_PIPELINES,
+    /// The total number of stages in all created pipelines.
+    pipeline_stages => PIPELINE_STAGES,
+    /// The number of pixels blitted with a partial anti-aliasing coverage.
+    anti_h_pixels => ANTI_H_PIXELS,
+    /// The number of pixels blitted as rectangles by the pipeline.
+    rect_pixels => RECT_PIXELS,
+    /// The number of pixels blitted using a coverage mask.
+    mask_pixels => MASK_PIXELS,
+    /// The number of pixels filled with a solid color without the pipeline.
+    memset_pixels => MEMSET_PIXELS,
+    /// The number of built path edges.
+    edges => EDGES,
+    /// The number of walked scanlines, including supersampled ones.
+    scanlines => SCANLINES,
+    /// The number of anti-aliased fills that fell back to aliased ones,
+    /// because the path was too large to be supersampled.
+    supersampling_fallbacks => SUPERSAMPLING_FALLBACKS,
+}
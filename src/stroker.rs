@@ -8,6 +8,7 @@
 
 use crate::{Path, Point, PathBuilder, Transform, PathSegment, PathSegmentsIter, StrokeDash};
 
+use crate::dash::ContourMeasure;
 use crate::floating_point::{NormalizedF32, NonZeroPositiveF32, NormalizedF32Exclusive};
 use crate::path_builder::PathDirection;
 use crate::path_geometry;
@@ -126,6 +127,35 @@ impl Default for LineJoin {
 }
 
 
+/// Reusable stroking buffers.
+///
+/// Stroking requires a few temporary paths: a dashed one, a stroked one
+/// and a transformed one. A context keeps their allocations between
+/// [`PixmapMut::stroke_path_with_context`] calls, so once the buffers
+/// are large enough, stroking doesn't allocate them again.
+///
+/// [`PixmapMut::stroke_path_with_context`]:
+/// struct.PixmapMut.html#method.stroke_path_with_context
+#[allow(missing_debug_implementations)]
+#[derive(Clone, Default)]
+pub struct StrokeContext {
+    pub(crate) stroker: PathStroker,
+    pub(crate) contour: ContourMeasure,
+    pub(crate) dashed: PathBuilder,
+    /// A stroked or a transformed path.
+    pub(crate) path: PathBuilder,
+}
+
+impl StrokeContext {
+    /// Creates a new context.
+    ///
+    /// Doesn't allocate.
+    pub fn new() -> Self {
+        StrokeContext::default()
+    }
+}
+
+
 // const TANGENT_RECURSIVE_LIMIT: usize = 0;
 // const CUBIC_RECURSIVE_LIMIT: usize = 1;
 // const CONIC_RECURSIVE_LIMIT: usize = 2;
@@ -210,6 +240,8 @@ pub struct PathStroker {
 
     capper: CapProc,
     joiner: JoinProc,
+    line_cap: LineCap,
+    last_segment_is_line: bool,
 
     // outer is our working answer, inner is temp
     inner: PathBuilder,
@@ -254,6 +286,8 @@ impl PathStroker {
 
             capper: butt_capper,
             joiner: miter_joiner,
+            line_cap: LineCap::Butt,
+            last_segment_is_line: false,
 
             inner: PathBuilder::new(),
             outer: PathBuilder::new(),
@@ -302,15 +336,80 @@ impl PathStroker {
         self.stroke_inner(path, width, stroke.miter_limit, stroke.line_cap, stroke.line_join, res_scale)
     }
 
+    /// Stokes the path into the `buf`, reusing its allocations.
+    pub(crate) fn stroke_into(
+        &mut self,
+        path: &Path,
+        stroke: &Stroke,
+        res_scale: f32,
+        buf: PathBuilder,
+    ) -> Option<Path> {
+        self.outer = buf;
+        self.stroke(path, stroke, res_scale)
+    }
+
+    /// Strokes a dashed path into the `buf`, without building the dashed path first.
+    ///
+    /// Each dash is stroked as soon as it's produced, so only a single dash
+    /// is stored in `dash_buf` at a time. The result is identical to stroking
+    /// a path returned by `dash`.
+    pub(crate) fn stroke_dashed_into(
+        &mut self,
+        path: &Path,
+        stroke: &Stroke,
+        dash: &StrokeDash,
+        res_scale: f32,
+        contour: &mut ContourMeasure,
+        dash_buf: &mut PathBuilder,
+        buf: PathBuilder,
+    ) -> Option<Path> {
+        let width = NonZeroPositiveF32::new(stroke.width)?;
+        self.outer = buf;
+        self.begin(path, width, stroke.miter_limit, stroke.line_cap, stroke.line_join, res_scale);
+
+        let mut flush = |pb: &mut PathBuilder| {
+            // A single move to is ignored by both the builder and the stroker.
+            if pb.len() <= 1 {
+                pb.clear();
+                return Some(());
+            }
+
+            let dash = core::mem::replace(pb, PathBuilder::new()).finish()?;
+            self.push_path(&dash);
+            *pb = dash.clear();
+            Some(())
+        };
+
+        crate::dash::dash_impl(path, dash, res_scale, contour, dash_buf, &mut flush)?;
+        self.end()
+    }
+
     fn stroke_inner(
         &mut self,
         path: &Path,
         width: NonZeroPositiveF32,
         miter_limit: f32,
         line_cap: LineCap,
-        mut line_join: LineJoin,
+        line_join: LineJoin,
         res_scale: f32,
     ) -> Option<Path> {
+        self.begin(path, width, miter_limit, line_cap, line_join, res_scale);
+        self.push_path(path);
+        self.end()
+    }
+
+    /// Prepares the stroker for a new path.
+    ///
+    /// `path` is used only to estimate the output size.
+    fn begin(
+        &mut self,
+        path: &Path,
+        width: NonZeroPositiveF32,
+        miter_limit: f32,
+        line_cap: LineCap,
+        mut line_join: LineJoin,
+        res_scale: f32,
+    ) {
         // TODO: stroke_rect optimization
 
         let mut inv_miter_limit = 0.0;
@@ -346,6 +445,8 @@ impl PathStroker {
 
         self.capper = cap_factory(line_cap);
         self.joiner = join_factory(line_join);
+        self.line_cap = line_cap;
+        self.last_segment_is_line = false;
 
         // Need some estimate of how large our final result (fOuter)
         // and our per-contour temp (fInner) will be, so we don't spend
@@ -366,8 +467,14 @@ impl PathStroker {
         self.recursion_depth = 0;
         self.found_tangents = false;
         self.join_completed = false;
+    }
 
-        let mut last_segment_is_line = false;
+    /// Strokes path segments.
+    ///
+    /// Can be called multiple times per `begin`, which is the same as stroking
+    /// a single path that contains all of the segments.
+    fn push_path(&mut self, path: &Path) {
+        let line_cap = self.line_cap;
         let mut iter = path.segments();
         iter.set_auto_close(true);
         while let Some(segment) = iter.next() {
@@ -377,15 +484,15 @@ impl PathStroker {
                 }
                 PathSegment::LineTo(p) => {
                     self.line_to(p, Some(&iter));
-                    last_segment_is_line = true;
+                    self.last_segment_is_line = true;
                 }
                 PathSegment::QuadTo(p1, p2) => {
                     self.quad_to(p1, p2);
-                    last_segment_is_line = false;
+                    self.last_segment_is_line = false;
                 }
                 PathSegment::CubicTo(p1, p2, p3) => {
                     self.cubic_to(p1, p2, p3);
-                    last_segment_is_line = false;
+                    self.last_segment_is_line = false;
                 }
                 PathSegment::Close => {
                     if line_cap != LineCap::Butt {
@@ -394,7 +501,7 @@ impl PathStroker {
                         // can have square and round end caps.
                         if self.has_only_move_to() {
                             self.line_to(self.move_to_pt(), None);
-                            last_segment_is_line = true;
+                            self.last_segment_is_line = true;
                             continue;
                         }
 
@@ -402,17 +509,22 @@ impl PathStroker {
                         // verbs, then followed by a close, treat is as if it were followed by a
                         // zero-length line. Lines without length can have square & round end caps.
                         if self.is_current_contour_empty() {
-                            last_segment_is_line = true;
+                            self.last_segment_is_line = true;
                             continue;
                         }
                     }
 
-                    self.close(last_segment_is_line);
+                    let is_line = self.last_segment_is_line;
+                    self.close(is_line);
                 }
             }
         }
+    }
 
-        self.finish(last_segment_is_line)
+    /// Finishes the current path and returns the stroked one.
+    fn end(&mut self) -> Option<Path> {
+        let is_line = self.last_segment_is_line;
+        self.finish(is_line)
     }
 
     fn builders(&mut self) -> SwappableBuilders {
@@ -2145,4 +2257,37 @@ mod tests {
 
         assert!(PathStroker::new().stroke(&path, &stroke, 1.0).is_some());
     }
+
+    #[test]
+    fn stroke_dashed_matches_dash() {
+        let mut pb = PathBuilder::new();
+        pb.move_to(10.0, 20.0);
+        pb.line_to(90.0, 20.0);
+        pb.quad_to(95.0, 60.0, 50.0, 90.0);
+        pb.close();
+        pb.move_to(20.0, 40.0);
+        pb.cubic_to(80.0, 10.0, 10.0, 90.0, 70.0, 70.0);
+        pb.line_to(75.0, 75.0);
+        let path = pb.finish().unwrap();
+
+        for &line_cap in &[LineCap::Butt, LineCap::Square, LineCap::Round] {
+            for &offset in &[0.0, 3.0, 11.5] {
+                let dash = StrokeDash::new(alloc::vec![7.0, 3.0, 2.0, 3.0], offset).unwrap();
+                let mut stroke = Stroke::default();
+                stroke.width = 3.0;
+                stroke.line_cap = line_cap;
+
+                let dashed = crate::dash::dash(&path, &dash, 1.0).unwrap();
+                let expected = PathStroker::new().stroke(&dashed, &stroke, 1.0).unwrap();
+
+                let mut contour = ContourMeasure::default();
+                let mut dash_buf = PathBuilder::new();
+                let streamed = PathStroker::new().stroke_dashed_into(
+                    &path, &stroke, &dash, 1.0, &mut contour, &mut dash_buf, PathBuilder::new(),
+                ).unwrap();
+
+                assert!(streamed == expected);
+            }
+        }
+    }
 }
@@ -256,6 +256,49 @@ void skiac_canvas_restore(skiac_canvas* c_canvas)
     CANVAS_CAST->restore();
 }
 
+// Scene
+
+void skiac_canvas_draw_scene(
+    skiac_canvas* c_canvas,
+    const skiac_scene_command* commands,
+    int count)
+{
+    auto canvas = CANVAS_CAST;
+    for (int i = 0; i < count; i++) {
+        const auto &command = commands[i];
+        switch (command.kind) {
+            case SKIAC_SCENE_DRAW_PATH:
+                canvas->setMatrix(conv_from_transform(command.transform));
+                canvas->drawPath(*reinterpret_cast<SkPath*>(command.path),
+                                 *reinterpret_cast<SkPaint*>(command.paint));
+                break;
+            case SKIAC_SCENE_PUSH_CLIP:
+                canvas->save();
+                canvas->setMatrix(conv_from_transform(command.transform));
+                canvas->clipPath(*reinterpret_cast<SkPath*>(command.path), command.anti_alias);
+                break;
+            case SKIAC_SCENE_POP_CLIP:
+                canvas->restore();
+                break;
+        }
+    }
+
+    canvas->resetMatrix();
+}
+
+void skiac_canvas_draw_scene_frames(
+    skiac_canvas* c_canvas,
+    const skiac_scene_command* commands,
+    int count,
+    uint32_t background,
+    int frames)
+{
+    for (int i = 0; i < frames; i++) {
+        CANVAS_CAST->clear(static_cast<SkColor>(background));
+        skiac_canvas_draw_scene(c_canvas, commands, count);
+    }
+}
+
 // Paint
 
 skiac_paint* skiac_paint_create()
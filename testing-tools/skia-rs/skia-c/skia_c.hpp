@@ -29,6 +29,24 @@ struct skiac_surface_data {
     uint32_t size;
 };
 
+enum skiac_scene_command_kind {
+    SKIAC_SCENE_DRAW_PATH = 0,
+    SKIAC_SCENE_PUSH_CLIP = 1,
+    SKIAC_SCENE_POP_CLIP = 2,
+};
+
+// A single scene replay step.
+//
+// `paint` is used only by SKIAC_SCENE_DRAW_PATH and `anti_alias` only by SKIAC_SCENE_PUSH_CLIP.
+// SKIAC_SCENE_POP_CLIP ignores everything.
+struct skiac_scene_command {
+    int kind;
+    skiac_path *path;
+    skiac_paint *paint;
+    skiac_transform transform;
+    bool anti_alias;
+};
+
 extern "C" {
 
 // Surface
@@ -81,6 +99,18 @@ void skiac_canvas_clip_path(skiac_canvas* c_canvas, skiac_path* c_path, bool aa)
 void skiac_canvas_save(skiac_canvas* c_canvas);
 void skiac_canvas_restore(skiac_canvas* c_canvas);
 
+// Scene
+void skiac_canvas_draw_scene(
+    skiac_canvas* c_canvas,
+    const skiac_scene_command* commands,
+    int count);
+void skiac_canvas_draw_scene_frames(
+    skiac_canvas* c_canvas,
+    const skiac_scene_command* commands,
+    int count,
+    uint32_t background,
+    int frames);
+
 // Paint
 skiac_paint* skiac_paint_create();
 void skiac_paint_destroy(skiac_paint* c_paint);
@@ -53,6 +53,20 @@ mod ffi {
         pub size: u32,
     }
 
+    pub const SKIAC_SCENE_DRAW_PATH: i32 = 0;
+    pub const SKIAC_SCENE_PUSH_CLIP: i32 = 1;
+    pub const SKIAC_SCENE_POP_CLIP: i32 = 2;
+
+    #[repr(C)]
+    #[derive(Copy, Clone, Debug)]
+    pub struct skiac_scene_command {
+        pub kind: i32,
+        pub path: *mut skiac_path,
+        pub paint: *mut skiac_paint,
+        pub transform: skiac_transform,
+        pub anti_alias: bool,
+    }
+
     extern "C" {
 
         pub fn skiac_surface_create_rgba_premultiplied(
@@ -193,6 +207,20 @@ mod ffi {
             canvas: *mut skiac_canvas,
         );
 
+        pub fn skiac_canvas_draw_scene(
+            canvas: *mut skiac_canvas,
+            commands: *const skiac_scene_command,
+            count: i32,
+        );
+
+        pub fn skiac_canvas_draw_scene_frames(
+            canvas: *mut skiac_canvas,
+            commands: *const skiac_scene_command,
+            count: i32,
+            background: u32,
+            frames: i32,
+        );
+
         pub fn skiac_paint_create() -> *mut skiac_paint;
 
         pub fn skiac_paint_destroy(
@@ -767,6 +795,96 @@ impl Canvas {
     pub fn restore(&mut self) {
         unsafe { ffi::skiac_canvas_restore(self.0); }
     }
+
+    /// Replays the whole scene using a single call.
+    #[inline]
+    pub fn draw_scene(&mut self, scene: &Scene) {
+        unsafe {
+            ffi::skiac_canvas_draw_scene(
+                self.0, scene.commands.as_ptr(), scene.commands.len() as i32,
+            );
+        }
+    }
+
+    /// Clears the canvas with `background` and replays the scene, `frames` times.
+    #[inline]
+    pub fn draw_scene_frames(&mut self, scene: &Scene, background: Color, frames: u32) {
+        unsafe {
+            ffi::skiac_canvas_draw_scene_frames(
+                self.0, scene.commands.as_ptr(), scene.commands.len() as i32,
+                background.0, frames as i32,
+            );
+        }
+    }
+}
+
+
+/// A list of drawing commands that can be replayed without crossing the FFI boundary
+/// for each of them.
+///
+/// The scene owns all paths and paints it references.
+pub struct Scene {
+    paths: Vec<Path>,
+    paints: Vec<Paint>,
+    commands: Vec<ffi::skiac_scene_command>,
+}
+
+impl Scene {
+    #[inline]
+    pub fn new() -> Scene {
+        Scene {
+            paths: Vec::new(),
+            paints: Vec::new(),
+            commands: Vec::new(),
+        }
+    }
+
+    /// Draws a path with the canvas transform set to `ts`.
+    #[inline]
+    pub fn draw_path(&mut self, path: Path, paint: Paint, ts: Transform) {
+        self.commands.push(ffi::skiac_scene_command {
+            kind: ffi::SKIAC_SCENE_DRAW_PATH,
+            path: path.0,
+            paint: paint.0,
+            transform: ts.into(),
+            anti_alias: false,
+        });
+
+        self.paths.push(path);
+        self.paints.push(paint);
+    }
+
+    /// Saves the canvas state and intersects the clip with a path transformed by `ts`.
+    #[inline]
+    pub fn push_clip_path(&mut self, path: Path, ts: Transform, aa: bool) {
+        self.commands.push(ffi::skiac_scene_command {
+            kind: ffi::SKIAC_SCENE_PUSH_CLIP,
+            path: path.0,
+            paint: std::ptr::null_mut(),
+            transform: ts.into(),
+            anti_alias: aa,
+        });
+
+        self.paths.push(path);
+    }
+
+    /// Restores the canvas state saved by the matching `push_clip_path`.
+    #[inline]
+    pub fn pop_clip(&mut self) {
+        self.commands.push(ffi::skiac_scene_command {
+            kind: ffi::SKIAC_SCENE_POP_CLIP,
+            path: std::ptr::null_mut(),
+            paint: std::ptr::null_mut(),
+            transform: Transform::default().into(),
+            anti_alias: false,
+        });
+    }
+
+    /// Returns the number of commands.
+    #[inline]
+    pub fn len(&self) -> usize {
+        self.commands.len()
+    }
 }
 
 pub struct Paint(*mut ffi::skiac_paint);
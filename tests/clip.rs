@@ -173,3 +173,117 @@ fn ignore_memset() {
     let expected = Pixmap::load_png("tests/images/clip/ignore-memset.png").unwrap();
     assert_eq!(pixmap, expected);
 }
+
+#[test]
+fn rect_matches_path() {
+    // An integer rectangle is stored without a coverage mask,
+    // while the same rectangle with an extra point on an edge is rasterized.
+    let rect_path = PathBuilder::from_rect(Rect::from_xywh(10.0, 20.0, 60.0, 50.0).unwrap());
+    let mut pb = PathBuilder::new();
+    pb.move_to(10.0, 20.0);
+    pb.line_to(40.0, 20.0);
+    pb.line_to(70.0, 20.0);
+    pb.line_to(70.0, 70.0);
+    pb.line_to(10.0, 70.0);
+    pb.close();
+    let poly_path = pb.finish().unwrap();
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let mut pb = PathBuilder::new();
+    pb.push_rect(5.5, 5.5, 80.0, 80.0);
+    pb.push_circle(40.0, 45.0, 20.0);
+    let path = pb.finish().unwrap();
+
+    let circle = PathBuilder::from_circle(50.0, 50.0, 35.0).unwrap();
+
+    for &anti_alias in &[false, true] {
+        let mut rect_mask = ClipMask::new();
+        rect_mask.set_path(100, 100, &rect_path, FillRule::Winding, anti_alias);
+        let mut poly_mask = ClipMask::new();
+        poly_mask.set_path(100, 100, &poly_path, FillRule::Winding, anti_alias);
+
+        let mut pixmap1 = Pixmap::new(100, 100).unwrap();
+        pixmap1.fill_path(&path, &paint, FillRule::EvenOdd, Transform::identity(), Some(&rect_mask));
+
+        let mut pixmap2 = Pixmap::new(100, 100).unwrap();
+        pixmap2.fill_path(&path, &paint, FillRule::EvenOdd, Transform::identity(), Some(&poly_mask));
+
+        assert_eq!(pixmap1, pixmap2);
+
+        // Intersecting both must not produce a different result either.
+        rect_mask.intersect_path(&circle, FillRule::Winding, true);
+        poly_mask.intersect_path(&circle, FillRule::Winding, true);
+
+        let rect = Rect::from_xywh(0.0, 0.0, 100.0, 100.0).unwrap();
+        let mut pixmap1 = Pixmap::new(100, 100).unwrap();
+        pixmap1.fill_rect(rect, &paint, Transform::identity(), Some(&rect_mask));
+
+        let mut pixmap2 = Pixmap::new(100, 100).unwrap();
+        pixmap2.fill_rect(rect, &paint, Transform::identity(), Some(&poly_mask));
+
+        assert_eq!(pixmap1, pixmap2);
+    }
+}
+
+#[test]
+fn outside_canvas() {
+    let clip_path = PathBuilder::from_rect(Rect::from_xywh(150.0, 10.0, 80.0, 80.0).unwrap());
+    let mut clip_mask = ClipMask::new();
+    clip_mask.set_path(100, 100, &clip_path, FillRule::Winding, true);
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    let rect = Rect::from_xywh(0.0, 0.0, 100.0, 100.0).unwrap();
+    pixmap.fill_rect(rect, &paint, Transform::identity(), Some(&clip_mask));
+
+    assert_eq!(pixmap, Pixmap::new(100, 100).unwrap());
+}
+
+#[test]
+fn intersect_rects() {
+    let mut clip_mask = ClipMask::new();
+    let rect1 = PathBuilder::from_rect(Rect::from_xywh(10.0, 10.0, 60.0, 60.0).unwrap());
+    clip_mask.set_path(100, 100, &rect1, FillRule::Winding, true);
+    let rect2 = PathBuilder::from_rect(Rect::from_xywh(30.0, 20.0, 60.0, 30.0).unwrap());
+    clip_mask.intersect_path(&rect2, FillRule::Winding, true);
+
+    let mut expected_mask = ClipMask::new();
+    let rect3 = PathBuilder::from_rect(Rect::from_xywh(30.0, 20.0, 40.0, 30.0).unwrap());
+    expected_mask.set_path(100, 100, &rect3, FillRule::Winding, true);
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+
+    let rect = Rect::from_xywh(0.0, 0.0, 100.0, 100.0).unwrap();
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    pixmap.fill_rect(rect, &paint, Transform::identity(), Some(&clip_mask));
+
+    let mut expected = Pixmap::new(100, 100).unwrap();
+    expected.fill_rect(rect, &paint, Transform::identity(), Some(&expected_mask));
+
+    assert_eq!(pixmap, expected);
+}
+
+#[test]
+fn intersect_disjoint() {
+    let circle1 = PathBuilder::from_circle(25.0, 25.0, 20.0).unwrap();
+    let circle2 = PathBuilder::from_circle(75.0, 75.0, 20.0).unwrap();
+
+    let mut clip_mask = ClipMask::new();
+    clip_mask.set_path(100, 100, &circle1, FillRule::Winding, true);
+    clip_mask.intersect_path(&circle2, FillRule::Winding, true);
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    let rect = Rect::from_xywh(0.0, 0.0, 100.0, 100.0).unwrap();
+    pixmap.fill_rect(rect, &paint, Transform::identity(), Some(&clip_mask));
+
+    assert_eq!(pixmap, Pixmap::new(100, 100).unwrap());
+}
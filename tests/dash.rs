@@ -165,3 +165,47 @@ fn closed() {
     let expected = Pixmap::load_png("tests/images/dash/closed.png").unwrap();
     assert_eq!(pixmap, expected);
 }
+
+#[test]
+fn reuse_context() {
+    let mut pb = PathBuilder::new();
+    pb.move_to(10.0, 20.0);
+    pb.cubic_to(95.0, 5.0, 5.0, 95.0, 90.0, 80.0);
+    let path = pb.finish().unwrap();
+
+    let circle = PathBuilder::from_circle(50.0, 50.0, 30.0).unwrap();
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let mut dashed = Stroke::default();
+    dashed.dash = StrokeDash::new(vec![5.0, 10.0], 0.0);
+    dashed.width = 2.0;
+
+    let mut wide = Stroke::default();
+    wide.width = 6.0;
+    wide.line_join = LineJoin::Round;
+
+    let mut hairline = Stroke::default();
+    hairline.width = 0.5;
+    hairline.dash = StrokeDash::new(vec![3.0, 2.0], 1.0);
+
+    let ts = Transform::from_row(0.9, 0.1, -0.2, 1.1, 5.0, -3.0);
+
+    let mut context = StrokeContext::new();
+    let mut expected = Pixmap::new(100, 100).unwrap();
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    for _ in 0..2 {
+        for stroke in &[&dashed, &wide, &hairline] {
+            for p in &[&path, &circle] {
+                for ts in &[Transform::identity(), ts] {
+                    expected.stroke_path(p, &paint, stroke, *ts, None);
+                    pixmap.stroke_path_with_context(p, &paint, stroke, *ts, None, &mut context);
+                }
+            }
+        }
+    }
+
+    assert_eq!(pixmap, expected);
+}
@@ -0,0 +1,80 @@
+use tiny_skia::*;
+
+#[test]
+fn draw_tracking() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let circle = PathBuilder::from_circle(100.0, 100.0, 10.0).unwrap();
+    let line = PathBuilder::from_rect(Rect::from_xywh(10.0, 180.0, 280.0, 0.5).unwrap());
+
+    let mut pixmap = Pixmap::new(300, 200).unwrap();
+    let mut region = DirtyRegion::new(300, 200).unwrap();
+    assert!(region.is_empty());
+
+    {
+        let mut pixmap = pixmap.as_mut().with_dirty_region(&mut region).unwrap();
+        pixmap.fill_path(&circle, &paint, FillRule::Winding, Transform::identity(), None);
+        pixmap.fill_path(&line, &paint, FillRule::Winding, Transform::identity(), None);
+    }
+
+    assert_eq!(region.rects(), vec![
+        IntRect::from_xywh(64, 64, 64, 64).unwrap(),
+        IntRect::from_xywh(0, 128, 300, 64).unwrap(),
+    ]);
+
+    // Nothing outside the region was changed.
+    let mut expected = pixmap.clone();
+    for rect in region.rects() {
+        let clean = Pixmap::new(rect.width(), rect.height()).unwrap();
+        expected.draw_pixmap(rect.x(), rect.y(), clean.as_ref(), &PixmapPaint {
+            blend_mode: BlendMode::Source,
+            ..PixmapPaint::default()
+        }, Transform::identity(), None);
+    }
+    assert!(expected.data().iter().all(|c| *c == 0));
+
+    region.clear();
+    assert!(region.is_empty());
+}
+
+#[test]
+fn size_mismatch() {
+    let mut pixmap = Pixmap::new(300, 200).unwrap();
+    let mut region = DirtyRegion::new(200, 300).unwrap();
+    assert!(pixmap.as_mut().with_dirty_region(&mut region).is_none());
+}
+
+#[test]
+fn merge_tiles() {
+    let mut region = DirtyRegion::new(300, 200).unwrap();
+    region.add_rect(IntRect::from_xywh(-10, -10, 210, 140).unwrap());
+    region.add_rect(IntRect::from_xywh(0, 190, 20, 5).unwrap());
+    assert_eq!(region.rects(), vec![
+        IntRect::from_xywh(0, 0, 256, 192).unwrap(),
+        IntRect::from_xywh(0, 192, 64, 8).unwrap(),
+    ]);
+}
+
+#[test]
+fn clip_mask() {
+    let mut region = DirtyRegion::new(200, 200).unwrap();
+    assert!(region.to_clip_mask().is_none());
+    region.add_rect(IntRect::from_xywh(10, 10, 10, 10).unwrap());
+    region.add_rect(IntRect::from_xywh(150, 150, 10, 10).unwrap());
+    let clip_mask = region.to_clip_mask().unwrap();
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+
+    let mut pixmap = Pixmap::new(200, 200).unwrap();
+    let rect = Rect::from_xywh(0.0, 0.0, 200.0, 200.0).unwrap();
+    pixmap.fill_rect(rect, &paint, Transform::identity(), Some(&clip_mask));
+
+    assert_ne!(pixmap.pixel(0, 0).unwrap().alpha(), 0);
+    assert_ne!(pixmap.pixel(191, 191).unwrap().alpha(), 0);
+    assert_eq!(pixmap.pixel(199, 199).unwrap().alpha(), 0);
+    assert_eq!(pixmap.pixel(100, 10).unwrap().alpha(), 0);
+    assert_eq!(pixmap.pixel(10, 100).unwrap().alpha(), 0);
+}
@@ -0,0 +1,130 @@
+use tiny_skia::*;
+
+// Display list drawing must produce exactly the same result as direct drawing.
+
+fn paints() -> Vec<Paint<'static>> {
+    let mut paint1 = Paint::default();
+    paint1.set_color_rgba8(50, 127, 150, 200);
+    paint1.anti_alias = true;
+
+    let mut paint2 = Paint::default();
+    paint2.set_color_rgba8(220, 140, 75, 180);
+
+    let mut paint3 = Paint::default();
+    paint3.anti_alias = true;
+    paint3.shader = LinearGradient::new(
+        Point::from_xy(10.0, 10.0),
+        Point::from_xy(190.0, 190.0),
+        vec![
+            GradientStop::new(0.0, Color::from_rgba8(50, 127, 150, 200)),
+            GradientStop::new(1.0, Color::from_rgba8(220, 140, 75, 180)),
+        ],
+        SpreadMode::Pad,
+        Transform::identity(),
+    ).unwrap();
+
+    vec![paint1, paint2, paint3]
+}
+
+#[test]
+fn scene() {
+    let paints = paints();
+
+    let clip_path = PathBuilder::from_circle(100.0, 100.0, 80.0).unwrap();
+    let mut clip_mask = ClipMask::new();
+    clip_mask.set_path(200, 200, &clip_path, FillRule::Winding, true);
+
+    let mut sprite = Pixmap::new(10, 10).unwrap();
+    sprite.fill(Color::from_rgba8(0, 200, 0, 127));
+
+    let mut stroke = Stroke::default();
+    stroke.width = 3.0;
+
+    let mut hairline = Stroke::default();
+    hairline.width = 0.5;
+
+    let mut expected = Pixmap::new(200, 200).unwrap();
+    let mut list = DisplayList::new();
+
+    for i in 0..40 {
+        let paint = &paints[i % paints.len()];
+        let x = (i * 37 % 230) as f32 - 20.0;
+        let y = (i * 53 % 230) as f32 - 20.0;
+        let ts = Transform::from_row(1.0, 0.1 * (i % 3) as f32, 0.0, 1.0, 0.0, 0.0);
+        let clip = if i % 5 == 0 { Some(&clip_mask) } else { None };
+
+        let rect = Rect::from_xywh(x, y, 30.5, 20.0).unwrap();
+        expected.fill_rect(rect, paint, Transform::identity(), clip);
+        list.fill_rect(rect, paint, Transform::identity(), clip);
+
+        let path = PathBuilder::from_circle(x + 15.0, y, 12.0).unwrap();
+        expected.fill_path(&path, paint, FillRule::Winding, ts, clip);
+        list.fill_path(path.clone(), paint, FillRule::Winding, ts, clip);
+
+        expected.stroke_path(&path, paint, &stroke, Transform::identity(), clip);
+        list.stroke_path(&path, paint, &stroke, Transform::identity(), clip);
+
+        expected.stroke_path(&path, paint, &hairline, ts, clip);
+        list.stroke_path(&path, paint, &hairline, ts, clip);
+
+        let ix = x as i32;
+        let iy = y as i32;
+        expected.draw_pixmap(ix, iy, sprite.as_ref(), &PixmapPaint::default(), ts, clip);
+        list.draw_pixmap(ix, iy, sprite.as_ref(), &PixmapPaint::default(), ts, clip);
+    }
+
+    let mut pixmap = Pixmap::new(200, 200).unwrap();
+    list.draw(&mut pixmap.as_mut());
+
+    assert_eq!(pixmap, expected);
+}
+
+#[test]
+fn outside_pixmap() {
+    let paints = paints();
+
+    let mut list = DisplayList::new();
+    list.fill_rect(Rect::from_xywh(-50.0, -50.0, 20.0, 20.0).unwrap(), &paints[0],
+                   Transform::identity(), None);
+    list.fill_path(PathBuilder::from_circle(500.0, 100.0, 20.0).unwrap(), &paints[1],
+                   FillRule::Winding, Transform::identity(), None);
+    assert_eq!(list.len(), 2);
+
+    let mut pixmap = Pixmap::new(200, 200).unwrap();
+    list.draw(&mut pixmap.as_mut());
+
+    assert_eq!(pixmap, Pixmap::new(200, 200).unwrap());
+}
+
+#[test]
+fn shared_pattern() {
+    let paints = paints();
+
+    let mut sprite = Pixmap::new(10, 10).unwrap();
+    sprite.fill(Color::from_rgba8(0, 200, 0, 127));
+
+    // Commands with the same pattern share a paint and are grouped.
+    let mut pattern = Paint::default();
+    pattern.shader = Pattern::new(
+        sprite.as_ref(),
+        SpreadMode::Repeat,
+        FilterQuality::Bilinear,
+        0.8,
+        Transform::from_row(1.5, 0.0, 0.2, 1.5, 3.0, 1.0),
+    );
+
+    let mut expected = Pixmap::new(200, 200).unwrap();
+    let mut list = DisplayList::new();
+    for i in 0..20 {
+        let paint = if i % 2 == 0 { &pattern } else { &paints[i % paints.len()] };
+        let rect = Rect::from_xywh((i * 37 % 170) as f32, (i * 53 % 170) as f32, 40.0, 25.0)
+            .unwrap();
+        expected.fill_rect(rect, paint, Transform::identity(), None);
+        list.fill_rect(rect, paint, Transform::identity(), None);
+    }
+
+    let mut pixmap = Pixmap::new(200, 200).unwrap();
+    list.draw(&mut pixmap.as_mut());
+
+    assert_eq!(pixmap, expected);
+}
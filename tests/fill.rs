@@ -613,3 +613,354 @@ fn fill_rect() {
     let expected = Pixmap::load_png("tests/images/canvas/fill-rect.png").unwrap();
     assert_eq!(pixmap, expected);
 }
+
+// Analytic coverage is compared with a 16x16 supersampled one,
+// which is way more precise than the regular 4x anti-aliasing.
+#[test]
+fn fill_analytic_aa() {
+    // Edges of a single contour must not cross either, so the star is drawn by its outline.
+    let mut pb = PathBuilder::new();
+    pb.move_to(50.0,  7.5);
+    pb.line_to(59.3, 37.5);
+    pb.line_to(90.0, 37.5);
+    pb.line_to(65.0, 56.7);
+    pb.line_to(75.0, 87.5);
+    pb.line_to(50.0, 68.3);
+    pb.line_to(25.0, 87.5);
+    pb.line_to(35.0, 56.7);
+    pb.line_to(10.0, 37.5);
+    pb.line_to(40.7, 37.5);
+    pb.close();
+    pb.push_circle(12.0, 85.0, 8.3);
+    pb.move_to(70.0, 5.0);
+    pb.cubic_to(110.0, 10.0, 60.0, 20.0, 95.0, 30.0);
+    pb.line_to(95.0, 10.0);
+    pb.close();
+    let star = pb.finish().unwrap();
+
+    // Analytic even-odd filling is exact only when edges of overlapping contours
+    // do not share pixels.
+    let mut pb = PathBuilder::new();
+    pb.push_circle(50.0, 50.0, 40.3);
+    pb.push_circle(50.0, 50.0, 20.7);
+    let ring = pb.finish().unwrap();
+
+    for (path, fill_rule) in &[(star, FillRule::Winding), (ring, FillRule::EvenOdd)] {
+        let mut paint = Paint::default();
+        paint.set_color_rgba8(255, 255, 255, 255);
+
+        const SCALE: u32 = 16;
+        let mut supersampled = Pixmap::new(100 * SCALE, 100 * SCALE).unwrap();
+        let ts = Transform::from_scale(SCALE as f32, SCALE as f32);
+        supersampled.fill_path(path, &paint, *fill_rule, ts, None);
+
+        paint.anti_alias = true;
+        paint.analytic_aa = true;
+        let mut pixmap = Pixmap::new(100, 100).unwrap();
+        pixmap.fill_path(path, &paint, *fill_rule, Transform::identity(), None);
+
+        let mut max_diff = 0;
+        for y in 0..100 {
+            for x in 0..100 {
+                let mut covered = 0;
+                for sy in 0..SCALE {
+                    for sx in 0..SCALE {
+                        let c = supersampled.pixel(x * SCALE + sx, y * SCALE + sy).unwrap();
+                        covered += u32::from(c.alpha() != 0);
+                    }
+                }
+
+                let expected = (covered * 255 + SCALE * SCALE / 2) / (SCALE * SCALE);
+                let alpha = pixmap.pixel(x, y).unwrap().alpha() as i32;
+                max_diff = max_diff.max((alpha - expected as i32).abs());
+            }
+        }
+
+        // Flattened curves are slightly inside the 16x16 ones.
+        assert!(max_diff <= 6);
+    }
+}
+
+// Alpha runs longer than `u16::MAX` must be split.
+#[test]
+fn fill_analytic_aa_wide() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+    paint.analytic_aa = true;
+
+    let path = PathBuilder::from_rect(Rect::from_xywh(0.0, 0.0, 70000.0, 3.0).unwrap());
+
+    let mut pixmap = Pixmap::new(70000, 3).unwrap();
+    pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
+
+    assert!(pixmap.pixels().iter().all(|p| p.alpha() == 200));
+}
+
+#[test]
+fn large_pixmap() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    fn star(dx: f32) -> Path {
+        let mut pb = PathBuilder::new();
+        pb.move_to(dx + 50.0,  7.5);
+        pb.line_to(dx + 75.0, 87.5);
+        pb.line_to(dx + 10.0, 37.5);
+        pb.line_to(dx + 90.0, 37.5);
+        pb.line_to(dx + 25.0, 87.5);
+        pb.finish().unwrap()
+    }
+
+    // A path far from the origin must be the same as in a small pixmap.
+    let mut pixmap = Pixmap::new(8400, 100).unwrap();
+    pixmap.fill_path(&star(8250.0), &paint, FillRule::EvenOdd, Transform::identity(), None);
+    let pixmap = pixmap.clone_rect(IntRect::from_xywh(8250, 0, 100, 100).unwrap()).unwrap();
+
+    let mut expected = Pixmap::new(100, 100).unwrap();
+    expected.fill_path(&star(0.0), &paint, FillRule::EvenOdd, Transform::identity(), None);
+
+    assert_eq!(pixmap, expected);
+}
+
+#[test]
+fn large_pixmap_tile_border() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let mut pb = PathBuilder::new();
+    pb.move_to(0.0, 10.0);
+    pb.line_to(9000.0, 30.0);
+    pb.line_to(9000.0, 90.0);
+    pb.line_to(0.0, 90.0);
+    pb.close();
+    let path = pb.finish().unwrap();
+
+    let mut pixmap = Pixmap::new(9000, 100).unwrap();
+    pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
+
+    // The edge is almost horizontal, so neighbour columns must be almost the same.
+    for y in 0..100 {
+        let a = pixmap.pixel(8189, y).unwrap().alpha() as i32;
+        let b = pixmap.pixel(8190, y).unwrap().alpha() as i32;
+        let c = pixmap.pixel(8191, y).unwrap().alpha() as i32;
+        assert!((a - b).abs() <= 2 && (b - c).abs() <= 2);
+    }
+}
+
+#[test]
+fn large_path() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let mut pixmap = Pixmap::new(9000, 10).unwrap();
+    let path = PathBuilder::from_rect(Rect::from_ltrb(-100.0, 2.5, 20000.0, 7.5).unwrap());
+    assert!(pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None).is_some());
+    let rect = Rect::from_ltrb(-100.0, 2.5, 20000.0, 7.5).unwrap();
+    paint.set_color_rgba8(220, 140, 75, 180);
+    assert!(pixmap.fill_rect(rect, &paint, Transform::identity(), None).is_some());
+
+    let first = pixmap.pixel(0, 5).unwrap();
+    assert_ne!(first.alpha(), 0);
+    assert_eq!(pixmap.pixel(8191, 5), Some(first));
+    assert_eq!(pixmap.pixel(8999, 5), Some(first));
+    assert_eq!(pixmap.pixel(8999, 0).unwrap().alpha(), 0);
+}
+
+#[test]
+fn tall_path() {
+    // Tall enough to be filled in multiple rows of tiles.
+    let mut pb = PathBuilder::new();
+    pb.move_to(2.0, 0.5);
+    for i in 0..51 {
+        let x = if i % 2 == 0 { 5.25 } else { 30.75 };
+        pb.line_to(x, 0.5 + i as f32 * 333.25);
+    }
+    pb.line_to(38.0, 16990.0);
+    pb.line_to(38.0, 0.5);
+    pb.close();
+    pb.move_to(10.0, 100.0);
+    pb.cubic_to(40.0, 50.0, -10.0, 8400.0, 20.0, 8300.0);
+    pb.close();
+    pb.push_circle(20.0, 16500.0, 15.5);
+    let path = pb.finish().unwrap();
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+
+    for &anti_alias in &[false, true] {
+        paint.anti_alias = anti_alias;
+
+        let mut pixmap = Pixmap::new(40, 17000).unwrap();
+        pixmap.fill_path(&path, &paint, FillRule::EvenOdd, Transform::identity(), None).unwrap();
+
+        // Each row of tiles must be the same as a separately filled pixmap.
+        for &(top, height) in &[(0, 8191), (8191, 8191), (16382, 618)] {
+            let mut expected = Pixmap::new(40, height).unwrap();
+            let ts = Transform::from_translate(0.0, -(top as f32));
+            expected.fill_path(&path, &paint, FillRule::EvenOdd, ts, None).unwrap();
+
+            for y in 0..height {
+                for x in 0..40 {
+                    assert_eq!(pixmap.pixel(x, top + y), expected.pixel(x, y));
+                }
+            }
+        }
+    }
+}
+
+#[test]
+fn transformed_path() {
+    // Paths are transformed on the fly, which must match filling a pre-transformed path.
+    let mut pb = PathBuilder::new();
+    for i in 0..10 {
+        pb.push_circle(20.0 + i as f32 * 7.0, 30.0 + i as f32 * 3.0, 15.0);
+    }
+    let path = pb.finish().unwrap();
+
+    let ts = Transform::from_row(1.2, 0.3, -0.4, 0.9, 8200.0, 10.5);
+    let transformed = path.clone().transform(ts).unwrap();
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+
+    // A zero width is always a hairline, independent of the transform.
+    let mut hairline = Stroke::default();
+    hairline.width = 0.0;
+
+    for &(anti_alias, analytic_aa) in &[(false, false), (true, false), (true, true)] {
+        paint.anti_alias = anti_alias;
+        paint.analytic_aa = analytic_aa;
+
+        // Wide enough to be filled tile by tile.
+        let mut pixmap = Pixmap::new(8400, 150).unwrap();
+        pixmap.fill_path(&path, &paint, FillRule::EvenOdd, ts, None);
+        pixmap.stroke_path(&path, &paint, &hairline, ts, None);
+
+        let mut expected = Pixmap::new(8400, 150).unwrap();
+        expected.fill_path(&transformed, &paint, FillRule::EvenOdd, Transform::identity(), None);
+        expected.stroke_path(&transformed, &paint, &hairline, Transform::identity(), None);
+
+        assert!(pixmap == expected);
+    }
+}
+
+#[test]
+fn outside_pixmap() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    let path = PathBuilder::from_circle(150.0, 50.0, 20.0).unwrap();
+    let ts = Transform::identity();
+    assert!(pixmap.fill_path(&path, &paint, FillRule::Winding, ts, None).is_none());
+
+    let rect = Rect::from_xywh(-50.0, 20.0, 30.0, 30.0).unwrap();
+    assert!(pixmap.fill_rect(rect, &paint, ts, None).is_none());
+
+    let mut stroke = Stroke::default();
+    stroke.width = 0.5;
+    let moved_ts = Transform::from_translate(0.0, 200.0);
+    assert!(pixmap.stroke_path(&path, &paint, &stroke, moved_ts, None).is_none());
+
+    // Outside of a rectangular clip.
+    let clip_path = PathBuilder::from_rect(Rect::from_xywh(0.0, 0.0, 50.0, 50.0).unwrap());
+    let mut clip_mask = ClipMask::new();
+    clip_mask.set_path(100, 100, &clip_path, FillRule::Winding, false);
+    let path = PathBuilder::from_circle(75.0, 75.0, 10.0).unwrap();
+    let clip_mask = Some(&clip_mask);
+    assert!(pixmap.fill_path(&path, &paint, FillRule::Winding, ts, clip_mask).is_none());
+
+    assert_eq!(pixmap, Pixmap::new(100, 100).unwrap());
+}
+
+#[test]
+fn prepared_path() {
+    let mut pb = PathBuilder::new();
+    pb.push_circle(10.0, 10.0, 8.5);
+    pb.push_rect(4.0, 4.0, 12.0, 12.0);
+    let path = pb.finish().unwrap();
+
+    let ts = Transform::from_row(1.2, 0.3, -0.4, 0.9, 8.0, 0.5);
+
+    let mut paint = Paint::default();
+    paint.shader = LinearGradient::new(
+        Point::from_xy(0.0, 0.0),
+        Point::from_xy(20.0, 0.0),
+        vec![
+            GradientStop::new(0.0, Color::from_rgba8(50, 127, 150, 200)),
+            GradientStop::new(1.0, Color::from_rgba8(220, 140, 75, 180)),
+        ],
+        SpreadMode::Pad,
+        Transform::identity(),
+    ).unwrap();
+
+    for &anti_alias in &[false, true] {
+        paint.anti_alias = anti_alias;
+        let prepared = PreparedPath::new(&path, FillRule::EvenOdd, anti_alias, ts).unwrap();
+
+        // Clipped edges are rasterized slightly differently, so the expected image
+        // is rendered with a margin, where the path is always fully visible.
+        let mut pixmap = Pixmap::new(100, 50).unwrap();
+        let mut expected = Pixmap::new(140, 90).unwrap();
+        // Fully visible and partially outside the pixmap on each side.
+        for &(x, y) in &[(20, 10), (-12, 5), (85, 20), (40, -10), (60, 40)] {
+            pixmap.fill_prepared_path(&prepared, x, y, &paint, None);
+
+            let ts = ts.post_translate(x as f32 + 20.0, y as f32 + 20.0);
+            expected.fill_path(&path, &paint, FillRule::EvenOdd, ts, None);
+        }
+
+        let expected = expected.clone_rect(IntRect::from_xywh(20, 20, 100, 50).unwrap()).unwrap();
+        assert!(pixmap == expected);
+    }
+}
+
+#[test]
+fn fill_rects() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let mut rects = Vec::new();
+    for i in 0..40 {
+        let i = i as f32;
+        rects.push(Rect::from_xywh(i * 2.7 - 10.0, i * 1.3, 9.4, 5.25).unwrap());
+    }
+
+    // Same as separate `fill_rect` calls without a transform and with a skew.
+    let skew = Transform::from_row(1.0, 0.2, -0.3, 1.0, 10.0, 5.0);
+    for &ts in &[Transform::identity(), skew] {
+        let mut pixmap = Pixmap::new(100, 80).unwrap();
+        pixmap.fill_rects(&rects, &paint, ts, None).unwrap();
+
+        let mut expected = Pixmap::new(100, 80).unwrap();
+        for rect in &rects {
+            expected.fill_rect(*rect, &paint, ts, None);
+        }
+
+        assert!(pixmap == expected);
+    }
+
+    // Scale and translate are applied to rectangles directly.
+    let ts = Transform::from_row(-0.75, 0.0, 0.0, 1.5, 90.0, 2.5);
+    let mut pixmap = Pixmap::new(100, 80).unwrap();
+    pixmap.fill_rects(&rects, &paint, ts, None).unwrap();
+
+    let mut expected = Pixmap::new(100, 80).unwrap();
+    for rect in &rects {
+        let rect = Rect::from_ltrb(
+            90.0 - rect.right() * 0.75,
+            2.5 + rect.top() * 1.5,
+            90.0 - rect.left() * 0.75,
+            2.5 + rect.bottom() * 1.5,
+        ).unwrap();
+        expected.fill_rect(rect, &paint, Transform::identity(), None);
+    }
+
+    assert!(pixmap == expected);
+}
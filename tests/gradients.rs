@@ -241,12 +241,34 @@ fn two_stops_unevenly_spaced_hq() {
     assert_eq!(pixmap, expected);
 }
 
-// The radial gradient is only supported by the high quality pipeline.
-// Therefore we do not have a lq/hq split.
+#[test]
+fn well_behaved_radial_lq() {
+    let mut paint = Paint::default();
+    paint.shader = RadialGradient::new(
+        Point::from_xy(100.0, 100.0),
+        Point::from_xy(120.0, 80.0),
+        100.0,
+        vec![
+            GradientStop::new(0.25, Color::from_rgba8(50, 127, 150, 200)),
+            GradientStop::new(0.75, Color::from_rgba8(220, 140, 75, 180)),
+        ],
+        SpreadMode::Pad,
+        Transform::identity(),
+    ).unwrap();
+
+    let path = PathBuilder::from_rect(Rect::from_ltrb(10.0, 10.0, 190.0, 190.0).unwrap());
+
+    let mut pixmap = Pixmap::new(200, 200).unwrap();
+    pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
+
+    let expected = Pixmap::load_png("tests/images/gradients/well-behaved-radial-lq.png").unwrap();
+    assert_eq!(pixmap, expected);
+}
 
 #[test]
-fn well_behaved_radial() {
+fn well_behaved_radial_hq() {
     let mut paint = Paint::default();
+    paint.force_hq_pipeline = true;
     paint.shader = RadialGradient::new(
         Point::from_xy(100.0, 100.0),
         Point::from_xy(120.0, 80.0),
@@ -264,10 +286,13 @@ fn well_behaved_radial() {
     let mut pixmap = Pixmap::new(200, 200).unwrap();
     pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
 
-    let expected = Pixmap::load_png("tests/images/gradients/well-behaved-radial.png").unwrap();
+    let expected = Pixmap::load_png("tests/images/gradients/well-behaved-radial-hq.png").unwrap();
     assert_eq!(pixmap, expected);
 }
 
+// Other two point conical gradients are only supported by the high quality pipeline.
+// Therefore we do not have a lq/hq split.
+
 #[test]
 fn focal_on_circle_radial() {
     let mut paint = Paint::default();
@@ -416,3 +441,105 @@ fn global_opacity() {
     let expected = Pixmap::load_png("tests/images/gradients/global-opacity.png").unwrap();
     assert_eq!(pixmap, expected);
 }
+
+#[test]
+fn many_stops_lut() {
+    // Gradients with many stops are rendered using a lookup table.
+    // Stops that lie on a straight line must produce the same colors as two stops.
+    fn fill(stops: Vec<GradientStop>, mode: SpreadMode, force_hq_pipeline: bool) -> Pixmap {
+        let mut paint = Paint::default();
+        paint.force_hq_pipeline = force_hq_pipeline;
+        paint.shader = LinearGradient::new(
+            Point::from_xy(10.0, 10.0),
+            Point::from_xy(120.0, 150.0),
+            stops,
+            mode,
+            Transform::identity(),
+        ).unwrap();
+
+        let path = PathBuilder::from_rect(Rect::from_ltrb(10.0, 10.0, 190.0, 190.0).unwrap());
+
+        let mut pixmap = Pixmap::new(200, 200).unwrap();
+        pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
+        pixmap
+    }
+
+    let c0 = Color::from_rgba8(50, 127, 150, 200);
+    let c1 = Color::from_rgba8(220, 140, 75, 200);
+    let many: Vec<_> = (0..12).map(|i| {
+        let t = i as f32 / 11.0;
+        let c = Color::from_rgba(
+            c0.red() + (c1.red() - c0.red()) * t,
+            c0.green() + (c1.green() - c0.green()) * t,
+            c0.blue() + (c1.blue() - c0.blue()) * t,
+            c0.alpha(),
+        ).unwrap();
+        GradientStop::new(t, c)
+    }).collect();
+    let two = vec![GradientStop::new(0.0, c0), GradientStop::new(1.0, c1)];
+
+    for &mode in &[SpreadMode::Pad, SpreadMode::Repeat, SpreadMode::Reflect] {
+        for &hq in &[false, true] {
+            let a = fill(many.clone(), mode, hq);
+            let b = fill(two.clone(), mode, hq);
+            for (a, b) in a.data().iter().zip(b.data()) {
+                assert!((*a as i32 - *b as i32).abs() <= 1);
+            }
+        }
+    }
+}
+
+#[test]
+fn many_stops_lut_alpha() {
+    // Lookup table colors are premultiplied, so alpha has to be interpolated per cell too.
+    let stops: Vec<_> = (0..12).map(|i| {
+        let t = (i as f32 / 11.0).powf(1.3);
+        let c = Color::from_rgba(
+            (i as f32 * 0.37).fract(),
+            1.0 - i as f32 / 11.0,
+            (i % 3) as f32 * 0.5,
+            0.1 + ((i * 7) % 11) as f32 * 0.09,
+        ).unwrap();
+        (t, c)
+    }).collect();
+
+    // An unpremultiplied linear interpolation between stops, premultiplied afterwards.
+    let expected_at = |t: f32| {
+        let i = (0..stops.len() - 1).rev().find(|i| t >= stops[*i].0).unwrap_or(0);
+        let ((t0, c0), (t1, c1)) = (stops[i], stops[i + 1]);
+        let f = ((t - t0) / (t1 - t0)).max(0.0).min(1.0);
+        let lerp = |a: f32, b: f32| a + (b - a) * f;
+        let a = lerp(c0.alpha(), c1.alpha());
+        [
+            lerp(c0.red(), c1.red()) * a,
+            lerp(c0.green(), c1.green()) * a,
+            lerp(c0.blue(), c1.blue()) * a,
+            a,
+        ]
+    };
+
+    for &hq in &[false, true] {
+        let mut paint = Paint::default();
+        paint.force_hq_pipeline = hq;
+        paint.shader = LinearGradient::new(
+            Point::from_xy(0.0, 0.0),
+            Point::from_xy(200.0, 0.0),
+            stops.iter().map(|(t, c)| GradientStop::new(*t, *c)).collect(),
+            SpreadMode::Pad,
+            Transform::identity(),
+        ).unwrap();
+
+        let mut pixmap = Pixmap::new(200, 2).unwrap();
+        pixmap.fill_rect(Rect::from_xywh(0.0, 0.0, 200.0, 2.0).unwrap(), &paint,
+                         Transform::identity(), None);
+
+        for x in 0..200 {
+            let c = pixmap.pixel(x, 0).unwrap();
+            let e = expected_at((x as f32 + 0.5) / 200.0);
+            let actual = [c.red(), c.green(), c.blue(), c.alpha()];
+            for (a, e) in actual.iter().zip(&e) {
+                assert!((*a as f32 - e * 255.0).abs() <= 2.0, "{} {:?} {:?}", x, actual, e);
+            }
+        }
+    }
+}
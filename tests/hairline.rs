@@ -234,3 +234,109 @@ fn clipped_circle_aa() {
     let expected = Pixmap::load_png("tests/images/hairline/clipped-circle-aa.png").unwrap();
     assert_eq!(pixmap, expected);
 }
+
+#[test]
+fn batched_hairlines() {
+    // Long enough to be transformed in multiple chunks.
+    let mut points = Vec::new();
+    for i in 0..301 {
+        let x = i as f32 * 0.37 - 5.0;
+        points.push(Point::from_xy(x, 50.0 + (x * 0.3).sin() * 40.0));
+    }
+
+    let ts = Transform::from_row(1.1, 0.1, -0.2, 0.9, 4.0, 3.5);
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+
+    let mut stroke = Stroke::default();
+    stroke.width = 0.0;
+
+    for &anti_alias in &[false, true] {
+        paint.anti_alias = anti_alias;
+
+        for &connected in &[true, false] {
+            let mut pb = PathBuilder::new();
+            if connected {
+                pb.move_to(points[0].x, points[0].y);
+                for p in &points[1..] {
+                    pb.line_to(p.x, p.y);
+                }
+            } else {
+                for line in points.chunks_exact(2) {
+                    pb.move_to(line[0].x, line[0].y);
+                    pb.line_to(line[1].x, line[1].y);
+                }
+            }
+            let path = pb.finish().unwrap();
+
+            let mut pixmap = Pixmap::new(100, 100).unwrap();
+            pixmap.stroke_hairlines(&points, connected, &paint, ts, None).unwrap();
+
+            let mut expected = Pixmap::new(100, 100).unwrap();
+            expected.stroke_path(&path, &paint, &stroke, ts, None);
+
+            assert!(pixmap == expected);
+        }
+    }
+}
+
+#[test]
+fn offscreen_hairlines() {
+    let mut paint = Paint::default();
+    paint.anti_alias = true;
+
+    let points = [Point::from_xy(10.0, 110.0), Point::from_xy(90.0, 130.0)];
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    assert!(pixmap.stroke_hairlines(&points, true, &paint, Transform::identity(), None).is_none());
+
+    // Moved back inside by the transform.
+    let ts = Transform::from_translate(0.0, -100.0);
+    assert!(pixmap.stroke_hairlines(&points, true, &paint, ts, None).is_some());
+}
+
+#[test]
+fn clip_mask_aa() {
+    // The clip rect doesn't start at the origin.
+    let clip_path = PathBuilder::from_rect(Rect::from_ltrb(20.0, 20.0, 80.0, 80.0).unwrap());
+    let mut clip_mask = ClipMask::new();
+    clip_mask.set_path(100, 100, &clip_path, FillRule::Winding, true).unwrap();
+
+    let mut pb = PathBuilder::new();
+    pb.move_to(10.0, 10.0);
+    pb.line_to(90.0, 30.0);
+    let path = pb.finish().unwrap();
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let mut stroke = Stroke::default();
+    stroke.width = 0.0;
+    stroke.line_cap = LineCap::Round;
+
+    let mut unclipped = Pixmap::new(100, 100).unwrap();
+    unclipped.stroke_path(&path, &paint, &stroke, Transform::identity(), None).unwrap();
+
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    pixmap.stroke_path(&path, &paint, &stroke, Transform::identity(), Some(&clip_mask)).unwrap();
+
+    let mut hairlines = Pixmap::new(100, 100).unwrap();
+    let points = [Point::from_xy(10.0, 10.0), Point::from_xy(90.0, 30.0)];
+    hairlines.stroke_hairlines(&points, true, &paint, Transform::identity(), Some(&clip_mask))
+        .unwrap();
+    assert!(hairlines == pixmap);
+
+    for y in 0..100 {
+        for x in 0..100 {
+            let c = pixmap.pixel(x, y).unwrap();
+            if x >= 20 && x < 80 && y >= 20 && y < 80 {
+                // Clip mask coverage is applied with a slight rounding error.
+                let e = unclipped.pixel(x, y).unwrap();
+                assert!((c.alpha() as i32 - e.alpha() as i32).abs() <= 1);
+            } else {
+                assert_eq!(c, PremultipliedColorU8::TRANSPARENT);
+            }
+        }
+    }
+}
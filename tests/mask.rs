@@ -0,0 +1,98 @@
+use tiny_skia::*;
+
+fn circles() -> Path {
+    let mut pb = PathBuilder::new();
+    pb.push_circle(40.0, 45.0, 30.0);
+    pb.push_circle(60.0, 55.0, 30.5);
+    pb.finish().unwrap()
+}
+
+fn max_diff(a: &[u8], b: &[u8]) -> u8 {
+    a.iter().zip(b).map(|(a, b)| (*a as i16 - *b as i16).abs() as u8).max().unwrap()
+}
+
+#[test]
+fn fill_path() {
+    let path = circles();
+    let ts = Transform::from_row(1.1, 0.2, -0.1, 0.9, 3.5, -2.0);
+
+    for &anti_alias in &[false, true] {
+        let mut mask = Mask::new(100, 100).unwrap();
+        mask.fill_path(&path, FillRule::Winding, anti_alias, ts).unwrap();
+
+        let mut paint = Paint::default();
+        paint.anti_alias = anti_alias;
+        let mut pixmap = Pixmap::new(100, 100).unwrap();
+        pixmap.fill_path(&path, &paint, FillRule::Winding, ts, None).unwrap();
+
+        let expected = Mask::from_pixmap(pixmap.as_ref());
+        assert_eq!(mask, expected);
+    }
+}
+
+#[test]
+fn accumulate() {
+    let mut pb = PathBuilder::new();
+    pb.push_circle(40.0, 45.0, 30.0);
+    let path1 = pb.finish().unwrap();
+    let mut pb = PathBuilder::new();
+    pb.push_circle(60.0, 55.0, 30.5);
+    let path2 = pb.finish().unwrap();
+
+    let mut mask = Mask::new(100, 100).unwrap();
+    mask.fill_path(&path1, FillRule::Winding, true, Transform::identity()).unwrap();
+    mask.fill_path(&path2, FillRule::Winding, true, Transform::identity()).unwrap();
+    let mut stroke = Stroke::default();
+    stroke.width = 0.5;
+    mask.stroke_path(&path2, &stroke, true, Transform::from_translate(5.0, 0.0)).unwrap();
+
+    let mut paint = Paint::default();
+    paint.anti_alias = true;
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    pixmap.fill_path(&path1, &paint, FillRule::Winding, Transform::identity(), None).unwrap();
+    pixmap.fill_path(&path2, &paint, FillRule::Winding, Transform::identity(), None).unwrap();
+    pixmap.stroke_path(&path2, &paint, &stroke, Transform::from_translate(5.0, 0.0), None).unwrap();
+
+    // Pipelines use a slightly less precise blending.
+    let expected = Mask::from_pixmap(pixmap.as_ref());
+    assert!(max_diff(mask.data(), expected.data()) <= 3);
+}
+
+#[test]
+fn fill_mask() {
+    let mut mask = Mask::new(100, 100).unwrap();
+    mask.fill_path(&circles(), FillRule::Winding, true, Transform::identity()).unwrap();
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let background = Color::from_rgba8(220, 140, 75, 180);
+
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    pixmap.fill(background);
+    let mut expected = pixmap.clone();
+    pixmap.fill_mask(&mask, 0, 0, &paint).unwrap();
+    expected.fill_path(&circles(), &paint, FillRule::Winding, Transform::identity(), None);
+    assert!(pixmap == expected);
+
+    // Partially visible masks are cut, so the expected image
+    // is rendered with a margin, where the mask is always fully visible.
+    for &(x, y) in &[(-30, 20), (50, -45), (70, 80)] {
+        let mut pixmap = Pixmap::new(100, 100).unwrap();
+        pixmap.fill(background);
+        pixmap.fill_mask(&mask, x, y, &paint).unwrap();
+
+        let mut expected = Pixmap::new(300, 300).unwrap();
+        expected.fill(background);
+        expected.fill_mask(&mask, x + 100, y + 100, &paint).unwrap();
+        let expected = expected.clone_rect(IntRect::from_xywh(100, 100, 100, 100).unwrap()).unwrap();
+
+        assert!(pixmap == expected);
+    }
+
+    // Outside the pixmap.
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+    assert!(pixmap.fill_mask(&mask, 100, 0, &paint).is_none());
+    assert!(pixmap.fill_mask(&mask, -100, 0, &paint).is_none());
+}
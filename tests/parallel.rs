@@ -0,0 +1,168 @@
+#![cfg(feature = "parallel")]
+
+use tiny_skia::*;
+
+// Parallel filling must produce exactly the same result as the serial one.
+
+fn star_path() -> Path {
+    let mut pb = PathBuilder::new();
+    pb.move_to(250.0, 10.0);
+    for i in 1..23 {
+        let angle = i as f32 * 7.0 * core::f32::consts::PI / 23.0;
+        pb.line_to(250.0 + 240.0 * angle.sin(), 260.0 - 250.0 * angle.cos());
+    }
+    pb.close();
+    pb.push_circle(200.0, 300.0, 150.0);
+    pb.move_to(20.0, 480.0);
+    pb.cubic_to(100.0, 100.0, 400.0, 700.0, 480.0, 30.0);
+    pb.quad_to(300.0, 400.0, 20.0, 480.0);
+    pb.close();
+    pb.finish().unwrap()
+}
+
+fn compare(paint: &Paint, fill_rule: FillRule, transform: Transform, clip_mask: Option<&ClipMask>) {
+    let path = star_path();
+
+    let mut serial = Pixmap::new(500, 700).unwrap();
+    serial.fill(Color::from_rgba8(200, 220, 240, 80));
+    let mut parallel = serial.clone();
+
+    serial.fill_path(&path, paint, fill_rule, transform, clip_mask).unwrap();
+    parallel.fill_path_parallel(&path, paint, fill_rule, transform, clip_mask).unwrap();
+
+    assert_eq!(serial, parallel);
+}
+
+#[test]
+fn winding() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    compare(&paint, FillRule::Winding, Transform::identity(), None);
+}
+
+#[test]
+fn even_odd_aa() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+    compare(&paint, FillRule::EvenOdd, Transform::identity(), None);
+}
+
+#[test]
+fn transformed_aa() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+    let ts = Transform::from_row(1.2, 0.3, -0.2, 1.1, 10.0, 20.0);
+    compare(&paint, FillRule::Winding, ts, None);
+}
+
+#[test]
+fn gradient_aa() {
+    let mut paint = Paint::default();
+    paint.anti_alias = true;
+    paint.shader = LinearGradient::new(
+        Point::from_xy(0.0, 0.0),
+        Point::from_xy(100.0, 600.0),
+        vec![
+            GradientStop::new(0.0, Color::from_rgba8(50, 127, 150, 200)),
+            GradientStop::new(0.5, Color::from_rgba8(220, 140, 75, 180)),
+            GradientStop::new(1.0, Color::from_rgba8(40, 180, 55, 160)),
+        ],
+        SpreadMode::Reflect,
+        Transform::identity(),
+    ).unwrap();
+    compare(&paint, FillRule::Winding, Transform::identity(), None);
+}
+
+#[test]
+fn clip_mask_aa() {
+    let clip_path = PathBuilder::from_circle(250.0, 350.0, 220.0).unwrap();
+    let mut clip_mask = ClipMask::new();
+    clip_mask.set_path(500, 700, &clip_path, FillRule::Winding, true);
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+    compare(&paint, FillRule::Winding, Transform::identity(), Some(&clip_mask));
+}
+
+#[test]
+fn analytic_aa() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+    paint.analytic_aa = true;
+    compare(&paint, FillRule::EvenOdd, Transform::identity(), None);
+}
+
+#[test]
+fn padded_rows() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+
+    let path = star_path();
+    let mut serial = Pixmap::new(500, 700).unwrap();
+    serial.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None).unwrap();
+
+    let row_bytes = 520 * BYTES_PER_PIXEL;
+    let mut data = vec![0x5A; row_bytes * 699 + 500 * BYTES_PER_PIXEL];
+    let mut parallel = PixmapMut::from_bytes_with_stride(&mut data, 500, 700, row_bytes).unwrap();
+    parallel.fill(Color::TRANSPARENT);
+    parallel.fill_path_parallel(&path, &paint, FillRule::Winding, Transform::identity(), None)
+        .unwrap();
+
+    assert_eq!(parallel.to_owned(), serial);
+    for row in data.chunks(row_bytes) {
+        assert!(row[500 * BYTES_PER_PIXEL..].iter().all(|b| *b == 0x5A));
+    }
+}
+
+#[test]
+fn set_clip_path() {
+    let path = star_path();
+    for &anti_alias in &[false, true] {
+        let mut serial_mask = ClipMask::new();
+        serial_mask.set_path(500, 700, &path, FillRule::EvenOdd, anti_alias).unwrap();
+        let mut parallel_mask = ClipMask::new();
+        parallel_mask.set_path_parallel(500, 700, &path, FillRule::EvenOdd, anti_alias).unwrap();
+
+        let mut paint = Paint::default();
+        paint.set_color_rgba8(50, 127, 150, 200);
+        let rect = Rect::from_xywh(0.0, 0.0, 500.0, 700.0).unwrap();
+
+        let mut serial = Pixmap::new(500, 700).unwrap();
+        serial.fill_rect(rect, &paint, Transform::identity(), Some(&serial_mask));
+        let mut parallel = Pixmap::new(500, 700).unwrap();
+        parallel.fill_rect(rect, &paint, Transform::identity(), Some(&parallel_mask));
+
+        assert_eq!(serial, parallel);
+    }
+}
+
+#[test]
+fn path_below_first_band() {
+    // Edges start below the first band, which still must not blit anything.
+    let mut pb = PathBuilder::new();
+    pb.move_to(72.3, 50.1);
+    pb.line_to(115.3, 47.75);
+    pb.line_to(95.4, 69.0);
+    pb.line_to(142.5, 117.3);
+    pb.line_to(75.4, 126.0);
+    let path = pb.finish().unwrap();
+
+    for &anti_alias in &[false, true] {
+        let mut paint = Paint::default();
+        paint.set_color_rgba8(50, 127, 150, 200);
+        paint.anti_alias = anti_alias;
+
+        let mut serial = Pixmap::new(120, 90).unwrap();
+        serial.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None).unwrap();
+        let mut parallel = Pixmap::new(120, 90).unwrap();
+        parallel.fill_path_parallel(&path, &paint, FillRule::Winding, Transform::identity(), None)
+            .unwrap();
+
+        assert_eq!(serial, parallel);
+    }
+}
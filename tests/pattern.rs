@@ -199,7 +199,7 @@ fn filter_nearest() {
 }
 
 #[test]
-fn filter_bilinear() {
+fn filter_bilinear_lq() {
     let triangle = crate_triangle();
 
     let mut paint = Paint::default();
@@ -216,7 +216,30 @@ fn filter_bilinear() {
     let mut pixmap = Pixmap::new(200, 200).unwrap();
     pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
 
-    let expected = Pixmap::load_png("tests/images/pattern/filter-bilinear.png").unwrap();
+    let expected = Pixmap::load_png("tests/images/pattern/filter-bilinear-lq.png").unwrap();
+    assert_eq!(pixmap, expected);
+}
+
+#[test]
+fn filter_bilinear_hq() {
+    let triangle = crate_triangle();
+
+    let mut paint = Paint::default();
+    paint.force_hq_pipeline = true;
+    paint.shader = Pattern::new(
+        triangle.as_ref(),
+        SpreadMode::Repeat,
+        FilterQuality::Bilinear,
+        1.0,
+        Transform::from_row(1.5, 0.0, -0.4, -0.8, 5.0, 1.0),
+    );
+
+    let path = PathBuilder::from_rect(Rect::from_ltrb(10.0, 10.0, 190.0, 190.0).unwrap());
+
+    let mut pixmap = Pixmap::new(200, 200).unwrap();
+    pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
+
+    let expected = Pixmap::load_png("tests/images/pattern/filter-bilinear-hq.png").unwrap();
     assert_eq!(pixmap, expected);
 }
 
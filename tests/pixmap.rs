@@ -99,6 +99,62 @@ fn draw_pixmap() {
     assert_eq!(pixmap, expected);
 }
 
+#[test]
+fn draw_pixmap_sprite() {
+    // Untransformed pixmaps are copied directly and must match the pattern pipeline.
+
+    let triangle = {
+        let mut paint = Paint::default();
+        paint.set_color_rgba8(50, 127, 150, 200);
+        paint.anti_alias = true;
+
+        let mut pb = PathBuilder::new();
+        pb.move_to(1.0, 98.0);
+        pb.line_to(99.0, 98.0);
+        pb.line_to(50.0, 1.0);
+        pb.close();
+        let path = pb.finish().unwrap();
+
+        // Borders are kept transparent, so spread modes do not matter.
+        let mut pixmap = Pixmap::new(100, 100).unwrap();
+        pixmap.fill_rect(Rect::from_xywh(1.0, 1.0, 40.0, 40.0).unwrap(), &Paint::default(),
+                         Transform::identity(), None);
+        pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
+        pixmap
+    };
+
+    for &blend_mode in &[BlendMode::SourceOver, BlendMode::Source] {
+        for &(x, y) in &[(20, 30), (-30, -40), (150, 170), (-120, 10)] {
+            let mut background = Pixmap::new(200, 200).unwrap();
+            background.fill(Color::from_rgba8(200, 100, 50, 150));
+
+            let mut pixmap = background.clone();
+            let mut paint = PixmapPaint::default();
+            paint.blend_mode = blend_mode;
+            pixmap.draw_pixmap(x, y, triangle.as_ref(), &paint, Transform::identity(), None);
+
+            // `Repeat` disables the fast path.
+            let mut expected = background;
+            let paint = Paint {
+                shader: Pattern::new(
+                    triangle.as_ref(),
+                    SpreadMode::Repeat,
+                    FilterQuality::Nearest,
+                    1.0,
+                    Transform::from_translate(x as f32, y as f32),
+                ),
+                blend_mode,
+                anti_alias: false,
+                ..Paint::default()
+            };
+            let rect = Rect::from_xywh(x as f32, y as f32, 100.0, 100.0).unwrap();
+            expected.fill_rect(rect, &paint, Transform::identity(), None);
+
+            assert!(pixmap == expected);
+        }
+    }
+}
+
 #[test]
 fn draw_pixmap_ts() {
     let triangle = {
@@ -169,3 +225,208 @@ fn draw_pixmap_opacity() {
     let expected = Pixmap::load_png("tests/images/canvas/draw-pixmap-opacity.png").unwrap();
     assert_eq!(pixmap, expected);
 }
+
+#[test]
+fn from_bytes_with_stride() {
+    let mut data = vec![0; 440 * 9 + 400];
+    assert!(PixmapMut::from_bytes_with_stride(&mut data, 100, 10, 396).is_none());
+    assert!(PixmapMut::from_bytes_with_stride(&mut data, 100, 10, 442).is_none());
+    assert!(PixmapMut::from_bytes_with_stride(&mut data, 100, 11, 440).is_none());
+    // The last row doesn't have to be padded.
+    assert_eq!(PixmapMut::from_bytes_with_stride(&mut data, 100, 10, 440).unwrap().row_bytes(), 440);
+}
+
+#[test]
+fn eq_ignores_padding() {
+    let packed = vec![7; 400 * 10];
+    let mut padded = vec![0; 440 * 10];
+    for row in padded.chunks_mut(440) {
+        row[..400].iter_mut().for_each(|b| *b = 7);
+    }
+
+    let a = PixmapRef::from_bytes(&packed, 100, 10).unwrap();
+    let b = PixmapRef::from_bytes_with_stride(&padded, 100, 10, 440).unwrap();
+    assert!(a == b);
+
+    padded[440 * 9 + 399] = 8;
+    let b = PixmapRef::from_bytes_with_stride(&padded, 100, 10, 440).unwrap();
+    assert!(a != b);
+}
+
+#[test]
+fn draw_with_stride() {
+    // Drawing onto padded rows must produce the same pixels as onto packed ones
+    // and must not touch the padding.
+
+    fn draw(pixmap: &mut PixmapMut, sprite: PixmapRef) {
+        pixmap.fill(Color::from_rgba8(200, 100, 50, 150));
+
+        let mut paint = Paint::default();
+        paint.set_color_rgba8(50, 127, 150, 200);
+        paint.anti_alias = true;
+        let path = PathBuilder::from_circle(60.0, 50.0, 45.0).unwrap();
+        pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
+
+        pixmap.draw_pixmap(-10, 30, sprite, &PixmapPaint::default(), Transform::identity(), None);
+
+        let mut paint = PixmapPaint::default();
+        paint.quality = FilterQuality::Bilinear;
+        pixmap.draw_pixmap(5, 10, sprite, &paint, Transform::from_row(1.2, 0.5, 0.5, 1.2, 0.0, 0.0), None);
+    }
+
+    const PADDING: u8 = 0x5A;
+    let row_bytes = 120 * BYTES_PER_PIXEL;
+
+    // A sprite with padded rows as well.
+    let mut sprite_data = vec![PADDING; row_bytes * 40];
+    {
+        let mut sprite = PixmapMut::from_bytes_with_stride(&mut sprite_data, 50, 40, row_bytes).unwrap();
+        let mut paint = Paint::default();
+        paint.set_color_rgba8(20, 200, 30, 255);
+        sprite.fill_rect(Rect::from_xywh(5.0, 5.0, 40.0, 20.0).unwrap(), &paint,
+                         Transform::identity(), None);
+    }
+    let sprite = PixmapRef::from_bytes_with_stride(&sprite_data, 50, 40, row_bytes).unwrap();
+
+    let mut expected = Pixmap::new(100, 80).unwrap();
+    draw(&mut expected.as_mut(), sprite.to_owned().as_ref());
+
+    let mut data = vec![PADDING; row_bytes * 80];
+    let mut pixmap = PixmapMut::from_bytes_with_stride(&mut data, 100, 80, row_bytes).unwrap();
+    draw(&mut pixmap, sprite);
+
+    assert_eq!(pixmap.to_owned(), expected);
+    assert_eq!(pixmap.as_ref().pixel(60, 50), expected.pixel(60, 50));
+    assert_eq!(pixmap.as_ref().encode_png().unwrap(), expected.encode_png().unwrap());
+    for row in data.chunks(row_bytes) {
+        assert!(row[100 * BYTES_PER_PIXEL..].iter().all(|b| *b == PADDING));
+    }
+}
+
+fn draw_scene(pixmap: &mut PixmapMut, sprite: PixmapRef) {
+    pixmap.fill(Color::from_rgba8(200, 100, 50, 220));
+
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 200);
+    paint.anti_alias = true;
+    let path = PathBuilder::from_circle(60.0, 50.0, 45.0).unwrap();
+    pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
+
+    paint.shader = LinearGradient::new(
+        Point::from_xy(10.0, 0.0),
+        Point::from_xy(90.0, 0.0),
+        vec![
+            GradientStop::new(0.0, Color::from_rgba8(50, 127, 150, 255)),
+            GradientStop::new(1.0, Color::from_rgba8(220, 140, 75, 180)),
+        ],
+        SpreadMode::Pad,
+        Transform::identity(),
+    ).unwrap();
+    paint.blend_mode = BlendMode::Multiply;
+    pixmap.fill_rect(Rect::from_xywh(10.0, 60.0, 80.0, 15.0).unwrap(), &paint,
+                     Transform::identity(), None);
+
+    paint.set_color_rgba8(20, 200, 30, 255);
+    paint.blend_mode = BlendMode::Source;
+    pixmap.fill_rect(Rect::from_xywh(70.0, 5.0, 20.0, 20.0).unwrap(), &paint,
+                     Transform::identity(), None);
+
+    pixmap.draw_pixmap(-10, 30, sprite, &PixmapPaint::default(), Transform::identity(), None);
+}
+
+#[test]
+fn draw_with_pixel_format() {
+    let mut sprite = Pixmap::new(50, 40).unwrap();
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(20, 200, 30, 200);
+    sprite.fill_rect(Rect::from_xywh(5.0, 5.0, 40.0, 20.0).unwrap(), &paint,
+                     Transform::identity(), None);
+
+    let mut expected = Pixmap::new(100, 80).unwrap();
+    draw_scene(&mut expected.as_mut(), sprite.as_ref());
+
+    for &format in &[
+        PixelFormat::BgraPremultiplied,
+        PixelFormat::RgbaUnpremultiplied,
+        PixelFormat::BgraUnpremultiplied,
+    ] {
+        let mut pixmap = Pixmap::new(100, 80).unwrap();
+        draw_scene(&mut pixmap.as_mut().with_format(format), sprite.as_ref());
+
+        let bgra = format == PixelFormat::BgraPremultiplied
+            || format == PixelFormat::BgraUnpremultiplied;
+        let premultiplied = format == PixelFormat::BgraPremultiplied;
+        let mut max_diff = 0;
+        for (c1, c2) in expected.pixels().iter().zip(pixmap.data().chunks(4)) {
+            let c1 = if premultiplied {
+                ColorU8::from_rgba(c1.red(), c1.green(), c1.blue(), c1.alpha())
+            } else {
+                c1.demultiply()
+            };
+
+            let c2 = if bgra {
+                [c2[2], c2[1], c2[0], c2[3]]
+            } else {
+                [c2[0], c2[1], c2[2], c2[3]]
+            };
+
+            let c1 = [c1.red(), c1.green(), c1.blue(), c1.alpha()];
+            for (a, b) in c1.iter().zip(c2.iter()) {
+                max_diff = max_diff.max((*a as i32 - *b as i32).abs());
+            }
+        }
+
+        if premultiplied {
+            assert_eq!(max_diff, 0);
+        } else {
+            // Unpremultiplied pixels are premultiplied on each load.
+            assert!(max_diff <= 2);
+        }
+    }
+}
+
+#[test]
+fn pixel_format_converted_on_access() {
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(20, 200, 30, 200);
+
+    let mut expected = Pixmap::new(10, 10).unwrap();
+    expected.fill_rect(Rect::from_xywh(2.0, 2.0, 5.0, 5.0).unwrap(), &paint,
+                       Transform::identity(), None);
+    assert!(expected.as_mut().try_pixels_mut().is_some());
+    assert!(expected.as_ref().try_pixels().is_some());
+
+    for &format in &[
+        PixelFormat::BgraPremultiplied,
+        PixelFormat::RgbaUnpremultiplied,
+        PixelFormat::BgraUnpremultiplied,
+    ] {
+        let mut pixmap = Pixmap::new(10, 10).unwrap();
+        let mut pixmap = pixmap.as_mut().with_format(format);
+        pixmap.fill_rect(Rect::from_xywh(2.0, 2.0, 5.0, 5.0).unwrap(), &paint,
+                         Transform::identity(), None);
+
+        assert!(pixmap.try_pixels_mut().is_none());
+        assert!(pixmap.as_ref().try_pixels().is_none());
+        // Stored pixels are still available as is.
+        assert_eq!(pixmap.as_ref().pixels().len(), 100);
+
+        let premultiplied = format == PixelFormat::BgraPremultiplied;
+        let pixmap = pixmap.as_ref();
+        let owned = pixmap.to_owned();
+        let rect = pixmap.clone_rect(IntRect::from_xywh(0, 0, 10, 10).unwrap()).unwrap();
+        for (i, c1) in expected.pixels().iter().enumerate() {
+            let c2 = pixmap.pixel(i as u32 % 10, i as u32 / 10).unwrap();
+            assert_eq!(owned.pixels()[i], c2);
+            assert_eq!(rect.pixels()[i], c2);
+
+            let c1 = [c1.red(), c1.green(), c1.blue(), c1.alpha()];
+            let c2 = [c2.red(), c2.green(), c2.blue(), c2.alpha()];
+            for (a, b) in c1.iter().zip(c2.iter()) {
+                let diff = (*a as i32 - *b as i32).abs();
+                // Unpremultiplied pixels are rounded twice.
+                assert!(if premultiplied { diff == 0 } else { diff <= 2 });
+            }
+        }
+    }
+}
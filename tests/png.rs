@@ -29,4 +29,56 @@ fn decode_rgba() {
     assert_eq!(pixmap.pixel(50, 50).unwrap(), ColorU8::from_rgba(33, 190, 47, 252).premultiply());
 }
 
-// TODO: test encoding, somehow
+#[test]
+fn decode_into() {
+    let data = std::fs::read("tests/images/pngs/rgba.png").unwrap();
+    let expected = Pixmap::decode_png(&data).unwrap();
+
+    // A buffer can be larger than needed.
+    let mut buf = vec![0; expected.data().len() + 16];
+    let mut pixmap = PixmapMut::from_bytes(&mut buf, expected.width(), expected.height()).unwrap();
+    pixmap.decode_png_into(&data).unwrap();
+    assert_eq!(&buf[..expected.data().len()], expected.data());
+}
+
+#[test]
+fn decode_into_padded() {
+    for name in &["rgb", "rgba", "grayscale-alpha"] {
+        let data = std::fs::read(format!("tests/images/pngs/{}.png", name)).unwrap();
+        let expected = Pixmap::decode_png(&data).unwrap();
+
+        // Rows are decoded right into their place, so the padding must stay untouched.
+        let row_bytes = (expected.width() as usize + 3) * BYTES_PER_PIXEL;
+        let mut buf = vec![0x5A; row_bytes * expected.height() as usize];
+        let mut pixmap = PixmapMut::from_bytes_with_stride(
+            &mut buf, expected.width(), expected.height(), row_bytes,
+        ).unwrap();
+        pixmap.decode_png_into(&data).unwrap();
+        assert_eq!(pixmap.to_owned(), expected);
+
+        let row_len = expected.width() as usize * BYTES_PER_PIXEL;
+        assert!(buf.chunks(row_bytes).all(|row| row[row_len..].iter().all(|b| *b == 0x5A)));
+    }
+}
+
+#[test]
+fn decode_into_wrong_size() {
+    let data = std::fs::read("tests/images/pngs/rgba.png").unwrap();
+    let mut pixmap = Pixmap::new(10, 10).unwrap();
+    assert!(pixmap.as_mut().decode_png_into(&data).is_err());
+}
+
+#[test]
+fn encode_round_trip() {
+    let pixmap = Pixmap::load_png("tests/images/pngs/rgba.png").unwrap();
+
+    let data = pixmap.encode_png().unwrap();
+    assert_eq!(Pixmap::decode_png(&data).unwrap(), pixmap);
+
+    let data = pixmap.encode_png_with(&PngEncodeOptions::fast()).unwrap();
+    assert_eq!(Pixmap::decode_png(&data).unwrap(), pixmap);
+
+    let mut data = Vec::new();
+    pixmap.write_png(&mut data, &PngEncodeOptions::default()).unwrap();
+    assert_eq!(Pixmap::decode_png(&data).unwrap(), pixmap);
+}
@@ -0,0 +1,45 @@
+#![cfg(feature = "stats")]
+
+use tiny_skia::*;
+
+// Counters are global, so everything is checked in a single test.
+
+#[test]
+fn counters() {
+    let mut pixmap = Pixmap::new(100, 100).unwrap();
+
+    RenderStats::reset();
+    assert_eq!(RenderStats::get(), RenderStats::default());
+
+    // A solid, opaque color in the source mode is a memset.
+    let mut paint = Paint::default();
+    paint.set_color_rgba8(50, 127, 150, 255);
+    paint.blend_mode = BlendMode::Source;
+    let rect = Rect::from_xywh(10.0, 10.0, 20.0, 30.0).unwrap();
+    pixmap.fill_rect(rect, &paint, Transform::identity(), None);
+
+    let stats = RenderStats::get();
+    assert_eq!(stats.memset_pixels, 600);
+    assert_eq!(stats.rect_pixels, 0);
+    assert_eq!(stats.lowp_pipelines + stats.highp_pipelines, 3);
+
+    // An anti-aliased path.
+    RenderStats::reset();
+    paint.blend_mode = BlendMode::SourceOver;
+    paint.anti_alias = true;
+    paint.force_hq_pipeline = true;
+    paint.set_color_rgba8(50, 127, 150, 200);
+    let path = PathBuilder::from_circle(50.0, 50.0, 30.0).unwrap();
+    pixmap.fill_path(&path, &paint, FillRule::Winding, Transform::identity(), None);
+
+    let stats = RenderStats::get();
+    assert_eq!(stats.lowp_pipelines, 0);
+    assert_eq!(stats.highp_pipelines, 3);
+    assert!(stats.pipeline_stages > 0);
+    assert!(stats.edges > 0);
+    // 60 rows, supersampled 4 times.
+    assert!(stats.scanlines >= 240);
+    assert!(stats.anti_h_pixels > 0);
+    assert!(stats.rect_pixels > 0);
+    assert_eq!(stats.supersampling_fallbacks, 0);
+}